@@ -5,9 +5,84 @@
 #include "pacman.h"
 #include "../../mame2003/memory.h"
 #include "../../mame2003/cpu/z80/z80.h"
+#include "../../mame2003/cpuintrf.h"
+#include "../../video/video.h"
 #include <string.h>
 #include <stdio.h>
 
+/***************************************************************************
+ * Memory Access
+ *
+ * ROM and RAM are mapped straight into the memory system page table; only
+ * the I/O page at $5000 goes through handlers.
+ ***************************************************************************/
+
+/* Driver instance the I/O handlers operate on */
+static pacman_state_t* pacman_active = NULL;
+
+static UINT8 pacman_io_r(UINT32 address) {
+    pacman_state_t* state = pacman_active;
+    
+    /* Input ports */
+    if (address == 0x5000) {
+        return state->input_port0;
+    }
+    if (address == 0x5040) {
+        return state->input_port1;
+    }
+    if (address == 0x5080) {
+        return state->dip_switch1;
+    }
+    if (address == 0x50C0) {
+        return state->dip_switch2;
+    }
+    
+    /* Unmapped */
+    return 0xFF;
+}
+
+static void pacman_io_w(UINT32 address, UINT8 data) {
+    pacman_state_t* state = pacman_active;
+    
+    /* Control registers */
+    if (address == 0x5000) {
+        state->interrupt_enable = data & 1;
+        return;
+    }
+    if (address == 0x5003) {
+        state->flip_screen = data & 1;
+        return;
+    }
+    
+    /* Sprite coordinates */
+    if (address >= 0x5060 && address <= 0x506F) {
+        state->sprite_coords[address - 0x5060] = data;
+        return;
+    }
+    
+    /* Other I/O - ignore for now */
+}
+
+static void pacman_map_memory(pacman_state_t* state) {
+    pacman_active = state;
+    
+    memory_map_rom(PACMAN_ROM_BASE, PACMAN_ROM_END, state->rom);
+    memory_map_ram(PACMAN_VRAM_BASE, PACMAN_VRAM_END, state->video_ram);
+    memory_map_ram(PACMAN_CRAM_BASE, PACMAN_CRAM_END, state->color_ram);
+    memory_map_ram(PACMAN_RAM_BASE, PACMAN_RAM_END, state->ram);
+    
+    memory_install_read_handler(0x5000, 0x50FF, pacman_io_r);
+    memory_install_write_handler(0x5000, 0x50FF, pacman_io_w);
+}
+
+UINT8 pacman_read_byte(pacman_state_t* state, UINT16 address) {
+    return memory_read_byte(address);
+}
+
+void pacman_write_byte(pacman_state_t* state, UINT16 address, UINT8 data) {
+    memory_write_byte(address, data);
+}
+
 /***************************************************************************
  * Initialization
  ***************************************************************************/
@@ -52,6 +127,9 @@ int pacman_init(pacman_state_t* state) {
     printf("  CRAM:  %p (%u bytes)\n", state->color_ram, PACMAN_COLOR_RAM_SIZE);
     printf("  RAM:   %p (%u bytes)\n", state->ram, PACMAN_RAM_SIZE);
     
+    /* Hook everything into the CPU address space */
+    pacman_map_memory(state);
+    
     /* Initialize default state */
     state->interrupt_enable = 0;
     state->flip_screen = 0;
@@ -76,6 +154,10 @@ void pacman_shutdown(pacman_state_t* state) {
     memory_region_free(REGION_USER1 + 1);
     memory_region_free(REGION_USER1 + 2);
     
+    if (pacman_active == state) {
+        pacman_active = NULL;
+    }
+    
     memset(state, 0, sizeof(pacman_state_t));
 }
 
@@ -94,105 +176,32 @@ void pacman_reset(pacman_state_t* state) {
     state->interrupt_enable = 0;
     state->flip_screen = 0;
     state->frame_count = 0;
-}
-
-/***************************************************************************
- * Memory Access
- ***************************************************************************/
-
-UINT8 pacman_read_byte(pacman_state_t* state, UINT16 address) {
-    /* ROM */
-    if (address <= PACMAN_ROM_END) {
-        return state->rom[address];
-    }
-    
-    /* Video RAM */
-    if (address >= PACMAN_VRAM_BASE && address <= PACMAN_VRAM_END) {
-        return state->video_ram[address - PACMAN_VRAM_BASE];
-    }
-    
-    /* Color RAM */
-    if (address >= PACMAN_CRAM_BASE && address <= PACMAN_CRAM_END) {
-        return state->color_ram[address - PACMAN_CRAM_BASE];
-    }
-    
-    /* General RAM */
-    if (address >= PACMAN_RAM_BASE && address <= PACMAN_RAM_END) {
-        return state->ram[address - PACMAN_RAM_BASE];
-    }
-    
-    /* Input ports */
-    if (address == 0x5000) {
-        return state->input_port0;
-    }
-    if (address == 0x5040) {
-        return state->input_port1;
-    }
-    if (address == 0x5080) {
-        return state->dip_switch1;
-    }
-    if (address == 0x50C0) {
-        return state->dip_switch2;
-    }
-    
-    /* Unmapped */
-    return 0xFF;
-}
-
-void pacman_write_byte(pacman_state_t* state, UINT16 address, UINT8 data) {
-    /* ROM is read-only */
-    if (address <= PACMAN_ROM_END) {
-        return;
-    }
-    
-    /* Video RAM */
-    if (address >= PACMAN_VRAM_BASE && address <= PACMAN_VRAM_END) {
-        state->video_ram[address - PACMAN_VRAM_BASE] = data;
-        return;
-    }
-    
-    /* Color RAM */
-    if (address >= PACMAN_CRAM_BASE && address <= PACMAN_CRAM_END) {
-        state->color_ram[address - PACMAN_CRAM_BASE] = data;
-        return;
-    }
-    
-    /* General RAM */
-    if (address >= PACMAN_RAM_BASE && address <= PACMAN_RAM_END) {
-        state->ram[address - PACMAN_RAM_BASE] = data;
-        return;
-    }
-    
-    /* Control registers */
-    if (address == 0x5000) {
-        state->interrupt_enable = data & 1;
-        return;
-    }
-    if (address == 0x5003) {
-        state->flip_screen = data & 1;
-        return;
-    }
-    
-    /* Sprite coordinates */
-    if (address >= 0x5060 && address <= 0x506F) {
-        state->sprite_coords[address - 0x5060] = data;
-        return;
-    }
-    
-    /* Other I/O - ignore for now */
+    state->frame_stopped = 0;
 }
 
 /***************************************************************************
  * Execution
  ***************************************************************************/
 
-void pacman_run_frame(pacman_state_t* state) {
+int pacman_run_frame(pacman_state_t* state) {
     /* Run Z80 for one frame (60 Hz)
        Z80 @ 3.072 MHz, 60 Hz = 51,200 cycles per frame */
     const int CYCLES_PER_FRAME = 51200;
     
-    /* Execute Z80 */
-    z80_execute(CYCLES_PER_FRAME);
+    /* Execute Z80; cpu_getscanline tracks the beam meanwhile. A watchpoint
+     * break ends the timeslice early and returns to the caller; the frame
+     * carries on from there on the next call. */
+    if (!state->frame_stopped) {
+        cpu_begin_frame(CYCLES_PER_FRAME, PACMAN_TOTAL_LINES);
+    }
+    state->frame_stopped = 0;
+    while (cpu_frame_cycles_left() > 0) {
+        cpu_run_timeslice();
+        if (memory_watch_break_pending()) {
+            state->frame_stopped = 1;
+            return 0;
+        }
+    }
     
     /* Generate V-blank interrupt if enabled */
     if (state->interrupt_enable) {
@@ -201,6 +210,7 @@ void pacman_run_frame(pacman_state_t* state) {
     }
     
     state->frame_count++;
+    return 1;
 }
 
 /***************************************************************************
@@ -212,6 +222,124 @@ void pacman_update_input(pacman_state_t* state, UINT8 port0, UINT8 port1) {
     state->input_port1 = port1;
 }
 
+/***************************************************************************
+ * Graphics Layouts
+ ***************************************************************************/
+
+static const gfx_layout tilelayout = {
+    8, 8,       /* 8*8 characters */
+    256,        /* 256 characters */
+    2,          /* 2 bits per pixel */
+    { 0, 4 },   /* the two bitplanes for 4 pixels are packed into one byte */
+    { 8*8+0, 8*8+1, 8*8+2, 8*8+3, 0, 1, 2, 3 },  /* bits are packed in groups of four */
+    { 0*8, 1*8, 2*8, 3*8, 4*8, 5*8, 6*8, 7*8 },
+    16*8        /* every char takes 16 bytes */
+};
+
+static const gfx_layout spritelayout = {
+    16, 16,     /* 16*16 sprites */
+    64,         /* 64 sprites */
+    2,          /* 2 bits per pixel */
+    { 0, 4 },   /* the two bitplanes for 4 pixels are packed into one byte */
+    { 8*8, 8*8+1, 8*8+2, 8*8+3, 16*8+0, 16*8+1, 16*8+2, 16*8+3,
+      24*8+0, 24*8+1, 24*8+2, 24*8+3, 0, 1, 2, 3 },
+    { 0*8, 1*8, 2*8, 3*8, 4*8, 5*8, 6*8, 7*8,
+      32*8, 33*8, 34*8, 35*8, 36*8, 37*8, 38*8, 39*8 },
+    64*8        /* every sprite takes 64 bytes */
+};
+
+/* Packed 2bpp with mirrored copies: 4KB + 4KB characters and 4KB + 4KB
+ * sprites, all of it resident in the 32KB L1 data cache */
+const gfx_decode_info pacman_gfxdecodeinfo[] = {
+    { REGION_GFX1, 0x0000, &tilelayout,   0, 32, GFX_DECODE_FLIPX },
+    { REGION_GFX1, 0x1000, &spritelayout, 0, 32, GFX_DECODE_FLIPX },
+    { -1 }      /* end of array */
+};
+
+/***************************************************************************
+ * Palette
+ *
+ * 82S123 colour PROM through 1K/470/220 ohm resistors for red and green
+ * and 470/220 ohm for blue; the 82S126 lookup PROM picks one of the first
+ * 16 colours for each pen.
+ ***************************************************************************/
+
+const palette_prom_info pacman_palette_info = {
+    REGION_PROMS,
+    0x0000, 32,             /* colour PROM */
+    0x0020, 0x0F,           /* lookup PROM */
+    { { 0, 1, 2 }, { 0x21, 0x47, 0x97 } },      /* red */
+    { { 3, 4, 5 }, { 0x21, 0x47, 0x97 } },      /* green */
+    { { 6, 7, 0 }, { 0x51, 0xAE, 0x00 } }       /* blue */
+};
+
+/***************************************************************************
+ * Characters
+ *
+ * VRAM holds the playfield from $4040 as 32 bytes per column of the
+ * upright screen, the rightmost column first, and the two rows above
+ * and below it as 32-byte bands from $43C0 and $4000, the first and
+ * last two bytes of each off screen. CRAM is laid out the same way.
+ * The tilemap is the native 36x28 raster (MAME's pacman_scan_rows).
+ ***************************************************************************/
+
+u32 pacman_scan_rows(u32 col, u32 row, u32 num_cols, u32 num_rows) {
+    row += 2;
+    col -= 2;
+    if (col & 0x20) {
+        return row + ((col & 0x1F) << 5);
+    }
+    return col + (row << 5);
+}
+
+static void pacman_get_tile_info(int tile_index, tile_info_t* info, void* param) {
+    video_state_t* video = (video_state_t*)param;
+    
+    info->gfx = video->gfx[0];
+    info->code = video->tile_vram[tile_index];
+    info->color = video->tile_cram[tile_index] & 0x1F;
+}
+
+int pacman_video_start(pacman_state_t* state, video_state_t* video) {
+    return video_create_tilemap(video, pacman_get_tile_info, pacman_scan_rows,
+                                PACMAN_TILES_X, PACMAN_TILES_Y);
+}
+
+/***************************************************************************
+ * Sprites
+ *
+ * Sprite RAM at $4FF0 holds code << 2 | yflip << 1 | xflip and the colour
+ * for each of the eight sprites; their positions are written to $5060,
+ * in the native frame the tiles are drawn in.
+ ***************************************************************************/
+
+void pacman_queue_sprites(pacman_state_t* state, sprite_list_t* list, const gfx_element_t* gfx) {
+    const UINT8* spriteram = state->ram + (PACMAN_SPRITERAM_BASE - PACMAN_RAM_BASE);
+    int offs;
+    
+    /* Lower numbered sprites have priority, so they are queued last */
+    for (offs = (PACMAN_NUM_SPRITES - 1) * 2; offs >= 0; offs -= 2) {
+        int x = 272 - state->sprite_coords[offs + 1];
+        int y = state->sprite_coords[offs] - 31;
+        int flags = 0;
+        
+        if (spriteram[offs] & 1) {
+            flags |= SPRITE_FLIPX;
+        }
+        if (spriteram[offs] & 2) {
+            flags |= SPRITE_FLIPY;
+        }
+        
+        if (state->flip_screen) {
+            x = PACMAN_SCREEN_WIDTH - PACMAN_SPRITE_WIDTH - x;
+            y = PACMAN_SCREEN_HEIGHT - PACMAN_SPRITE_HEIGHT - y;
+            flags ^= SPRITE_FLIPX | SPRITE_FLIPY;
+        }
+        
+        sprite_list_add(list, gfx, spriteram[offs] >> 2, spriteram[offs + 1] & 0x1F, x, y, flags);
+    }
+}
+
 /***************************************************************************
  * Video (stub for now)
  ***************************************************************************/
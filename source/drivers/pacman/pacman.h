@@ -9,18 +9,21 @@
 #define PACMAN_H
 
 #include "../../mame2003/osd_gc.h"
+#include "../../video/gfx_decode.h"
+#include "../../video/sprite.h"
+#include "../../video/palette.h"
 
 /***************************************************************************
  * Pac-Man Hardware Specifications
  ***************************************************************************/
 
-/* Display */
-#define PACMAN_SCREEN_WIDTH     224
-#define PACMAN_SCREEN_HEIGHT    288
+/* Display - the native (landscape) raster of the sideways monitor */
+#define PACMAN_SCREEN_WIDTH     288
+#define PACMAN_SCREEN_HEIGHT    224
 #define PACMAN_TILE_WIDTH       8
 #define PACMAN_TILE_HEIGHT      8
-#define PACMAN_TILES_X          28  /* 224 / 8 */
-#define PACMAN_TILES_Y          36  /* 288 / 8 */
+#define PACMAN_TILES_X          36  /* 288 / 8 */
+#define PACMAN_TILES_Y          28  /* 224 / 8 */
 
 /* Memory regions */
 #define PACMAN_ROM_SIZE         0x4000  /* 16KB */
@@ -41,10 +44,19 @@
 #define PACMAN_SPRITE_END       0x503F
 #define PACMAN_IO_BASE          0x5040
 #define PACMAN_IO_END           0x507F
+#define PACMAN_SPRITERAM_BASE   0x4FF0  /* Code/flip and colour, 2 bytes per sprite */
+
+/* The monitor is mounted turned clockwise: characters, sprites and the
+ * frame are all drawn in the landscape raster, and turned upright when
+ * the frame is presented */
+#define PACMAN_ORIENTATION      ROT90
 
 /* Colors */
 #define PACMAN_NUM_COLORS       16
 
+/* Raster: 264 lines per frame, the first 224 of them visible */
+#define PACMAN_TOTAL_LINES      264
+
 /* Sprites */
 #define PACMAN_NUM_SPRITES      8
 #define PACMAN_SPRITE_WIDTH     16
@@ -70,6 +82,7 @@ typedef struct {
     
     /* Frame counter */
     UINT32 frame_count;
+    UINT8 frame_stopped;      /* Frame stopped by a watchpoint break */
     
     /* Input state */
     UINT8 input_port0;
@@ -88,8 +101,9 @@ int pacman_init(pacman_state_t* state);
 void pacman_shutdown(pacman_state_t* state);
 void pacman_reset(pacman_state_t* state);
 
-/* Execution */
-void pacman_run_frame(pacman_state_t* state);
+/* Execution - returns 0 when a watchpoint break stopped the frame
+ * early; the next call runs the rest of it */
+int pacman_run_frame(pacman_state_t* state);
 
 /* Memory handlers */
 UINT8 pacman_read_byte(pacman_state_t* state, UINT16 address);
@@ -101,4 +115,19 @@ void pacman_update_input(pacman_state_t* state, UINT8 port0, UINT8 port1);
 /* Video */
 void pacman_render(pacman_state_t* state);
 
+/* Create the character layer: 36x28 tiles over the 1KB of VRAM/CRAM,
+ * in the order the hardware fetches them */
+struct video_state;
+int pacman_video_start(pacman_state_t* state, struct video_state* video);
+u32 pacman_scan_rows(u32 col, u32 row, u32 num_cols, u32 num_rows);
+
+/* Queue the hardware sprites for this frame */
+void pacman_queue_sprites(pacman_state_t* state, sprite_list_t* list, const gfx_element_t* gfx);
+
+/* Graphics layouts for REGION_GFX1 (characters at 0x0000, sprites at 0x1000) */
+extern const gfx_decode_info pacman_gfxdecodeinfo[];
+
+/* Colour PROM (32 colours) and lookup PROM (4 pens per colour code) */
+extern const palette_prom_info pacman_palette_info;
+
 #endif /* PACMAN_H */
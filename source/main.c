@@ -13,74 +13,62 @@
 #include "drivers/pacman/pacman.h"
 #include "drivers/pacman/pacman_rom.h"
 #include "video/video.h"
+#include "video/yuv.h"
+#include "video/present.h"
+#include "video/gxtex.h"
 #include "input.h"
 
 static void *xfb = NULL;
 static GXRModeObj *rmode = NULL;
 
-/* Global Pac-Man state (for CPU interface) */
-void* g_pacman_state = NULL;
 static pacman_state_t pacman;
 
+/* Run one emulated frame. A watchpoint break stops it to show the
+ * accesses logged so far, then the rest of the frame runs. */
+static void run_frame(void) {
+    while (!pacman_run_frame(&pacman)) {
+        printf("Watchpoint break at PC=%04X\n", z80_get_reg(Z80_PC));
+        memory_watch_dump();
+    }
+}
+
 /* Video system */
 static video_state_t video;
+
+#ifdef MAMEGC_RGBA_TARGET
+/* Game area presented as RGBA, converted once per frame (debug builds);
+ * square, so it holds the frame turned either way */
+#define RGBA_TARGET_SIZE    MAX(VIDEO_WIDTH, VIDEO_HEIGHT)
 static u32* video_framebuffer = NULL;
 
-/* Copy rendered framebuffer to GX framebuffer */
+/* Copy the rows the last present wrote to GX framebuffer, centred */
 static void copy_to_screen(void) {
-    if (!video_framebuffer || !xfb) return;
+    if (!video_framebuffer || !xfb || video.present_rows <= 0) return;
+    
+    int x = ((rmode->fbWidth - RGBA_TARGET_SIZE) / 2) & ~1;
+    int y = (rmode->xfbHeight - RGBA_TARGET_SIZE) / 2 + video.present_y;
+    int pitch = rmode->fbWidth * VI_DISPLAY_PIX_SZ;
     
     /* Convert RGBA8888 to YUV422 (YUY2) for GX framebuffer */
-    u32* dst = (u32*)xfb;
-    int width = rmode->fbWidth;
-    int height = rmode->xfbHeight;
+    yuv_convert((u32*)xfb + y * (rmode->fbWidth / 2) + x / 2, rmode->fbWidth / 2,
+                video_framebuffer + video.present_y * RGBA_TARGET_SIZE, RGBA_TARGET_SIZE,
+                RGBA_TARGET_SIZE, video.present_rows, NULL);
     
-    /* YUV422 stores pairs of pixels: Y0 U Y1 V */
-    for (int y = 0; y < height && y < 480; y++) {
-        for (int x = 0; x < width && x < 640; x += 2) {
-            /* Get two adjacent pixels */
-            u32 rgba0 = video_framebuffer[y * 640 + x];
-            u32 rgba1 = video_framebuffer[y * 640 + x + 1];
-            
-            /* Extract RGB for pixel 0 */
-            u8 r0 = (rgba0 >> 24) & 0xFF;
-            u8 g0 = (rgba0 >> 16) & 0xFF;
-            u8 b0 = (rgba0 >> 8) & 0xFF;
-            
-            /* Extract RGB for pixel 1 */
-            u8 r1 = (rgba1 >> 24) & 0xFF;
-            u8 g1 = (rgba1 >> 16) & 0xFF;
-            u8 b1 = (rgba1 >> 8) & 0xFF;
-            
-            /* RGB to YUV conversion (ITU-R BT.601) */
-            /* Y = 0.299R + 0.587G + 0.114B */
-            /* U = -0.147R - 0.289G + 0.436B + 128 */
-            /* V = 0.615R - 0.515G - 0.100B + 128 */
-            
-            int y0 = (77 * r0 + 150 * g0 + 29 * b0) >> 8;
-            int y1 = (77 * r1 + 150 * g1 + 29 * b1) >> 8;
-            
-            /* Average UV for both pixels */
-            int r_avg = (r0 + r1) >> 1;
-            int g_avg = (g0 + g1) >> 1;
-            int b_avg = (b0 + b1) >> 1;
-            
-            int u = ((-38 * r_avg - 74 * g_avg + 112 * b_avg) >> 8) + 128;
-            int v = ((112 * r_avg - 94 * g_avg - 18 * b_avg) >> 8) + 128;
-            
-            /* Clamp values */
-            if (y0 < 0) y0 = 0; if (y0 > 255) y0 = 255;
-            if (y1 < 0) y1 = 0; if (y1 > 255) y1 = 255;
-            if (u < 0) u = 0; if (u > 255) u = 255;
-            if (v < 0) v = 0; if (v > 255) v = 255;
-            
-            /* Pack as YUY2: Y0 U Y1 V */
-            dst[(y * width + x) / 2] = (y0 << 24) | (u << 16) | (y1 << 8) | v;
-        }
-    }
+    DCFlushRange((u8*)xfb + y * pitch, video.present_rows * pitch);
+}
+#else
+/* Game frames cycle through their own XFBs; the console keeps xfb */
+static void* xfb_frames[PRESENT_BUFFERS];
+static presenter_t presenter;
+
+/* Blitters write YUY2 through the cached view of an XFB; push rows out */
+static void flush_xfb_rows(void* buffer, int first, int count) {
+    u8* base = (u8*)MEM_K1_TO_K0(buffer);
+    int pitch = rmode->fbWidth * VI_DISPLAY_PIX_SZ;
     
-    DCFlushRange(xfb, rmode->fbWidth * rmode->xfbHeight * 2);
+    DCFlushRange(base + first * pitch, count * pitch);
 }
+#endif
 
 int main(int argc, char **argv) {
     mame2003_context_t mame_ctx;
@@ -101,6 +89,12 @@ int main(int argc, char **argv) {
     VIDEO_WaitVSync();
     if (rmode->viTVMode & VI_NON_INTERLACE) VIDEO_WaitVSync();
     
+#ifndef MAMEGC_RGBA_TARGET
+    for (int i = 0; i < PRESENT_BUFFERS; i++) {
+        xfb_frames[i] = MEM_K0_TO_K1(SYS_AllocateFramebuffer(rmode));
+    }
+#endif
+    
     /* Print banner */
     printf("\n");
     printf("================================\n");
@@ -133,9 +127,6 @@ int main(int argc, char **argv) {
             printf("ERROR: Failed to initialize Pac-Man\n");
             result = -1;
         } else {
-            /* Set global state for CPU interface */
-            g_pacman_state = &pacman;
-            
             /* Load test ROM */
             printf("\nLoading Pac-Man test ROM...\n");
             memcpy(pacman.rom, pacman_test_rom, PACMAN_TEST_ROM_SIZE);
@@ -167,11 +158,14 @@ int main(int argc, char **argv) {
             /* Initialize video system */
             printf("\nInitializing video system...\n");
             
-            /* Allocate framebuffer (640x480 for GameCube) */
+#ifdef MAMEGC_RGBA_TARGET
+            /* Allocate framebuffer (the game's visible area) */
             printf("Allocating video framebuffer...\n");
-            printf("  Size: 640×480×4 = %u bytes\n", 640 * 480 * 4);
+            printf("  Size: %dx%dx4 = %u bytes\n", RGBA_TARGET_SIZE, RGBA_TARGET_SIZE,
+                   RGBA_TARGET_SIZE * RGBA_TARGET_SIZE * 4);
             
-            video_framebuffer = (u32*)memalign(32, 640 * 480 * sizeof(u32));
+            video_framebuffer = (u32*)osd_memalign_tagged(32, RGBA_TARGET_SIZE * RGBA_TARGET_SIZE * sizeof(u32),
+                                                          OSD_MEM_VIDEO);
             if (!video_framebuffer) {
                 printf("ERROR: Failed to allocate video framebuffer\n");
                 result = -1;
@@ -179,12 +173,52 @@ int main(int argc, char **argv) {
                 printf("  Allocated at: %p\n", video_framebuffer);
                 printf("  Alignment: OK (%p & 31 = %d)\n", 
                        video_framebuffer, ((u32)video_framebuffer) & 31);
-                if (video_init(&video, video_framebuffer, 640, 480) != 0) {
+                if (video_init(&video, video_framebuffer, RGBA_TARGET_SIZE, RGBA_TARGET_SIZE) != 0) {
+#else
+            /* Render YUY2 straight into the external framebuffer */
+            {
+                if (video_init(&video, (u32*)MEM_K1_TO_K0(xfb_frames[0]), rmode->fbWidth, rmode->xfbHeight) != 0 ||
+                    video_set_target(&video, (u32*)MEM_K1_TO_K0(xfb_frames[0]), rmode->fbWidth,
+                                     rmode->xfbHeight, VIDEO_FORMAT_YUY2) != 0 ||
+                    present_init(&presenter, xfb_frames, PRESENT_BUFFERS, NULL, NULL) != 0) {
+#endif
                     printf("ERROR: Failed to initialize video\n");
                     result = -1;
                 } else {
                     printf("Video system initialized!\n");
                     
+                    /* The driver's character layer, then its character and sprite
+                     * ROMs and colour PROMs, decoded if they are loaded */
+                    pacman_video_start(&pacman, &video);
+                    video_decode_gfx(&video, pacman_gfxdecodeinfo);
+                    video_decode_palette(&video, &pacman_palette_info);
+                    
+                    /* Redraw only tiles whose VRAM/CRAM bytes are written */
+                    video_track_memory(&video, PACMAN_VRAM_BASE, PACMAN_CRAM_BASE, PACMAN_VIDEO_RAM_SIZE);
+                    video_set_orientation(&video, PACMAN_ORIENTATION, mame_ctx.config.orientation);
+                    
+                    if (mame_ctx.config.debug_mode) {
+                        video_benchmark_tiles(&video, 100);
+                        video_benchmark_orientation(&video, 100);
+                        yuv_benchmark(10);
+                        present_benchmark();
+                        frameskip_benchmark();
+                        bitvideo_benchmark(50);
+                        gxtex_self_test();
+                    }
+                    
+#ifndef MAMEGC_RGBA_TARGET
+                    /* Flips happen in the retrace callback from here on */
+                    present_attach_vi(&presenter);
+                    
+                    int frame_buffer;
+                    while ((frame_buffer = present_acquire(&presenter)) < 0) {
+                        VIDEO_WaitVSync();
+                    }
+                    video_set_target(&video, (u32*)MEM_K1_TO_K0(xfb_frames[frame_buffer]),
+                                     rmode->fbWidth, rmode->xfbHeight, VIDEO_FORMAT_YUY2);
+#endif
+                    
                     /* Clear screen to black */
                     color_t black = {0, 0, 0, 255};
                     video_clear(&video, black);
@@ -192,49 +226,30 @@ int main(int argc, char **argv) {
                     printf("\nRunning Pac-Man for 3 frames...\n");
                     for (int i = 0; i < 3; i++) {
                         printf("Frame %d: ", i + 1);
-                        pacman_run_frame(&pacman);
+                        run_frame();
                         printf("PC=%04X ", z80_get_reg(Z80_PC));
                         printf("SP=%04X ", z80_get_reg(Z80_SP));
                         printf("A=%02X\n", (z80_get_reg(Z80_AF) >> 8) & 0xFF);
                     }
                     
                     printf("\nRendering tiles...\n");
-                    printf("Framebuffer: %p\n", video_framebuffer);
-                    printf("FB size: %dx%d = %d pixels\n", 640, 480, 640*480);
+                    printf("Framebuffer: %p\n", video.framebuffer);
+                    printf("FB size: %dx%d = %d pixels\n", video.fb_width, video.fb_height,
+                           video.fb_width * video.fb_height);
                     
                     /* First, draw a test pattern to verify framebuffer works */
                     printf("Drawing test rectangles...\n");
-                    
-                    /* Clear to black */
-                    memset(video_framebuffer, 0, 640 * 480 * sizeof(u32));
-                    
-                    /* Draw some colored rectangles to verify rendering */
-                    /* Red rectangle at top-left */
-                    for (int y = 0; y < 50; y++) {
-                        for (int x = 0; x < 100; x++) {
-                            video_framebuffer[y * 640 + x] = 0xFF0000FF; /* Red */
-                        }
-                    }
-                    
-                    /* Green rectangle next to it */
-                    for (int y = 0; y < 50; y++) {
-                        for (int x = 100; x < 200; x++) {
-                            video_framebuffer[y * 640 + x] = 0x00FF00FF; /* Green */
-                        }
-                    }
-                    
-                    /* Blue rectangle next to that */
-                    for (int y = 0; y < 50; y++) {
-                        for (int x = 200; x < 300; x++) {
-                            video_framebuffer[y * 640 + x] = 0x0000FFFF; /* Blue */
-                        }
-                    }
-                    
-                    /* White rectangle */
-                    for (int y = 0; y < 50; y++) {
-                        for (int x = 300; x < 400; x++) {
-                            video_framebuffer[y * 640 + x] = 0xFFFFFFFF; /* White */
-                        }
+                    {
+                        color_t red = {255, 0, 0, 255};
+                        color_t green = {0, 255, 0, 255};
+                        color_t blue = {0, 0, 255, 255};
+                        color_t white = {255, 255, 255, 255};
+                        
+                        video_clear(&video, black);
+                        video_fill_rect(&video, 0, 0, 100, 50, red);
+                        video_fill_rect(&video, 100, 0, 100, 50, green);
+                        video_fill_rect(&video, 200, 0, 100, 50, blue);
+                        video_fill_rect(&video, 300, 0, 100, 50, white);
                     }
                     
                     printf("Test rectangles drawn!\n");
@@ -242,14 +257,37 @@ int main(int argc, char **argv) {
                     /* Now render actual tiles */
                     printf("\nRendering Pac-Man tiles...\n");
                     video_begin_frame(&video);
-                    video_render_tiles(&video, pacman.video_ram, pacman.color_ram, 0);
+                    video_render_tiles(&video, pacman.video_ram, pacman.color_ram, pacman.flip_screen);
+                    pacman_queue_sprites(&pacman, video_begin_sprites(&video), video.gfx[1]);
+                    video_render_sprites(&video);
                     video_end_frame(&video);
+#ifndef MAMEGC_RGBA_TARGET
+                    {
+                        rectangle lacking;
+                        
+                        /* The clear made this XFB stale anyway; the others
+                         * lack the frame as much as they lack everything */
+                        present_take_damage(&presenter, frame_buffer, &lacking);
+                        present_add_damage(&presenter, frame_buffer, &video.damage);
+                    }
+#endif
                     
-                    printf("Rendered frame %u\n", video.frame_count);
-                    printf("Tile area: 28x36 tiles = %d tiles total\n", 28*36);
-                    printf("Display area: 224x288 pixels (centered at %d,%d)\n", 
-                           (640-224)/2, (480-288)/2);
+                    printf("Rendered frame %u (%u tiles drawn)\n", video.frame_count, video.tiles_drawn);
+                    {
+                        video_stats_t vstats;
+                        
+                        video_get_stats(&video, &vstats);
+                        printf("Tile paths: %u blank, %u opaque, %u masked; sprites: %u drawn (%u opaque), %u skipped\n",
+                               vstats.tiles_blank, vstats.tiles_opaque, vstats.tiles_masked,
+                               vstats.sprites_drawn, vstats.sprites_opaque, vstats.sprites_skipped);
+                    }
+                    mame_ctx.tiles_drawn = video.tiles_drawn;
+                    printf("Tile area: %dx%d tiles = %d tiles total\n", VIDEO_TILES_X, VIDEO_TILES_Y,
+                           VIDEO_TILE_COUNT);
+                    printf("Display area: %dx%d pixels x%d (centered at %d,%d)\n",
+                           VIDEO_WIDTH, VIDEO_HEIGHT, video.scale, video.x_offset, video.y_offset);
                     
+#ifdef MAMEGC_RGBA_TARGET
                     /* Sample a few pixels to verify rendering */
                     printf("\nFramebuffer samples:\n");
                     for (int i = 0; i < 5; i++) {
@@ -258,25 +296,94 @@ int main(int argc, char **argv) {
                     }
                     
                     printf("\nCopying to screen...\n");
-                    
-                    /* Debug: Show what we're converting */
-                    printf("Sample conversions:\n");
-                    for (int i = 0; i < 3; i++) {
-                        u32 rgba = video_framebuffer[i];
-                        u8 r = (rgba >> 24) & 0xFF;
-                        u8 g = (rgba >> 16) & 0xFF;
-                        u8 b = (rgba >> 8) & 0xFF;
-                        int y = (77 * r + 150 * g + 29 * b) >> 8;
-                        int u = ((-38 * r - 74 * g + 112 * b) >> 8) + 128;
-                        int v = ((112 * r - 94 * g - 18 * b) >> 8) + 128;
-                        printf("  Pixel %d: RGB(%02X,%02X,%02X) -> YUV(%d,%d,%d)\n", 
-                               i, r, g, b, y, u, v);
-                    }
-                    
                     copy_to_screen();
                     VIDEO_SetNextFramebuffer(xfb);
                     VIDEO_Flush();
                     VIDEO_WaitVSync();
+#else
+                    /* Every row was written: clear, rectangles, then the game area */
+                    flush_xfb_rows(xfb_frames[frame_buffer], 0, video.fb_height);
+                    present_submit(&presenter, frame_buffer);
+                    while (!present_idle(&presenter)) {
+                        VIDEO_WaitVSync();
+                    }
+                    
+                    /* Run the game live for a couple of seconds, drawing the
+                     * frames the frameskip lets through, then give the screen
+                     * back to the console. Each XFB is cleared on its first
+                     * use so the test rectangles do not flicker in and out,
+                     * and after that only gets what changed since it was
+                     * last drawn. */
+                    u8 xfb_cleared[PRESENT_BUFFERS] = {0};
+                    UINT64 deadline = osd_ticks_us();
+                    for (int i = 0; i < 120; i++) {
+                        int draw = mame2003_begin_frame(&mame_ctx);
+                        UINT64 start = osd_ticks_us();
+                        UINT64 emulated, drawing, now;
+                        
+                        run_frame();
+                        emulated = drawing = osd_ticks_us();
+                        
+                        /* Skipped frames leave the tile and palette dirty
+                         * state for the next drawn one */
+                        if (draw) {
+                            rectangle lacking;
+                            
+                            while ((frame_buffer = present_acquire(&presenter)) < 0) {
+                                VIDEO_WaitVSync();
+                            }
+                            drawing = osd_ticks_us();
+                            video_set_target(&video, (u32*)MEM_K1_TO_K0(xfb_frames[frame_buffer]),
+                                             rmode->fbWidth, rmode->xfbHeight, VIDEO_FORMAT_YUY2);
+                            if (!xfb_cleared[frame_buffer]) {
+                                video_clear(&video, black);
+                                flush_xfb_rows(xfb_frames[frame_buffer], 0, video.fb_height);
+                                xfb_cleared[frame_buffer] = 1;
+                            }
+                            present_take_damage(&presenter, frame_buffer, &lacking);
+                            video_add_stale(&video, &lacking);
+                            
+                            video_begin_frame(&video);
+                            video_render_tiles(&video, pacman.video_ram, pacman.color_ram, pacman.flip_screen);
+                            pacman_queue_sprites(&pacman, video_begin_sprites(&video), video.gfx[1]);
+                            video_render_sprites(&video);
+                            video_end_frame(&video);
+                            mame_ctx.tiles_drawn = video.tiles_drawn;
+                            
+                            /* Only the rows presented changed; with nothing
+                             * changed the frame on screen is still right */
+                            present_add_damage(&presenter, frame_buffer, &video.damage);
+                            if (video.present_rows > 0) {
+                                flush_xfb_rows(xfb_frames[frame_buffer], video.present_y,
+                                               video.present_rows);
+                                present_submit(&presenter, frame_buffer);
+                            } else {
+                                present_cancel(&presenter, frame_buffer);
+                            }
+                        }
+                        
+                        mame2003_end_frame(&mame_ctx, (u32)(emulated - start),
+                                           (u32)(osd_ticks_us() - drawing));
+                        
+                        /* Each frame is due one refresh after the last,
+                         * as in frameskip_simulate: sleep only when early
+                         * (a skipped frame usually is; a submitted one was
+                         * already held back by present_acquire), and a
+                         * frame more than a refresh behind restarts the
+                         * schedule from now rather than racing to catch up */
+                        now = osd_ticks_us();
+                        deadline += mame_ctx.frameskip.budget_us;
+                        if (now > deadline + mame_ctx.frameskip.budget_us) {
+                            deadline = now;
+                        } else if (now < deadline) {
+                            osd_sleep_us((u32)(deadline - now));
+                        }
+                    }
+                    while (!present_idle(&presenter)) {
+                        VIDEO_WaitVSync();
+                    }
+                    present_detach_vi(&presenter, xfb);
+#endif
                     printf("Display updated!\n");
                     
                     printf("\n*** Input Test Mode ***\n");
@@ -372,7 +479,7 @@ int main(int argc, char **argv) {
         }
         
         /* Display memory usage */
-        char stats[256];
+        char stats[1024];
         mame2003_get_stats(&mame_ctx, stats, sizeof(stats));
         printf("\nStats:\n%s\n", stats);
     } else {
@@ -393,14 +500,16 @@ int main(int argc, char **argv) {
     }
     
     /* Shutdown MAME2003 */
-    if (result == 0 && g_pacman_state) {
+    if (result == 0) {
         printf("\nShutting down...\n");
         video_shutdown(&video);
         printf("Video system shut down\n");
+#ifdef MAMEGC_RGBA_TARGET
         if (video_framebuffer) {
-            free(video_framebuffer);
+            osd_free(video_framebuffer);
             video_framebuffer = NULL;
         }
+#endif
         z80_exit();
         printf("Z80 CPU shut down\n");
         pacman_shutdown(&pacman);
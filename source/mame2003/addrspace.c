@@ -0,0 +1,314 @@
+/***************************************************************************
+ * MAME2003 Address Spaces for GameCube
+ *
+ * Two-level page table: the top address bits select a chunk table, the
+ * next bits select a page entry. Chunks with nothing mapped share a single
+ * table of unmapped entries, so a lookup never has to test for NULL.
+ ***************************************************************************/
+
+#include "addrspace.h"
+#include "memory.h"
+
+/***************************************************************************
+ * Helpers
+ ***************************************************************************/
+
+static void address_space_clear_entry(address_space_entry_t* e) {
+    e->read = NULL;
+    e->write = NULL;
+    e->handlers = NULL;
+}
+
+/* Give a chunk its own table before one of its entries changes */
+static address_space_entry_t* address_space_get_chunk(address_space_t* space, UINT32 chunk) {
+    address_space_entry_t* table = space->l1[chunk];
+
+    if (table == space->unmapped) {
+        table = (address_space_entry_t*)osd_malloc_tagged(
+            space->l2_size * sizeof(address_space_entry_t), OSD_MEM_CPU);
+        if (!table) {
+            printf("ERROR: Out of memory for %s page table\n", space->name);
+            return NULL;
+        }
+        memcpy(table, space->unmapped, space->l2_size * sizeof(address_space_entry_t));
+        space->l1[chunk] = table;
+    }
+
+    return table;
+}
+
+static int address_space_check_range(address_space_t* space, UINT32 start, UINT32 end) {
+    if (start > end || end > space->addr_mask ||
+        (start & space->page_mask) != 0 || (end & space->page_mask) != space->page_mask) {
+        printf("ERROR: %s range 0x%06X-0x%06X is not page aligned\n", space->name, start, end);
+        return -1;
+    }
+    return 0;
+}
+
+/* Apply one entry to every page in a range */
+static int address_space_set_range(address_space_t* space, UINT32 start, UINT32 end,
+                                   UINT8* read, UINT8* write,
+                                   const address_space_handlers_t* handlers) {
+    UINT32 page;
+    UINT32 offset = 0;
+    UINT32 page_size = space->page_mask + 1;
+    address_space_entry_t* table;
+    address_space_entry_t* e;
+
+    if (address_space_check_range(space, start, end) != 0) {
+        return -1;
+    }
+
+    for (page = start >> space->page_bits; page <= (end >> space->page_bits); page++) {
+        table = address_space_get_chunk(space, (page << space->page_bits) >> space->l1_shift);
+        if (!table) {
+            return -1;
+        }
+        e = &table[page & space->l2_mask];
+        e->read = read ? read + offset : NULL;
+        e->write = write ? write + offset : NULL;
+        e->handlers = handlers;
+        offset += page_size;
+    }
+
+    return 0;
+}
+
+/***************************************************************************
+ * Creation
+ ***************************************************************************/
+
+address_space_t* address_space_create(const char* name, int addr_bits, int page_bits,
+                                      int data_width, int endianness) {
+    address_space_t* space;
+    UINT32 table_bits;
+    UINT32 i;
+
+    if (addr_bits < 8 || addr_bits > 32 || page_bits < 4 || page_bits >= addr_bits) {
+        printf("ERROR: Bad address space geometry for %s (%d/%d bits)\n",
+               name, addr_bits, page_bits);
+        return NULL;
+    }
+
+    if (data_width != 8 && data_width != 16) {
+        printf("ERROR: Unsupported data width %d for %s\n", data_width, name);
+        return NULL;
+    }
+
+    space = (address_space_t*)osd_calloc_tagged(1, sizeof(address_space_t), OSD_MEM_CPU);
+    if (!space) {
+        return NULL;
+    }
+
+    space->name = name;
+    space->addr_bits = addr_bits;
+    space->data_width = data_width;
+    space->endianness = endianness;
+    space->addr_mask = (addr_bits == 32) ? 0xFFFFFFFF : ((1U << addr_bits) - 1);
+    space->page_bits = page_bits;
+    space->page_mask = (1U << page_bits) - 1;
+    space->unmap_value = 0xFF;
+
+    /* Split the page number evenly between the two levels */
+    table_bits = addr_bits - page_bits;
+    space->l2_size = 1U << (table_bits / 2);
+    space->l2_mask = space->l2_size - 1;
+    space->l1_shift = page_bits + table_bits / 2;
+    space->l1_size = 1U << (table_bits - table_bits / 2);
+
+    /* Word data is kept in host order for 16-bit buses */
+    space->swapped = (data_width == 16 && endianness != AS_HOST_ENDIAN);
+    space->byte_xor = space->swapped ? 1 : 0;
+
+    space->unmapped = (address_space_entry_t*)osd_malloc_tagged(
+        space->l2_size * sizeof(address_space_entry_t), OSD_MEM_CPU);
+    space->l1 = (address_space_entry_t**)osd_malloc_tagged(
+        space->l1_size * sizeof(address_space_entry_t*), OSD_MEM_CPU);
+    if (!space->unmapped || !space->l1) {
+        address_space_destroy(space);
+        return NULL;
+    }
+
+    for (i = 0; i < space->l2_size; i++) {
+        address_space_clear_entry(&space->unmapped[i]);
+    }
+    for (i = 0; i < space->l1_size; i++) {
+        space->l1[i] = space->unmapped;
+    }
+
+    printf("Address space %s: %d bits, %u x %u pages of %u bytes%s\n",
+           name, addr_bits, space->l1_size, space->l2_size, space->page_mask + 1,
+           space->swapped ? ", word swapped" : "");
+
+    return space;
+}
+
+void address_space_destroy(address_space_t* space) {
+    UINT32 i;
+
+    if (!space) {
+        return;
+    }
+
+    if (space->l1) {
+        for (i = 0; i < space->l1_size; i++) {
+            if (space->l1[i] != space->unmapped) {
+                osd_free(space->l1[i]);
+            }
+        }
+        osd_free(space->l1);
+    }
+
+    if (space->unmapped) {
+        osd_free(space->unmapped);
+    }
+
+    osd_free(space);
+}
+
+/***************************************************************************
+ * Mapping
+ ***************************************************************************/
+
+int address_space_map_rom(address_space_t* space, UINT32 start, UINT32 end, UINT8* base) {
+    return address_space_set_range(space, start, end, base, NULL, NULL);
+}
+
+int address_space_map_ram(address_space_t* space, UINT32 start, UINT32 end, UINT8* base) {
+    return address_space_set_range(space, start, end, base, base, NULL);
+}
+
+int address_space_install_handlers(address_space_t* space, UINT32 start, UINT32 end,
+                                   const address_space_handlers_t* handlers) {
+    return address_space_set_range(space, start, end, NULL, NULL, handlers);
+}
+
+void address_space_unmap(address_space_t* space, UINT32 start, UINT32 end) {
+    address_space_set_range(space, start, end, NULL, NULL, NULL);
+}
+
+void address_space_prepare_region(address_space_t* space, int region) {
+    if (space->swapped) {
+        memory_region_swap16(region);
+    }
+}
+
+/***************************************************************************
+ * Slow Paths
+ ***************************************************************************/
+
+UINT8 address_space_read8_slow(address_space_t* space, UINT32 address) {
+    address_space_entry_t* e;
+    const address_space_handlers_t* h;
+    UINT16 word;
+
+    address &= space->addr_mask;
+    e = address_space_lookup(space, address);
+    if (e->read) {
+        return e->read[(address & space->page_mask) ^ space->byte_xor];
+    }
+
+    h = e->handlers;
+    if (h && h->read8) {
+        return h->read8(space, address);
+    }
+    if (h && h->read16) {
+        word = h->read16(space, address & ~1);
+        if ((address & 1) == (space->endianness == AS_ENDIAN_BIG ? 0 : 1)) {
+            return word >> 8;
+        }
+        return word & 0xFF;
+    }
+
+    return space->unmap_value;
+}
+
+UINT16 address_space_read16_slow(address_space_t* space, UINT32 address) {
+    address_space_entry_t* e;
+    UINT8 b0, b1;
+
+    address &= space->addr_mask & ~1;
+    e = address_space_lookup(space, address);
+    if (space->data_width == 16) {
+        if (e->read) {
+            return *(UINT16*)(e->read + (address & space->page_mask));
+        }
+        if (e->handlers && e->handlers->read16) {
+            return e->handlers->read16(space, address);
+        }
+    }
+
+    /* 8-bit bus or byte-wide handler: two cycles */
+    b0 = address_space_read8_slow(space, address);
+    b1 = address_space_read8_slow(space, address + 1);
+    if (space->endianness == AS_ENDIAN_BIG) {
+        return (b0 << 8) | b1;
+    }
+    return (b1 << 8) | b0;
+}
+
+UINT32 address_space_read32_slow(address_space_t* space, UINT32 address) {
+    UINT16 w0 = address_space_read16(space, address);
+    UINT16 w1 = address_space_read16(space, address + 2);
+
+    if (space->endianness == AS_ENDIAN_BIG) {
+        return ((UINT32)w0 << 16) | w1;
+    }
+    return ((UINT32)w1 << 16) | w0;
+}
+
+void address_space_write8_slow(address_space_t* space, UINT32 address, UINT8 data) {
+    address_space_entry_t* e;
+    const address_space_handlers_t* h;
+
+    address &= space->addr_mask;
+    e = address_space_lookup(space, address);
+    if (e->write) {
+        e->write[(address & space->page_mask) ^ space->byte_xor] = data;
+        return;
+    }
+
+    h = e->handlers;
+    if (h && h->write8) {
+        h->write8(space, address, data);
+    } else if (h && h->write16) {
+        /* 16-bit device without byte strobes sees the byte on both lanes */
+        h->write16(space, address & ~1, (data << 8) | data);
+    }
+}
+
+void address_space_write16_slow(address_space_t* space, UINT32 address, UINT16 data) {
+    address_space_entry_t* e;
+
+    address &= space->addr_mask & ~1;
+    e = address_space_lookup(space, address);
+    if (space->data_width == 16) {
+        if (e->write) {
+            *(UINT16*)(e->write + (address & space->page_mask)) = data;
+            return;
+        }
+        if (e->handlers && e->handlers->write16) {
+            e->handlers->write16(space, address, data);
+            return;
+        }
+    }
+
+    if (space->endianness == AS_ENDIAN_BIG) {
+        address_space_write8_slow(space, address, data >> 8);
+        address_space_write8_slow(space, address + 1, data & 0xFF);
+    } else {
+        address_space_write8_slow(space, address, data & 0xFF);
+        address_space_write8_slow(space, address + 1, data >> 8);
+    }
+}
+
+void address_space_write32_slow(address_space_t* space, UINT32 address, UINT32 data) {
+    if (space->endianness == AS_ENDIAN_BIG) {
+        address_space_write16(space, address, data >> 16);
+        address_space_write16(space, address + 2, data & 0xFFFF);
+    } else {
+        address_space_write16(space, address, data & 0xFFFF);
+        address_space_write16(space, address + 2, data >> 16);
+    }
+}
@@ -0,0 +1,185 @@
+/***************************************************************************
+ * MAME2003 Address Spaces for GameCube
+ *
+ * Configurable address space with a two-level page table, for CPUs with
+ * up to 24 (or more) address bits and a 16-bit data bus. The 8-bit Z80
+ * path in memory.c keeps its own single-level table.
+ *
+ * Word data is held in host order: when CPU and host endianness differ,
+ * ROM regions are byte-swapped per 16-bit word once at load time, so a
+ * word fetch is a single native load and byte accesses flip address
+ * bit 0. On the big-endian Gekko a 68000 needs no swapping at all.
+ ***************************************************************************/
+
+#ifndef ADDRSPACE_H
+#define ADDRSPACE_H
+
+#include "osd_gc.h"
+
+/***************************************************************************
+ * Configuration
+ ***************************************************************************/
+
+#define AS_ENDIAN_LITTLE    0
+#define AS_ENDIAN_BIG       1
+
+#if defined(__BIG_ENDIAN__) || \
+    (defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__)
+#define AS_HOST_ENDIAN      AS_ENDIAN_BIG
+#else
+#define AS_HOST_ENDIAN      AS_ENDIAN_LITTLE
+#endif
+
+typedef struct address_space address_space_t;
+
+/* Handlers for I/O pages; missing widths are built from the others */
+typedef struct {
+    UINT8  (*read8)(address_space_t* space, UINT32 address);
+    UINT16 (*read16)(address_space_t* space, UINT32 address);
+    void   (*write8)(address_space_t* space, UINT32 address, UINT8 data);
+    void   (*write16)(address_space_t* space, UINT32 address, UINT16 data);
+} address_space_handlers_t;
+
+/* One page table entry */
+typedef struct {
+    UINT8* read;          /* Direct read pointer to the page, or NULL */
+    UINT8* write;         /* Direct write pointer to the page, or NULL */
+    const address_space_handlers_t* handlers;
+} address_space_entry_t;
+
+struct address_space {
+    const char* name;
+    int addr_bits;
+    int data_width;       /* 8 or 16 */
+    int endianness;       /* AS_ENDIAN_xxx of the CPU */
+
+    UINT32 addr_mask;
+    UINT32 page_bits;
+    UINT32 page_mask;     /* Offset within a page */
+    UINT32 l1_shift;      /* Address bits above the second level */
+    UINT32 l2_mask;
+
+    /* Host word order differs from the CPU's (regions are pre-swapped) */
+    int swapped;
+    UINT32 byte_xor;      /* Applied to byte offsets when swapped */
+
+    address_space_entry_t** l1;
+    UINT32 l1_size;
+    UINT32 l2_size;
+    address_space_entry_t* unmapped;  /* Shared table for empty chunks */
+
+    UINT8 unmap_value;
+    void* param;          /* Owner data for handlers */
+};
+
+/***************************************************************************
+ * Functions
+ ***************************************************************************/
+
+/* Creation */
+address_space_t* address_space_create(const char* name, int addr_bits, int page_bits,
+                                      int data_width, int endianness);
+void address_space_destroy(address_space_t* space);
+
+/* Mapping (start/end must cover whole pages) */
+int  address_space_map_rom(address_space_t* space, UINT32 start, UINT32 end, UINT8* base);
+int  address_space_map_ram(address_space_t* space, UINT32 start, UINT32 end, UINT8* base);
+int  address_space_install_handlers(address_space_t* space, UINT32 start, UINT32 end,
+                                    const address_space_handlers_t* handlers);
+void address_space_unmap(address_space_t* space, UINT32 start, UINT32 end);
+
+/* Bring a memory region into this space's word order (done once) */
+void address_space_prepare_region(address_space_t* space, int region);
+
+/* Slow paths (handlers, unmapped, page-straddling accesses) */
+UINT8  address_space_read8_slow(address_space_t* space, UINT32 address);
+UINT16 address_space_read16_slow(address_space_t* space, UINT32 address);
+UINT32 address_space_read32_slow(address_space_t* space, UINT32 address);
+void   address_space_write8_slow(address_space_t* space, UINT32 address, UINT8 data);
+void   address_space_write16_slow(address_space_t* space, UINT32 address, UINT16 data);
+void   address_space_write32_slow(address_space_t* space, UINT32 address, UINT32 data);
+
+/***************************************************************************
+ * Accessors
+ ***************************************************************************/
+
+static INLINE address_space_entry_t* address_space_lookup(address_space_t* space, UINT32 address) {
+    return &space->l1[address >> space->l1_shift][(address >> space->page_bits) & space->l2_mask];
+}
+
+static INLINE UINT8 address_space_read8(address_space_t* space, UINT32 address) {
+    address_space_entry_t* e;
+
+    address &= space->addr_mask;
+    e = address_space_lookup(space, address);
+    if (e->read) {
+        return e->read[(address & space->page_mask) ^ space->byte_xor];
+    }
+    return address_space_read8_slow(space, address);
+}
+
+static INLINE UINT16 address_space_read16(address_space_t* space, UINT32 address) {
+    address_space_entry_t* e;
+
+    address &= space->addr_mask & ~1;
+    e = address_space_lookup(space, address);
+    if (e->read && space->data_width == 16) {
+        return *(UINT16*)(e->read + (address & space->page_mask));
+    }
+    return address_space_read16_slow(space, address);
+}
+
+static INLINE UINT32 address_space_read32(address_space_t* space, UINT32 address) {
+    address_space_entry_t* e;
+    UINT32 offset;
+    UINT32 data;
+
+    address &= space->addr_mask & ~1;
+    e = address_space_lookup(space, address);
+    offset = address & space->page_mask;
+    if (e->read && space->data_width == 16 && offset <= space->page_mask - 3) {
+        data = *(UINT32*)(e->read + offset);
+        return space->swapped ? (data << 16) | (data >> 16) : data;
+    }
+    return address_space_read32_slow(space, address);
+}
+
+static INLINE void address_space_write8(address_space_t* space, UINT32 address, UINT8 data) {
+    address_space_entry_t* e;
+
+    address &= space->addr_mask;
+    e = address_space_lookup(space, address);
+    if (e->write) {
+        e->write[(address & space->page_mask) ^ space->byte_xor] = data;
+        return;
+    }
+    address_space_write8_slow(space, address, data);
+}
+
+static INLINE void address_space_write16(address_space_t* space, UINT32 address, UINT16 data) {
+    address_space_entry_t* e;
+
+    address &= space->addr_mask & ~1;
+    e = address_space_lookup(space, address);
+    if (e->write && space->data_width == 16) {
+        *(UINT16*)(e->write + (address & space->page_mask)) = data;
+        return;
+    }
+    address_space_write16_slow(space, address, data);
+}
+
+static INLINE void address_space_write32(address_space_t* space, UINT32 address, UINT32 data) {
+    address_space_entry_t* e;
+    UINT32 offset;
+
+    address &= space->addr_mask & ~1;
+    e = address_space_lookup(space, address);
+    offset = address & space->page_mask;
+    if (e->write && space->data_width == 16 && offset <= space->page_mask - 3) {
+        *(UINT32*)(e->write + offset) = space->swapped ? (data << 16) | (data >> 16) : data;
+        return;
+    }
+    address_space_write32_slow(space, address, data);
+}
+
+#endif /* ADDRSPACE_H */
@@ -4005,8 +4005,8 @@ void z80_init(void)
 		int oldval, newval, val;
 		UINT8 *padd, *padc, *psub, *psbc;
 		/* allocate big flag arrays once */
-		SZHVC_add = (UINT8 *)malloc(2*256*256);
-		SZHVC_sub = (UINT8 *)malloc(2*256*256);
+		SZHVC_add = (UINT8 *)osd_malloc_tagged(2*256*256, OSD_MEM_CPU);
+		SZHVC_sub = (UINT8 *)osd_malloc_tagged(2*256*256, OSD_MEM_CPU);
 		if( !SZHVC_add || !SZHVC_sub )
 		{
 			if (!log_cb)
@@ -4168,9 +4168,9 @@ void z80_reset(void *param)
 void z80_exit(void)
 {
 #if BIG_FLAGS_ARRAY
-	if (SZHVC_add) free(SZHVC_add);
+	if (SZHVC_add) osd_free(SZHVC_add);
 	SZHVC_add = NULL;
-	if (SZHVC_sub) free(SZHVC_sub);
+	if (SZHVC_sub) osd_free(SZHVC_sub);
 	SZHVC_sub = NULL;
 #endif
 }
@@ -4,16 +4,68 @@
 
 #include "cpuintrf.h"
 #include "memory.h"
+#include "cpu/z80/z80.h"
 
-/* Forward declare pacman state for memory access */
-extern void* g_pacman_state;
-extern UINT8 pacman_read_byte(void* state, UINT16 address);
-extern void pacman_write_byte(void* state, UINT16 address, UINT8 data);
+/* Opcode base (empty range until the first fetch) */
+UINT8* cpu_opcode_base = NULL;
+UINT32 cpu_opcode_min = 1;
+UINT32 cpu_opcode_max = 0;
+
+/* Operand base - the data view, which differs from the opcode base only
+ * where opcodes are decrypted */
+UINT8* cpu_oparg_base = NULL;
+UINT32 cpu_oparg_min = 1;
+UINT32 cpu_oparg_max = 0;
+
+static cpu_code_invalidate_handler code_invalidate = NULL;
+
+/* Frame being run, for the beam position. A frame runs as one timeslice
+ * unless a timeslice is aborted; the cycles it had left are then run in
+ * the next one. */
+static int cpu_frame_cycles = 0;
+static int cpu_frame_lines = 0;
+static int cpu_frame_done = 0;      /* Cycles run by earlier timeslices */
+static int cpu_slice_cycles = 0;    /* Cycles given to the running timeslice */
+static int cpu_slice_aborted = 0;   /* Cycles it gave back by aborting */
 
 /* Stub implementations */
 
 void cpu_setOPbase16(int cpu, unsigned val) {
-    /* TODO: Implement PC change notification */
+    val &= 0xFFFF;
+    
+    if (!memory_get_opbase(val, &cpu_opcode_base, &cpu_opcode_min, &cpu_opcode_max)) {
+        /* Handler-mapped code: every fetch goes through the slow path */
+        cpu_opcode_base = NULL;
+        cpu_opcode_min = 1;
+        cpu_opcode_max = 0;
+    }
+    
+    if (!memory_get_argbase(val, &cpu_oparg_base, &cpu_oparg_min, &cpu_oparg_max)) {
+        cpu_oparg_base = NULL;
+        cpu_oparg_min = 1;
+        cpu_oparg_max = 0;
+    }
+}
+
+void cpu_invalidate_code(UINT32 start, UINT32 end) {
+    if (start <= cpu_opcode_max && end >= cpu_opcode_min) {
+        /* Refetch the base for the current PC on the next opcode read */
+        cpu_opcode_min = 1;
+        cpu_opcode_max = 0;
+    }
+    
+    if (start <= cpu_oparg_max && end >= cpu_oparg_min) {
+        cpu_oparg_min = 1;
+        cpu_oparg_max = 0;
+    }
+    
+    if (code_invalidate) {
+        code_invalidate(start, end);
+    }
+}
+
+void cpu_set_code_invalidate_handler(cpu_code_invalidate_handler handler) {
+    code_invalidate = handler;
 }
 
 void cpu_set_irq_line(int cpu, int irqline, int state) {
@@ -21,56 +73,104 @@ void cpu_set_irq_line(int cpu, int irqline, int state) {
 }
 
 void change_pc16(unsigned pc) {
-    /* TODO: Implement PC change callback */
+    pc &= 0xFFFF;
+    if (pc < cpu_opcode_min || pc > cpu_opcode_max) {
+        cpu_setOPbase16(0, pc);
+    }
 }
 
 int cpu_getactivecpu(void) {
     return 0; /* TODO: Return actual active CPU */
 }
 
-/* Memory access - route through Pac-Man driver if available */
-UINT8 cpu_readop(UINT32 address) {
-    /* Mask to 16-bit address space - Z80 is only 16-bit */
-    address &= 0xFFFF;
+UINT32 cpu_get_pc(void) {
+    return z80_get_reg(REG_PREVIOUSPC);
+}
+
+void cpu_abort_timeslice(void) {
+    /* Move the end of the timeslice here: execute loops while cycles
+     * remain, and the ones left are kept for the next timeslice rather
+     * than counted as run */
+    cpu_slice_aborted += z80_ICount;
+    z80_ICount = 0;
+}
+
+void cpu_begin_frame(int cycles_per_frame, int total_lines) {
+    cpu_frame_cycles = cycles_per_frame;
+    cpu_frame_lines = total_lines;
+    cpu_frame_done = 0;
+    cpu_slice_cycles = 0;
+    cpu_slice_aborted = 0;
+}
+
+int cpu_run_timeslice(void) {
+    int ran;
     
-    /* Use Pac-Man driver if available */
-    if (g_pacman_state) {
-        return pacman_read_byte(g_pacman_state, (UINT16)address);
+    cpu_slice_cycles = cpu_frame_cycles_left();
+    cpu_slice_aborted = 0;
+    if (cpu_slice_cycles <= 0) {
+        cpu_slice_cycles = 0;
+        return 0;
     }
     
-    /* Fall back to direct memory access */
-    return memory_read_byte(address);
+    ran = z80_execute(cpu_slice_cycles) - cpu_slice_aborted;
+    cpu_frame_done += ran;
+    cpu_slice_cycles = 0;
+    cpu_slice_aborted = 0;
+    return ran;
 }
 
-UINT8 cpu_readop_arg(UINT32 address) {
-    address &= 0xFFFF;  /* Mask to 16-bit */
+int cpu_frame_cycles_left(void) {
+    return cpu_frame_cycles - cpu_frame_done;
+}
+
+int cpu_getscanline(void) {
+    int elapsed;
     
-    if (g_pacman_state) {
-        return pacman_read_byte(g_pacman_state, (UINT16)address);
+    if (cpu_frame_cycles <= 0) {
+        return 0;
     }
     
-    return memory_read_byte(address);
+    /* z80_ICount counts down the cycles left in the timeslice */
+    elapsed = cpu_frame_done;
+    if (cpu_slice_cycles > 0) {
+        elapsed += cpu_slice_cycles - z80_ICount - cpu_slice_aborted;
+    }
+    elapsed = MAX(0, MIN(elapsed, cpu_frame_cycles - 1));
+    return elapsed * cpu_frame_lines / cpu_frame_cycles;
 }
 
-UINT8 cpu_readmem16(UINT32 address) {
-    address &= 0xFFFF;  /* Mask to 16-bit */
+/* Memory access - everything goes through the memory system page table */
+/* Opcode fetch outside the current base: find the new block, or fall
+ * back to a plain read for handler-mapped code */
+UINT8 cpu_readop_slow(UINT32 address) {
+    cpu_setOPbase16(0, address);
     
-    if (g_pacman_state) {
-        return pacman_read_byte(g_pacman_state, (UINT16)address);
+    if (address >= cpu_opcode_min && address <= cpu_opcode_max) {
+        return cpu_opcode_base[address];
     }
     
-    return memory_read_byte(address);
+    return memory_read_opcode(address);
 }
 
-void cpu_writemem16(UINT32 address, UINT8 data) {
-    address &= 0xFFFF;  /* Mask to 16-bit */
-    
-    if (g_pacman_state) {
-        pacman_write_byte(g_pacman_state, (UINT16)address, data);
-        return;
+/* Operand fetch outside the current operand base */
+UINT8 cpu_readop_arg_slow(UINT32 address) {
+    if (!memory_get_argbase(address, &cpu_oparg_base, &cpu_oparg_min, &cpu_oparg_max)) {
+        cpu_oparg_base = NULL;
+        cpu_oparg_min = 1;
+        cpu_oparg_max = 0;
+        return memory_read_oparg(address);
     }
     
-    memory_write_byte(address, data);
+    return cpu_oparg_base[address];
+}
+
+UINT8 cpu_readmem16(UINT32 address) {
+    return memory_read_byte(address & 0xFFFF);
+}
+
+void cpu_writemem16(UINT32 address, UINT8 data) {
+    memory_write_byte(address & 0xFFFF, data);
 }
 
 UINT16 cpu_readport16(UINT16 port) {
@@ -16,9 +16,59 @@ void cpu_setOPbase16(int cpu, unsigned val);
 void cpu_set_irq_line(int cpu, int irqline, int state);
 int  cpu_getactivecpu(void);
 
+/* Active CPU control */
+UINT32 cpu_get_pc(void);          /* PC of the instruction being executed */
+void   cpu_abort_timeslice(void); /* Return from execute after this instruction */
+
+/* Frame timeslices - a driver starts its frame with cpu_begin_frame and
+ * calls cpu_run_timeslice until no cycles are left. A timeslice runs the
+ * rest of the frame unless it is aborted (e.g. by a watchpoint break);
+ * it returns the cycles actually run. The scanline follows the cycles
+ * run across the frame. */
+void cpu_begin_frame(int cycles_per_frame, int total_lines);
+int  cpu_run_timeslice(void);
+int  cpu_frame_cycles_left(void);
+int  cpu_getscanline(void);
+
+/* Opcode base - direct pointer for the block the PC is executing in.
+ * cpu_opcode_base is address-relative: cpu_opcode_base[pc] is the opcode
+ * byte for any pc in [cpu_opcode_min, cpu_opcode_max]. */
+extern UINT8* cpu_opcode_base;
+extern UINT32 cpu_opcode_min;
+extern UINT32 cpu_opcode_max;
+
+/* Operand base - operands always come from the data view, so on boards
+ * with encrypted opcodes it points at the original ROM while the opcode
+ * base points at the decrypted copy. Both are plain direct pointers. */
+extern UINT8* cpu_oparg_base;
+extern UINT32 cpu_oparg_min;
+extern UINT32 cpu_oparg_max;
+
+UINT8 cpu_readop_slow(UINT32 address);
+UINT8 cpu_readop_arg_slow(UINT32 address);
+
+/* Drop the opcode base and any decoded code covering a changed range */
+typedef void (*cpu_code_invalidate_handler)(UINT32 start, UINT32 end);
+void cpu_invalidate_code(UINT32 start, UINT32 end);
+void cpu_set_code_invalidate_handler(cpu_code_invalidate_handler handler);
+
 /* Memory access functions */
-UINT8  cpu_readop(UINT32 address);
-UINT8  cpu_readop_arg(UINT32 address);
+static INLINE UINT8 cpu_readop(UINT32 address) {
+    address &= 0xFFFF;  /* Z80 is only 16-bit */
+    if (address >= cpu_opcode_min && address <= cpu_opcode_max) {
+        return cpu_opcode_base[address];
+    }
+    return cpu_readop_slow(address);
+}
+
+static INLINE UINT8 cpu_readop_arg(UINT32 address) {
+    address &= 0xFFFF;
+    if (address >= cpu_oparg_min && address <= cpu_oparg_max) {
+        return cpu_oparg_base[address];
+    }
+    return cpu_readop_arg_slow(address);
+}
+
 UINT8  cpu_readmem16(UINT32 address);
 void   cpu_writemem16(UINT32 address, UINT8 data);
 UINT16 cpu_readport16(UINT16 port);
@@ -4,6 +4,7 @@
 
 #include "memory.h"
 #include "osd_gc.h"
+#include "cpuintrf.h"
 #include <string.h>
 #include <stdio.h>
 
@@ -17,10 +18,59 @@
 static memory_region_t regions[MAX_MEMORY_REGIONS];
 static int num_regions = 0;
 
+static memory_bank_t banks[MAX_MEMORY_BANKS];
+
 /* Simple flat memory map for now (will expand for banking later) */
 static UINT8* memory_map[256];  /* 256 pages of 256 bytes = 64KB address space */
 static int memory_map_ro[256];  /* Read-only flags */
 
+/* Fast paths: direct pointer per page. NULL sends the access to
+ * memory_read_slow()/memory_write_slow() (ROM writes, handlers, tracked
+ * and watched pages) */
+static UINT8* memory_read_map[256];
+static UINT8* memory_write_map[256];
+
+/* Opcode fetch: decrypted copy for pages whose opcodes differ from their
+ * data, and the resolved per-page source (decrypted copy or data) */
+static UINT8* memory_opcode_map[256];
+static UINT8* memory_fetch_map[256];
+
+/* Handler-based pages (I/O) */
+static UINT8 (*memory_read_handlers[256])(UINT32);
+static void (*memory_write_handlers[256])(UINT32, UINT8);
+
+/* Write tracking */
+typedef struct {
+    int active;
+    int granularity;      /* MEMORY_TRACK_xxx */
+    UINT32 start;
+    UINT32 end;
+    UINT32 page_bits[256 / 32];
+    UINT32* byte_bits;    /* One bit per byte, MEMORY_TRACK_BYTES only */
+} memory_tracker_t;
+
+static memory_tracker_t trackers[MAX_MEMORY_TRACKERS];
+static UINT8 memory_track_mask[256];  /* Trackers watching each page */
+static memory_tracking_stats track_stats;
+
+/* Watchpoints */
+typedef struct {
+    int flags;            /* MEMORY_WATCH_xxx, 0 = unused */
+    UINT32 start;
+    UINT32 end;
+    UINT32 hits;
+} memory_watchpoint_t;
+
+static memory_watchpoint_t watchpoints[MAX_MEMORY_WATCHPOINTS];
+static UINT16 memory_watch_read_mask[256];   /* Read watchpoints per page */
+static UINT16 memory_watch_write_mask[256];  /* Write watchpoints per page */
+
+static memory_watch_hit watch_log[MEMORY_WATCH_LOG_SIZE];
+static UINT32 watch_log_head = 0;            /* Next entry to write */
+static UINT32 watch_log_count = 0;           /* Entries not yet read */
+static UINT32 watch_log_dropped = 0;         /* Entries overwritten unread */
+static int watch_break = 0;
+
 /***************************************************************************
  * Memory System Initialization
  ***************************************************************************/
@@ -36,8 +86,21 @@ int memory_init(void) {
     for (i = 0; i < 256; i++) {
         memory_map[i] = NULL;
         memory_map_ro[i] = 0;
+        memory_read_map[i] = NULL;
+        memory_write_map[i] = NULL;
+        memory_opcode_map[i] = NULL;
+        memory_fetch_map[i] = NULL;
+        memory_read_handlers[i] = NULL;
+        memory_write_handlers[i] = NULL;
+        memory_track_mask[i] = 0;
     }
     
+    memset(banks, 0, sizeof(banks));
+    cpu_invalidate_code(0x0000, 0xFFFF);
+    memset(trackers, 0, sizeof(trackers));
+    memset(&track_stats, 0, sizeof(track_stats));
+    memory_watch_clear_all();
+    
     printf("Memory system initialized\n");
     return 0;
 }
@@ -45,12 +108,20 @@ int memory_init(void) {
 void memory_shutdown(void) {
     int i;
     
-    /* Free all allocated regions */
-    for (i = 0; i < num_regions; i++) {
+    for (i = 0; i < MAX_MEMORY_TRACKERS; i++) {
+        memory_untrack_writes(i);
+    }
+    
+    /* Free all allocated regions, newest first: ARAM stores are a stack */
+    for (i = num_regions - 1; i >= 0; i--) {
         if (regions[i].base) {
             osd_free(regions[i].base);
             regions[i].base = NULL;
         }
+        if (regions[i].paged) {
+            paged_region_destroy(regions[i].paged);
+            regions[i].paged = NULL;
+        }
     }
     
     num_regions = 0;
@@ -75,7 +146,7 @@ int memory_region_alloc(int region, UINT32 size, const char* name) {
     }
     
     /* Allocate memory */
-    base = (UINT8*)osd_malloc(size);
+    base = (UINT8*)osd_malloc_tagged(size, OSD_MEM_REGION);
     if (!base) {
         printf("ERROR: Failed to allocate %u bytes for region %s\n", size, name);
         return -1;
@@ -89,6 +160,8 @@ int memory_region_alloc(int region, UINT32 size, const char* name) {
     regions[num_regions].size = size;
     regions[num_regions].type = region;
     regions[num_regions].name = name;
+    regions[num_regions].paged = NULL;
+    regions[num_regions].flags = 0;
     
     printf("Allocated region %s: %u bytes at %p\n", name, size, base);
     
@@ -96,6 +169,41 @@ int memory_region_alloc(int region, UINT32 size, const char* name) {
     return 0;
 }
 
+int memory_region_alloc_paged(int region, UINT32 size, UINT32 page_size,
+                              UINT32 cache_pages, const char* name) {
+    paged_store_t* store;
+    paged_region_t* paged;
+    UINT32 store_size;
+    
+    if (num_regions >= MAX_MEMORY_REGIONS) {
+        printf("ERROR: Too many memory regions\n");
+        return -1;
+    }
+    
+    /* Backing store is rounded up to whole pages */
+    store_size = (size + page_size - 1) & ~(page_size - 1);
+    store = paged_store_create_default(store_size);
+    if (!store) {
+        printf("ERROR: Failed to allocate backing store for region %s\n", name);
+        return -1;
+    }
+    
+    paged = paged_region_create(store, size, page_size, cache_pages, name);
+    if (!paged) {
+        return -1;
+    }
+    
+    regions[num_regions].base = NULL;
+    regions[num_regions].size = size;
+    regions[num_regions].type = region;
+    regions[num_regions].name = name;
+    regions[num_regions].paged = paged;
+    regions[num_regions].flags = 0;
+    
+    num_regions++;
+    return 0;
+}
+
 void memory_region_free(int region) {
     int i;
     
@@ -105,7 +213,64 @@ void memory_region_free(int region) {
             osd_free(regions[i].base);
             regions[i].base = NULL;
         }
+        if (regions[i].type == region && regions[i].paged) {
+            printf("Freeing paged region %s\n", regions[i].name);
+            paged_region_destroy(regions[i].paged);
+            regions[i].paged = NULL;
+        }
+    }
+}
+
+paged_region_t* memory_region_get_paged(int region) {
+    int i;
+    
+    for (i = 0; i < num_regions; i++) {
+        if (regions[i].type == region) {
+            return regions[i].paged;
+        }
+    }
+    
+    return NULL;
+}
+
+static memory_region_t* memory_region_find(int region) {
+    int i;
+    
+    for (i = 0; i < num_regions; i++) {
+        if (regions[i].type == region) {
+            return &regions[i];
+        }
+    }
+    
+    return NULL;
+}
+
+static void memory_swap16(UINT8* data, UINT32 size) {
+    UINT32 i;
+    UINT8 t;
+    
+    for (i = 0; i + 1 < size; i += 2) {
+        t = data[i];
+        data[i] = data[i + 1];
+        data[i + 1] = t;
+    }
+}
+
+int memory_region_swap16(int region) {
+    memory_region_t* r = memory_region_find(region);
+    
+    if (!r || !r->base) {
+        printf("ERROR: Cannot swap region 0x%02X\n", region);
+        return -1;
     }
+    
+    if (r->flags & MEMORY_REGION_SWAPPED16) {
+        return 0;
+    }
+    
+    memory_swap16(r->base, r->size);
+    r->flags |= MEMORY_REGION_SWAPPED16;
+    return 0;
 }
 
 UINT8* memory_region_get_base(int region) {
@@ -136,20 +301,296 @@ UINT32 memory_region_get_size(int region) {
  * Memory Mapping
  ***************************************************************************/
 
+/* Recompute the fast-path pointer for a page after any change to it */
+static void memory_update_page(int page) {
+    if (memory_map[page] && !memory_watch_read_mask[page]) {
+        memory_read_map[page] = memory_map[page];
+    } else {
+        memory_read_map[page] = NULL;
+    }
+    
+    if (memory_map[page] && !memory_map_ro[page] && !memory_write_handlers[page] &&
+        !memory_track_mask[page] && !memory_watch_write_mask[page]) {
+        memory_write_map[page] = memory_map[page];
+    } else {
+        memory_write_map[page] = NULL;
+    }
+    
+    memory_fetch_map[page] = memory_opcode_map[page] ? memory_opcode_map[page] : memory_map[page];
+}
+
+/***************************************************************************
+ * Banking
+ ***************************************************************************/
+
+int memory_configure_bank(int bank, UINT32 start, UINT32 end, int read_only, const char* name) {
+    memory_bank_t* b;
+    
+    if (bank < 0 || bank >= MAX_MEMORY_BANKS || end < start || end > 0xFFFF ||
+        (start & 0xFF) || (end & 0xFF) != 0xFF) {
+        printf("ERROR: Bad bank %d ($%04X-$%04X)\n", bank, start, end);
+        return -1;
+    }
+    
+    b = &banks[bank];
+    memset(b, 0, sizeof(*b));
+    b->start = start;
+    b->end = end;
+    b->size = end - start + 1;
+    b->read_only = read_only;
+    b->name = name;
+    
+    printf("Bank %d (%s): $%04X-$%04X, %u pages\n", bank, name, start, end, b->size >> 8);
+    return 0;
+}
+
+void memory_configure_bank_entries(int bank, UINT8* base, int count, UINT32 stride) {
+    memory_bank_t* b;
+    int i;
+    
+    if (bank < 0 || bank >= MAX_MEMORY_BANKS || count > MAX_BANK_ENTRIES) {
+        return;
+    }
+    
+    b = &banks[bank];
+    for (i = 0; i < count; i++) {
+        b->entries[i] = base + i * stride;
+    }
+    b->num_entries = count;
+    
+    /* Decrypted copies belonged to the old entries */
+    memset(b->decrypted, 0, sizeof(b->decrypted));
+}
+
+void memory_configure_bank_decrypted(int bank, UINT8* base, UINT32 stride) {
+    memory_bank_t* b;
+    UINT8* current;
+    int i;
+    
+    if (bank < 0 || bank >= MAX_MEMORY_BANKS || !banks[bank].size) {
+        return;
+    }
+    
+    b = &banks[bank];
+    current = b->base;
+    for (i = 0; i < b->num_entries; i++) {
+        b->decrypted[i] = base ? base + i * stride : NULL;
+    }
+    
+    /* The entry already mapped picks up its copy now */
+    b->base = NULL;
+    memory_set_bankptr(bank, current);
+}
+
 void memory_set_bankptr(int bank, UINT8* base) {
-    if (bank < 0 || bank >= 256) {
+    memory_bank_t* b;
+    UINT8* decrypted = NULL;
+    UINT32 page, first, last;
+    int i;
+    
+    if (bank < 0 || bank >= MAX_MEMORY_BANKS || !banks[bank].size) {
         return;
     }
     
-    memory_map[bank] = base;
-    memory_map_ro[bank] = 1;  /* Assume ROM by default */
+    b = &banks[bank];
+    
+    /* Games often rewrite the same bank every frame */
+    if (b->base == base) {
+        return;
+    }
+    
+    /* Opcodes come from the decrypted copy of the entry, if it has one */
+    for (i = 0; i < b->num_entries; i++) {
+        if (b->entries[i] == base) {
+            decrypted = b->decrypted[i];
+            break;
+        }
+    }
+    
+    b->base = base;
+    b->decrypted_base = decrypted;
+    b->switches++;
+    
+    first = b->start >> 8;
+    last = b->end >> 8;
+    for (page = first; page <= last; page++) {
+        memory_map[page] = base ? base + ((page - first) << 8) : NULL;
+        memory_map_ro[page] = b->read_only;
+        memory_opcode_map[page] = decrypted ? decrypted + ((page - first) << 8) : NULL;
+        memory_update_page(page);
+    }
+    
+    /* Drop opcode base and decoded code that pointed at the old target */
+    cpu_invalidate_code(b->start, b->end);
+}
+
+void memory_set_bank(int bank, int entry) {
+    if (bank < 0 || bank >= MAX_MEMORY_BANKS || entry < 0 || entry >= banks[bank].num_entries) {
+        return;
+    }
+    
+    memory_set_bankptr(bank, banks[bank].entries[entry]);
+}
+
+const memory_bank_t* memory_get_bank(int bank) {
+    if (bank < 0 || bank >= MAX_MEMORY_BANKS) {
+        return NULL;
+    }
+    return &banks[bank];
+}
+
+/* Longest run of contiguous pages around an address in one page table */
+static int memory_find_block(UINT8* const* map, UINT32 address,
+                             UINT8** base, UINT32* min, UINT32* max) {
+    int page = (address >> 8) & 0xFF;
+    int first = page;
+    int last = page;
+    UINT8* origin = map[page];
+    
+    if (!origin) {
+        return 0;
+    }
+    
+    /* Grow the window while neighbouring pages continue the same block */
+    while (first > 0 && map[first - 1] == origin - ((page - first + 1) << 8)) {
+        first--;
+    }
+    while (last < 255 && map[last + 1] == origin + ((last + 1 - page) << 8)) {
+        last++;
+    }
+    
+    *base = origin - (page << 8);
+    *min = first << 8;
+    *max = (last << 8) | 0xFF;
+    return 1;
+}
+
+int memory_get_opbase(UINT32 address, UINT8** base, UINT32* min, UINT32* max) {
+    return memory_find_block(memory_fetch_map, address, base, min, max);
+}
+
+int memory_get_argbase(UINT32 address, UINT8** base, UINT32* min, UINT32* max) {
+    return memory_find_block(memory_map, address, base, min, max);
+}
+
+/***************************************************************************
+ * Encrypted Opcodes
+ ***************************************************************************/
+
+/* First configured bank at or above 'start', or -1 */
+static int memory_next_bank(UINT32 start) {
+    int next = -1;
+    int i;
+    
+    for (i = 0; i < MAX_MEMORY_BANKS; i++) {
+        if (banks[i].size && banks[i].end >= start &&
+            (next < 0 || banks[i].start < banks[next].start)) {
+            next = i;
+        }
+    }
+    return next;
+}
+
+int memory_set_decrypted_opcodes(UINT32 start, UINT32 end, UINT8* base) {
+    int page;
+    int bank;
+    
+    if (end < start || end > 0xFFFF || (start & 0xFF) || (end & 0xFF) != 0xFF) {
+        printf("ERROR: Bad decrypted opcode range $%04X-$%04X\n", start, end);
+        return -1;
+    }
+    
+    /* A bank switch would leave these pages decrypting another entry */
+    bank = memory_next_bank(start);
+    if (bank >= 0 && banks[bank].start <= end) {
+        printf("ERROR: Decrypted opcodes $%04X-$%04X overlap bank %d (%s)\n",
+               start, end, bank, banks[bank].name);
+        return -1;
+    }
+    
+    for (page = start >> 8; page <= (int)(end >> 8); page++) {
+        memory_opcode_map[page] = base ? base + ((page << 8) - start) : NULL;
+        memory_update_page(page);
+    }
+    
+    cpu_invalidate_code(start, end);
+    return 0;
+}
+
+int memory_decrypt_opcodes(int src_region, int dst_region, UINT32 start,
+                           memory_decrypt_handler decrypt, const char* name) {
+    UINT8* src = memory_region_get_base(src_region);
+    UINT32 size = memory_region_get_size(src_region);
+    UINT8* dst;
+    UINT32 first = start;
+    UINT32 end;
+    UINT32 i;
+    int bank;
+    int result = 0;
+    
+    if (!src || !decrypt || (start & 0xFF) || start > 0xFFFF) {
+        printf("ERROR: No source region to decrypt for %s\n", name);
+        return -1;
+    }
+    
+    /* Whole pages only, and no further than the top of the address space */
+    size = MIN(size, 0x10000 - start);
+    if (memory_region_alloc(dst_region, (size + 0xFF) & ~0xFF, name) != 0) {
+        return -1;
+    }
+    
+    /* Done once here - opcode fetches read the result directly */
+    dst = memory_region_get_base(dst_region);
+    for (i = 0; i < size; i++) {
+        dst[i] = decrypt(start + i, src[i]);
+    }
+    
+    /* Map each run of fixed pages; banked parts of the copy are mapped
+     * per entry by the driver, so an overlap is reported */
+    end = (start + size - 1) | 0xFF;
+    while (start <= end) {
+        UINT32 run_end = end;
+        
+        bank = memory_next_bank(start);
+        if (bank >= 0 && banks[bank].start <= start) {
+            printf("ERROR: Decrypted opcodes for %s overlap bank %d (%s)\n",
+                   name, bank, banks[bank].name);
+            result = -1;
+            start = banks[bank].end + 1;
+            continue;
+        }
+        if (bank >= 0 && banks[bank].start <= end) {
+            run_end = banks[bank].start - 1;
+        }
+        
+        if (memory_set_decrypted_opcodes(start, run_end, dst + (start - first)) != 0) {
+            return -1;
+        }
+        start = run_end + 1;
+    }
+    
+    return result;
 }
 
 /***************************************************************************
  * Direct Memory Access
  ***************************************************************************/
 
-UINT8 memory_read_byte(UINT32 address) {
+static void memory_watch_check(UINT32 address, UINT8 data, int type);
+
+/* Opcode fetch outside any direct block */
+UINT8 memory_read_opcode(UINT32 address) {
+    UINT8 page = (address >> 8) & 0xFF;
+    
+    if (memory_fetch_map[page]) {
+        return memory_fetch_map[page][address & 0xFF];
+    }
+    
+    return memory_read_oparg(address);
+}
+
+/* Read without watchpoints: operand fetches and the debugger use this */
+UINT8 memory_read_oparg(UINT32 address) {
     UINT8 page = (address >> 8) & 0xFF;
     UINT8 offset = address & 0xFF;
     
@@ -157,17 +598,68 @@ UINT8 memory_read_byte(UINT32 address) {
         return memory_map[page][offset];
     }
     
+    if (memory_read_handlers[page]) {
+        return memory_read_handlers[page](address);
+    }
+    
     /* Unmapped memory returns 0xFF */
     return 0xFF;
 }
 
-void memory_write_byte(UINT32 address, UINT8 data) {
+static UINT8 memory_read_slow(UINT32 address) {
+    UINT8 data = memory_read_oparg(address);
+    
+    if (memory_watch_read_mask[(address >> 8) & 0xFF]) {
+        memory_watch_check(address & 0xFFFF, data, MEMORY_WATCH_READ);
+    }
+    
+    return data;
+}
+
+UINT8 memory_read_byte(UINT32 address) {
+    UINT8* ptr = memory_read_map[(address >> 8) & 0xFF];
+    
+    if (ptr) {
+        return ptr[address & 0xFF];
+    }
+    
+    return memory_read_slow(address);
+}
+
+static void memory_write_slow(UINT32 address, UINT8 data) {
     UINT8 page = (address >> 8) & 0xFF;
     UINT8 offset = address & 0xFF;
     
-    if (memory_map[page] && !memory_map_ro[page]) {
+    int stored = 1;
+    
+    if (memory_write_handlers[page]) {
+        memory_write_handlers[page](address, data);
+    } else if (memory_map[page] && !memory_map_ro[page]) {
         memory_map[page][offset] = data;
+    } else {
+        stored = 0;
     }
+    
+    if (stored && memory_track_mask[page]) {
+        memory_mark_dirty(address & 0xFFFF);
+    }
+    
+    /* Writes to ROM or unmapped space change nothing, but are watched
+     * like any other ("who writes here") */
+    if (memory_watch_write_mask[page]) {
+        memory_watch_check(address & 0xFFFF, data, MEMORY_WATCH_WRITE);
+    }
+}
+
+void memory_write_byte(UINT32 address, UINT8 data) {
+    UINT8* ptr = memory_write_map[(address >> 8) & 0xFF];
+    
+    if (ptr) {
+        ptr[address & 0xFF] = data;
+        return;
+    }
+    
+    memory_write_slow(address, data);
 }
 
 /***************************************************************************
@@ -177,6 +669,15 @@ void memory_write_byte(UINT32 address, UINT8 data) {
 int memory_load_rom(int region, const UINT8* data, UINT32 size) {
     UINT8* base = memory_region_get_base(region);
     UINT32 region_size = memory_region_get_size(region);
+    paged_region_t* paged = memory_region_get_paged(region);
+    
+    if (paged) {
+        if (paged_region_load(paged, 0, data, size) != 0) {
+            return -1;
+        }
+        printf("Loaded paged ROM: %u bytes\n", size);
+        return 0;
+    }
     
     if (!base) {
         printf("ERROR: Region not allocated\n");
@@ -188,8 +689,11 @@ int memory_load_rom(int region, const UINT8* data, UINT32 size) {
         return -1;
     }
     
-    /* Copy ROM data */
+    /* Copy ROM data, keeping the region's word order */
     memcpy(base, data, size);
+    if (memory_region_find(region)->flags & MEMORY_REGION_SWAPPED16) {
+        memory_swap16(base, size);
+    }
     
     printf("Loaded ROM: %u bytes\n", size);
     return 0;
@@ -207,9 +711,11 @@ void memory_map_rom(UINT32 start_addr, UINT32 end_addr, UINT8* base) {
         UINT8 page = (addr >> 8) & 0xFF;
         memory_map[page] = base + offset;
         memory_map_ro[page] = 1;  /* ROM is read-only */
+        memory_update_page(page);
         offset += 256;
     }
     
+    cpu_invalidate_code(start_addr, end_addr);
     printf("Mapped ROM: $%04X-$%04X (%u bytes)\n", start_addr, end_addr, end_addr - start_addr + 1);
 }
 
@@ -221,9 +727,11 @@ void memory_map_ram(UINT32 start_addr, UINT32 end_addr, UINT8* base) {
         UINT8 page = (addr >> 8) & 0xFF;
         memory_map[page] = base + offset;
         memory_map_ro[page] = 0;  /* RAM is read/write */
+        memory_update_page(page);
         offset += 256;
     }
     
+    cpu_invalidate_code(start_addr, end_addr);
     printf("Mapped RAM: $%04X-$%04X (%u bytes)\n", start_addr, end_addr, end_addr - start_addr + 1);
 }
 
@@ -241,7 +749,7 @@ void memory_dump(UINT32 address, UINT32 length) {
             printf("%04X: ", address + i);
         }
         
-        printf("%02X ", memory_read_byte(address + i));
+        printf("%02X ", memory_read_oparg(address + i));
         
         if (i % 16 == 15) {
             printf("\n");
@@ -253,13 +761,391 @@ void memory_dump(UINT32 address, UINT32 length) {
     }
 }
 
-/* Export mapping functions */
+/***************************************************************************
+ * Handler Installation
+ *
+ * Handlers cover whole 256-byte pages and take precedence over any direct
+ * mapping there; the page's memory_map entry is cleared.
+ ***************************************************************************/
+
 void memory_install_read_handler(UINT32 start, UINT32 end, UINT8 (*handler)(UINT32)) {
-    /* TODO: Implement handler-based reads */
-    printf("TODO: Install read handler $%04X-$%04X\n", start, end);
+    UINT32 addr;
+    
+    for (addr = start & ~0xFF; addr <= end; addr += 256) {
+        UINT8 page = (addr >> 8) & 0xFF;
+        memory_read_handlers[page] = handler;
+        memory_map[page] = NULL;
+        memory_update_page(page);
+    }
+    
+    cpu_invalidate_code(start, end);
+    printf("Installed read handler: $%04X-$%04X\n", start, end);
 }
 
 void memory_install_write_handler(UINT32 start, UINT32 end, void (*handler)(UINT32, UINT8)) {
-    /* TODO: Implement handler-based writes */
-    printf("TODO: Install write handler $%04X-$%04X\n", start, end);
+    UINT32 addr;
+    
+    for (addr = start & ~0xFF; addr <= end; addr += 256) {
+        UINT8 page = (addr >> 8) & 0xFF;
+        memory_write_handlers[page] = handler;
+        memory_map[page] = NULL;
+        memory_update_page(page);
+    }
+    
+    cpu_invalidate_code(start, end);
+    printf("Installed write handler: $%04X-$%04X\n", start, end);
+}
+
+/***************************************************************************
+ * Write Tracking
+ *
+ * Tracked pages lose their fast-path write pointer, so every write to them
+ * goes through memory_write_slow() and lands here. Pages nobody tracks
+ * keep their direct pointers and pay nothing.
+ ***************************************************************************/
+
+int memory_track_writes(UINT32 start, UINT32 end, int granularity) {
+    memory_tracker_t* t = NULL;
+    UINT32 addr;
+    int id;
+    
+    if (end < start || end > 0xFFFF) {
+        return -1;
+    }
+    
+    for (id = 0; id < MAX_MEMORY_TRACKERS; id++) {
+        if (!trackers[id].active) {
+            t = &trackers[id];
+            break;
+        }
+    }
+    
+    if (!t) {
+        printf("ERROR: Too many write trackers\n");
+        return -1;
+    }
+    
+    memset(t, 0, sizeof(*t));
+    t->start = start;
+    t->end = end;
+    t->granularity = granularity;
+    
+    if (granularity == MEMORY_TRACK_BYTES) {
+        UINT32 length = end - start + 1;
+        
+        if (length > MEMORY_TRACK_MAX_BYTES) {
+            printf("ERROR: Byte tracking limited to %u bytes\n", MEMORY_TRACK_MAX_BYTES);
+            return -1;
+        }
+        
+        t->byte_bits = osd_calloc_tagged((length + 31) / 32, sizeof(UINT32), OSD_MEM_STATE);
+        if (!t->byte_bits) {
+            return -1;
+        }
+    }
+    
+    t->active = 1;
+    
+    for (addr = start & ~0xFF; addr <= end; addr += 256) {
+        UINT8 page = addr >> 8;
+        memory_track_mask[page] |= 1 << id;
+        memory_update_page(page);
+    }
+    
+    return id;
+}
+
+void memory_untrack_writes(int tracker) {
+    memory_tracker_t* t;
+    int page;
+    
+    if (tracker < 0 || tracker >= MAX_MEMORY_TRACKERS || !trackers[tracker].active) {
+        return;
+    }
+    
+    t = &trackers[tracker];
+    
+    for (page = 0; page < 256; page++) {
+        if (memory_track_mask[page] & (1 << tracker)) {
+            memory_track_mask[page] &= ~(1 << tracker);
+            memory_update_page(page);
+        }
+    }
+    
+    osd_free(t->byte_bits);
+    memset(t, 0, sizeof(*t));
+}
+
+void memory_mark_dirty(UINT32 address) {
+    UINT8 mask = memory_track_mask[(address >> 8) & 0xFF];
+    int id;
+    
+    track_stats.tracked_writes++;
+    
+    for (id = 0; mask; id++, mask >>= 1) {
+        memory_tracker_t* t = &trackers[id];
+        UINT32 offset;
+        
+        if (!(mask & 1) || address < t->start || address > t->end) {
+            continue;
+        }
+        
+        t->page_bits[address >> 13] |= 1u << ((address >> 8) & 31);
+        
+        if (t->byte_bits) {
+            offset = address - t->start;
+            t->byte_bits[offset >> 5] |= 1u << (offset & 31);
+        }
+    }
+}
+
+/* Report runs of set bits in a bitmap as address ranges */
+static int memory_dirty_runs(UINT32* bits, UINT32 count, UINT32 base, UINT32 unit,
+                             UINT32 clip_start, UINT32 clip_end,
+                             memory_dirty_callback callback, void* param) {
+    UINT32 i = 0;
+    int ranges = 0;
+    
+    while (i < count) {
+        UINT32 run_start;
+        UINT32 start, end;
+        
+        /* Skip clean words quickly */
+        if ((i & 31) == 0 && bits[i >> 5] == 0) {
+            i += 32;
+            continue;
+        }
+        if (!(bits[i >> 5] & (1u << (i & 31)))) {
+            i++;
+            continue;
+        }
+        
+        run_start = i;
+        while (i < count && (bits[i >> 5] & (1u << (i & 31)))) {
+            i++;
+        }
+        
+        start = MAX(base + run_start * unit, clip_start);
+        end = MIN(base + i * unit - 1, clip_end);
+        if (callback) {
+            callback(start, end, param);
+        }
+        ranges++;
+    }
+    
+    memset(bits, 0, ((count + 31) / 32) * sizeof(UINT32));
+    return ranges;
+}
+
+int memory_dirty_iterate(int tracker, memory_dirty_callback callback, void* param) {
+    memory_tracker_t* t;
+    int ranges;
+    
+    if (tracker < 0 || tracker >= MAX_MEMORY_TRACKERS || !trackers[tracker].active) {
+        return 0;
+    }
+    
+    t = &trackers[tracker];
+    
+    if (t->byte_bits) {
+        ranges = memory_dirty_runs(t->byte_bits, t->end - t->start + 1, t->start, 1,
+                                   t->start, t->end, callback, param);
+        memset(t->page_bits, 0, sizeof(t->page_bits));
+    } else {
+        ranges = memory_dirty_runs(t->page_bits, 256, 0, 256,
+                                   t->start, t->end, callback, param);
+    }
+    
+    track_stats.ranges_reported += ranges;
+    return ranges;
+}
+
+int memory_is_dirty(int tracker) {
+    int i;
+    
+    if (tracker < 0 || tracker >= MAX_MEMORY_TRACKERS || !trackers[tracker].active) {
+        return 0;
+    }
+    
+    for (i = 0; i < 256 / 32; i++) {
+        if (trackers[tracker].page_bits[i]) {
+            return 1;
+        }
+    }
+    
+    return 0;
+}
+
+void memory_dirty_clear(int tracker) {
+    memory_dirty_iterate(tracker, NULL, NULL);
+}
+
+void memory_get_tracking_stats(memory_tracking_stats* stats) {
+    *stats = track_stats;
+}
+
+/***************************************************************************
+ * Watchpoints
+ *
+ * A watched page simply loses its direct read and/or write pointer, so its
+ * accesses fall into the slow path where the watch list is checked. Every
+ * other page keeps running at full speed.
+ ***************************************************************************/
+
+int memory_watch_add(UINT32 start, UINT32 end, int flags) {
+    UINT32 addr;
+    int id;
+    
+    if (end < start || end > 0xFFFF || !(flags & (MEMORY_WATCH_READ | MEMORY_WATCH_WRITE))) {
+        return -1;
+    }
+    
+    for (id = 0; id < MAX_MEMORY_WATCHPOINTS; id++) {
+        if (!watchpoints[id].flags) {
+            break;
+        }
+    }
+    
+    if (id == MAX_MEMORY_WATCHPOINTS) {
+        printf("ERROR: Too many watchpoints\n");
+        return -1;
+    }
+    
+    watchpoints[id].flags = flags;
+    watchpoints[id].start = start;
+    watchpoints[id].end = end;
+    watchpoints[id].hits = 0;
+    
+    for (addr = start & ~0xFF; addr <= end; addr += 256) {
+        UINT8 page = addr >> 8;
+        if (flags & MEMORY_WATCH_READ) {
+            memory_watch_read_mask[page] |= 1 << id;
+        }
+        if (flags & MEMORY_WATCH_WRITE) {
+            memory_watch_write_mask[page] |= 1 << id;
+        }
+        memory_update_page(page);
+    }
+    
+    printf("Watchpoint %d: $%04X-$%04X%s%s%s\n", id, start, end,
+           (flags & MEMORY_WATCH_READ) ? " R" : "",
+           (flags & MEMORY_WATCH_WRITE) ? " W" : "",
+           (flags & MEMORY_WATCH_BREAK) ? " break" : "");
+    return id;
+}
+
+void memory_watch_remove(int id) {
+    int page;
+    
+    if (id < 0 || id >= MAX_MEMORY_WATCHPOINTS || !watchpoints[id].flags) {
+        return;
+    }
+    
+    for (page = 0; page < 256; page++) {
+        if ((memory_watch_read_mask[page] | memory_watch_write_mask[page]) & (1 << id)) {
+            memory_watch_read_mask[page] &= ~(1 << id);
+            memory_watch_write_mask[page] &= ~(1 << id);
+            memory_update_page(page);
+        }
+    }
+    
+    memset(&watchpoints[id], 0, sizeof(watchpoints[id]));
+}
+
+void memory_watch_clear_all(void) {
+    int page;
+    
+    memset(watchpoints, 0, sizeof(watchpoints));
+    memset(memory_watch_read_mask, 0, sizeof(memory_watch_read_mask));
+    memset(memory_watch_write_mask, 0, sizeof(memory_watch_write_mask));
+    
+    for (page = 0; page < 256; page++) {
+        memory_update_page(page);
+    }
+    
+    watch_log_head = 0;
+    watch_log_count = 0;
+    watch_log_dropped = 0;
+    watch_break = 0;
+}
+
+static void memory_watch_check(UINT32 address, UINT8 data, int type) {
+    UINT16 mask = (type == MEMORY_WATCH_READ) ?
+        memory_watch_read_mask[address >> 8] : memory_watch_write_mask[address >> 8];
+    int id;
+    
+    for (id = 0; mask; id++, mask >>= 1) {
+        memory_watchpoint_t* wp = &watchpoints[id];
+        memory_watch_hit* hit;
+        
+        if (!(mask & 1) || address < wp->start || address > wp->end) {
+            continue;
+        }
+        
+        wp->hits++;
+        
+        /* Log into the ring, overwriting the oldest entry when full */
+        hit = &watch_log[watch_log_head];
+        hit->pc = cpu_get_pc();
+        hit->address = address;
+        hit->data = data;
+        hit->type = type;
+        hit->watchpoint = id;
+        
+        watch_log_head = (watch_log_head + 1) % MEMORY_WATCH_LOG_SIZE;
+        if (watch_log_count < MEMORY_WATCH_LOG_SIZE) {
+            watch_log_count++;
+        } else {
+            watch_log_dropped++;
+        }
+        
+        if (wp->flags & MEMORY_WATCH_BREAK) {
+            watch_break = 1;
+            cpu_abort_timeslice();
+        }
+    }
+}
+
+int memory_watch_read_log(memory_watch_hit* hits, int max) {
+    int n = 0;
+    
+    while (n < max && watch_log_count > 0) {
+        UINT32 tail = (watch_log_head + MEMORY_WATCH_LOG_SIZE - watch_log_count) % MEMORY_WATCH_LOG_SIZE;
+        hits[n++] = watch_log[tail];
+        watch_log_count--;
+    }
+    
+    return n;
+}
+
+UINT32 memory_watch_get_hits(int id) {
+    if (id < 0 || id >= MAX_MEMORY_WATCHPOINTS) {
+        return 0;
+    }
+    return watchpoints[id].hits;
+}
+
+UINT32 memory_watch_get_dropped(void) {
+    return watch_log_dropped;
+}
+
+int memory_watch_break_pending(void) {
+    int pending = watch_break;
+    watch_break = 0;
+    return pending;
+}
+
+void memory_watch_dump(void) {
+    memory_watch_hit hits[16];
+    int n, i;
+    
+    printf("\nWatchpoint log (%u dropped):\n", watch_log_dropped);
+    
+    while ((n = memory_watch_read_log(hits, 16)) > 0) {
+        for (i = 0; i < n; i++) {
+            printf("  #%d PC=%04X %s $%04X = %02X\n", hits[i].watchpoint, hits[i].pc,
+                   hits[i].type == MEMORY_WATCH_READ ? "R" : "W",
+                   hits[i].address, hits[i].data);
+        }
+    }
 }
@@ -8,6 +8,7 @@
 #define MEMORY_H
 
 #include "osd_gc.h"
+#include "memory_paged.h"
 
 /***************************************************************************
  * Memory Region Types
@@ -20,16 +21,34 @@
 #define REGION_PROMS    0x20  /* Color PROMs */
 #define REGION_SOUND1   0x30  /* Sound region 1 */
 #define REGION_USER1    0x40  /* User region 1 */
+#define REGION_OPCODES  0x50  /* Decrypted opcodes for REGION_CPU1 */
 
 /***************************************************************************
  * Memory Bank Structure
  ***************************************************************************/
 
+#define MAX_MEMORY_BANKS        16
+#define MAX_BANK_ENTRIES        32
+
 typedef struct {
     UINT8* base;          /* Base pointer to memory */
     UINT32 size;          /* Size in bytes */
     UINT32 offset;        /* Offset into region */
     int read_only;        /* 1 = ROM, 0 = RAM */
+    
+    /* Address range the bank occupies (whole pages) */
+    UINT32 start;
+    UINT32 end;
+    const char* name;
+    
+    /* Preconfigured targets for memory_set_bank(), and the decrypted
+     * opcodes of each on boards with encrypted code (NULL = none) */
+    UINT8* entries[MAX_BANK_ENTRIES];
+    UINT8* decrypted[MAX_BANK_ENTRIES];
+    int num_entries;
+    UINT8* decrypted_base;  /* Opcode view of the current target */
+    
+    UINT32 switches;      /* Retargets that changed the mapping */
 } memory_bank_t;
 
 /***************************************************************************
@@ -37,12 +56,57 @@ typedef struct {
  ***************************************************************************/
 
 typedef struct {
-    UINT8* base;          /* Base pointer */
+    UINT8* base;          /* Base pointer (NULL for paged regions) */
     UINT32 size;          /* Size in bytes */
     UINT32 type;          /* Region type */
     const char* name;     /* Region name */
+    paged_region_t* paged; /* ARAM-backed storage, if paged */
+    UINT32 flags;         /* MEMORY_REGION_xxx */
 } memory_region_t;
 
+/* Region flags */
+#define MEMORY_REGION_SWAPPED16  0x01  /* Bytes swapped within 16-bit words */
+
+/***************************************************************************
+ * Write Tracking
+ ***************************************************************************/
+
+#define MAX_MEMORY_TRACKERS     8
+#define MEMORY_TRACK_MAX_BYTES  0x2000  /* Byte granularity is for VRAM-sized areas */
+
+/* Tracking granularity */
+#define MEMORY_TRACK_PAGES      0     /* One dirty bit per 256-byte page */
+#define MEMORY_TRACK_BYTES      1     /* One dirty bit per byte */
+
+/* Called once per coalesced dirty range (inclusive addresses) */
+typedef void (*memory_dirty_callback)(UINT32 start, UINT32 end, void* param);
+
+typedef struct {
+    UINT32 tracked_writes;    /* Writes that went through the tracking path */
+    UINT32 ranges_reported;   /* Dirty ranges handed to consumers */
+} memory_tracking_stats;
+
+/***************************************************************************
+ * Watchpoints
+ ***************************************************************************/
+
+#define MAX_MEMORY_WATCHPOINTS  16
+#define MEMORY_WATCH_LOG_SIZE   256
+
+/* Watchpoint flags */
+#define MEMORY_WATCH_READ       0x01
+#define MEMORY_WATCH_WRITE      0x02
+#define MEMORY_WATCH_BREAK      0x04  /* End the current time slice on a hit */
+
+/* One logged access */
+typedef struct {
+    UINT32 pc;            /* PC of the accessing instruction */
+    UINT32 address;
+    UINT8 data;           /* Value read or written */
+    UINT8 type;           /* MEMORY_WATCH_READ or MEMORY_WATCH_WRITE */
+    UINT8 watchpoint;     /* Watchpoint that fired */
+} memory_watch_hit;
+
 /***************************************************************************
  * Memory System Functions
  ***************************************************************************/
@@ -57,8 +121,49 @@ void memory_region_free(int region);
 UINT8* memory_region_get_base(int region);
 UINT32 memory_region_get_size(int region);
 
-/* Set read/write handlers for address ranges */
+/* Paged regions keep their data in ARAM behind a MEM1 page cache */
+int memory_region_alloc_paged(int region, UINT32 size, UINT32 page_size,
+                              UINT32 cache_pages, const char* name);
+paged_region_t* memory_region_get_paged(int region);
+
+/* Swap bytes within each 16-bit word, once; later ROM loads into the
+ * region are swapped as they are copied in */
+int memory_region_swap16(int region);
+
+/* Banking - a bank spans whole pages and is retargeted with one call.
+ * The CPU's opcode base and any decoded code for the range are
+ * invalidated when the mapping changes. Encrypted banked code gives each
+ * entry its decrypted copy, set after the entries; opcode fetches follow
+ * the entry the bank points at. */
+int  memory_configure_bank(int bank, UINT32 start, UINT32 end, int read_only, const char* name);
+void memory_configure_bank_entries(int bank, UINT8* base, int count, UINT32 stride);
+void memory_configure_bank_decrypted(int bank, UINT8* base, UINT32 stride);
 void memory_set_bankptr(int bank, UINT8* base);
+void memory_set_bank(int bank, int entry);
+const memory_bank_t* memory_get_bank(int bank);
+
+/* Opcode fetch base - the longest run of directly mapped, contiguous
+ * pages around an address. Returns 0 if the address has no direct
+ * mapping; base is address-relative (base[address] is the byte). */
+int memory_get_opbase(UINT32 address, UINT8** base, UINT32* min, UINT32* max);
+
+/* Same for operand fetches, which always see the data mapping */
+int memory_get_argbase(UINT32 address, UINT8** base, UINT32* min, UINT32* max);
+
+/* Encrypted opcodes - opcode fetches in a range read a separate,
+ * already decrypted copy while data reads see the original ROM.
+ * memory_decrypt_opcodes builds that copy once, into its own region,
+ * and maps every page of it from start that no bank covers; the handler
+ * gets each address and ROM byte. Banks take their decrypted copies
+ * through memory_configure_bank_decrypted instead, so a region reaching
+ * into one returns -1 (its fixed pages are still mapped).
+ * memory_set_decrypted_opcodes refuses any range overlapping a bank. */
+typedef UINT8 (*memory_decrypt_handler)(UINT32 address, UINT8 data);
+int memory_decrypt_opcodes(int src_region, int dst_region, UINT32 start,
+                           memory_decrypt_handler decrypt, const char* name);
+int memory_set_decrypted_opcodes(UINT32 start, UINT32 end, UINT8* base);
+
+/* Set read/write handlers for address ranges */
 void memory_install_read_handler(UINT32 start, UINT32 end, UINT8 (*handler)(UINT32));
 void memory_install_write_handler(UINT32 start, UINT32 end, void (*handler)(UINT32, UINT8));
 
@@ -66,6 +171,30 @@ void memory_install_write_handler(UINT32 start, UINT32 end, void (*handler)(UINT
 UINT8 memory_read_byte(UINT32 address);
 void memory_write_byte(UINT32 address, UINT8 data);
 
+/* Reads that ignore watchpoints: opcode fetch (decrypted view), operand
+ * fetch and the debugger (data view) */
+UINT8 memory_read_opcode(UINT32 address);
+UINT8 memory_read_oparg(UINT32 address);
+
+/* Write tracking - consumers subscribe to an address range and later
+ * collect what changed. Untracked pages keep the direct write path. */
+int  memory_track_writes(UINT32 start, UINT32 end, int granularity);
+void memory_untrack_writes(int tracker);
+int  memory_dirty_iterate(int tracker, memory_dirty_callback callback, void* param);
+int  memory_is_dirty(int tracker);
+void memory_dirty_clear(int tracker);
+void memory_mark_dirty(UINT32 address);
+void memory_get_tracking_stats(memory_tracking_stats* stats);
+
+/* Watchpoints - only watched pages leave the direct-pointer fast path */
+int  memory_watch_add(UINT32 start, UINT32 end, int flags);
+void memory_watch_remove(int id);
+void memory_watch_clear_all(void);
+int  memory_watch_read_log(memory_watch_hit* hits, int max);
+UINT32 memory_watch_get_hits(int id);
+UINT32 memory_watch_get_dropped(void);
+int  memory_watch_break_pending(void);
+
 /* ROM loading */
 int memory_load_rom(int region, const UINT8* data, UINT32 size);
 
@@ -75,5 +204,6 @@ void memory_map_ram(UINT32 start_addr, UINT32 end_addr, UINT8* base);
 
 /* Debugging */
 void memory_dump(UINT32 address, UINT32 length);
+void memory_watch_dump(void);
 
 #endif /* MEMORY_H */
@@ -0,0 +1,540 @@
+/***************************************************************************
+ * MAME2003 Paged Memory Regions Implementation
+ ***************************************************************************/
+
+#include "memory_paged.h"
+#include <string.h>
+#include <stdio.h>
+
+/* ARAM-like timing for the host backend: ~10us setup, ~80 bytes/us */
+#define HOST_STORE_LATENCY_US   10
+#define HOST_STORE_BYTES_PER_US 80
+
+#define NO_PAGE 0xFFFFFFFF
+
+/***************************************************************************
+ * Host Backend
+ *
+ * Data lives in an ordinary buffer and is copied immediately; completion
+ * is reported only once the simulated DMA time has passed, so cache
+ * policy and prefetch distance can be evaluated without console hardware.
+ ***************************************************************************/
+
+static void host_schedule(paged_store_t* store, paged_xfer_t* xfer, UINT32 length) {
+    xfer->complete_us = osd_ticks_us() + store->latency_us;
+    if (store->bytes_per_us) {
+        xfer->complete_us += length / store->bytes_per_us;
+    }
+    xfer->pending = 1;
+
+    store->transfers++;
+    store->bytes_moved += length;
+}
+
+static void host_read(paged_store_t* store, paged_xfer_t* xfer,
+                      UINT32 offset, void* dst, UINT32 length) {
+    memcpy(dst, store->buffer + offset, length);
+    host_schedule(store, xfer, length);
+}
+
+static void host_write(paged_store_t* store, paged_xfer_t* xfer,
+                       UINT32 offset, const void* src, UINT32 length) {
+    memcpy(store->buffer + offset, src, length);
+    host_schedule(store, xfer, length);
+}
+
+static void host_wait(paged_store_t* store, paged_xfer_t* xfer) {
+    while (xfer->pending && osd_ticks_us() < xfer->complete_us) {
+        /* Simulated DMA in flight */
+    }
+    xfer->pending = 0;
+}
+
+static void host_destroy(paged_store_t* store) {
+    osd_free(store->buffer);
+}
+
+paged_store_t* paged_store_create_host(UINT32 size, UINT32 latency_us, UINT32 bytes_per_us) {
+    paged_store_t* store = osd_calloc_tagged(1, sizeof(paged_store_t), OSD_MEM_REGION);
+    if (!store) {
+        return NULL;
+    }
+
+    store->buffer = osd_memalign_tagged(PAGED_DMA_ALIGN, size, OSD_MEM_REGION);
+    if (!store->buffer) {
+        osd_free(store);
+        return NULL;
+    }
+    memset(store->buffer, 0, size);
+
+    store->name = "host";
+    store->size = size;
+    store->latency_us = latency_us;
+    store->bytes_per_us = bytes_per_us;
+    store->read = host_read;
+    store->write = host_write;
+    store->wait = host_wait;
+    store->destroy = host_destroy;
+
+    return store;
+}
+
+/***************************************************************************
+ * ARAM Backend
+ *
+ * Transfers go through the ARQ queue; the completion callback receives the
+ * ARQRequest embedded at the start of the ticket. ARAM is a stack
+ * allocator - AR_Free always releases the newest block - so stores must be
+ * destroyed in reverse order of creation. The bases are kept to check
+ * that: a store destroyed out of order keeps its ARAM rather than freeing
+ * another store's.
+ ***************************************************************************/
+
+#ifdef __powerpc__
+
+#define ARAM_MAX_BLOCKS 16
+
+static u32 aram_blocks[ARAM_MAX_BLOCKS];
+static u32 aram_stack[ARAM_MAX_BLOCKS];   /* Store bases, oldest first */
+static int aram_depth = 0;
+
+static void aram_done(ARQRequest* req) {
+    ((paged_xfer_t*)req)->pending = 0;
+}
+
+static void aram_read(paged_store_t* store, paged_xfer_t* xfer,
+                      UINT32 offset, void* dst, UINT32 length) {
+    DCInvalidateRange(dst, length);
+    xfer->pending = 1;
+    store->transfers++;
+    store->bytes_moved += length;
+    ARQ_PostRequestAsync(&xfer->request, (u32)store, ARQ_ARAMTOMRAM, ARQ_PRIO_HI,
+                         store->base + offset, (u32)dst, length, aram_done);
+}
+
+static void aram_write(paged_store_t* store, paged_xfer_t* xfer,
+                       UINT32 offset, const void* src, UINT32 length) {
+    DCFlushRange((void*)src, length);
+    xfer->pending = 1;
+    store->transfers++;
+    store->bytes_moved += length;
+    ARQ_PostRequestAsync(&xfer->request, (u32)store, ARQ_MRAMTOARAM, ARQ_PRIO_LO,
+                         store->base + offset, (u32)src, length, aram_done);
+}
+
+static void aram_wait(paged_store_t* store, paged_xfer_t* xfer) {
+    while (xfer->pending) {
+        /* Completion arrives from the ARQ interrupt */
+    }
+}
+
+static void aram_destroy(paged_store_t* store) {
+    if (aram_depth == 0 || aram_stack[aram_depth - 1] != store->base) {
+        printf("ERROR: ARAM store at $%06X destroyed out of order, not freed\n", store->base);
+        return;
+    }
+
+    AR_Free(NULL);
+    aram_depth--;
+}
+
+paged_store_t* paged_store_create_aram(UINT32 size) {
+    paged_store_t* store;
+    u32 base;
+
+    if (!AR_CheckInit()) {
+        AR_Init(aram_blocks, ARAM_MAX_BLOCKS);
+        ARQ_Init();
+    }
+
+    if (aram_depth == ARAM_MAX_BLOCKS) {
+        printf("ERROR: Too many ARAM stores\n");
+        return NULL;
+    }
+
+    size = (size + PAGED_DMA_ALIGN - 1) & ~(PAGED_DMA_ALIGN - 1);
+    base = AR_Alloc(size);
+    if (!base || base + size > AR_GetSize()) {
+        printf("ERROR: Failed to allocate %u bytes of ARAM\n", size);
+        if (base) {
+            AR_Free(NULL);
+        }
+        return NULL;
+    }
+
+    store = osd_calloc_tagged(1, sizeof(paged_store_t), OSD_MEM_REGION);
+    if (!store) {
+        AR_Free(NULL);
+        return NULL;
+    }
+    aram_stack[aram_depth++] = base;
+
+    store->name = "aram";
+    store->size = size;
+    store->base = base;
+    store->read = aram_read;
+    store->write = aram_write;
+    store->wait = aram_wait;
+    store->destroy = aram_destroy;
+
+    printf("ARAM store: %u bytes at $%06X\n", size, base);
+    return store;
+}
+
+#else
+
+paged_store_t* paged_store_create_aram(UINT32 size) {
+    return NULL;
+}
+
+#endif
+
+paged_store_t* paged_store_create_default(UINT32 size) {
+    paged_store_t* store = paged_store_create_aram(size);
+    if (!store) {
+        store = paged_store_create_host(size, HOST_STORE_LATENCY_US, HOST_STORE_BYTES_PER_US);
+    }
+    return store;
+}
+
+void paged_store_destroy(paged_store_t* store) {
+    if (!store) {
+        return;
+    }
+
+    if (store->destroy) {
+        store->destroy(store);
+    }
+    osd_free(store);
+}
+
+/***************************************************************************
+ * Cache Management
+ ***************************************************************************/
+
+static UINT8* slot_base(paged_region_t* region, int slot) {
+    return region->cache + slot * region->page_size;
+}
+
+static void slot_wait(paged_region_t* region, paged_slot_t* s) {
+    UINT64 start;
+
+    if (!s->xfer.pending) {
+        return;
+    }
+
+    start = osd_ticks_us();
+    region->store->wait(region->store, &s->xfer);
+    region->stats.stall_us += osd_ticks_us() - start;
+}
+
+static void slot_writeback(paged_region_t* region, int slot) {
+    paged_slot_t* s = &region->slots[slot];
+
+    region->store->write(region->store, &s->xfer, s->page << region->page_shift,
+                         slot_base(region, slot), region->page_size);
+    s->dirty = 0;
+    region->stats.writebacks++;
+}
+
+/* Find a slot for a new page, evicting the least recently used one */
+static int slot_alloc(paged_region_t* region) {
+    paged_slot_t* s;
+    int victim = -1;
+    UINT32 oldest = 0;
+    UINT32 i;
+
+    for (i = 0; i < region->num_slots; i++) {
+        s = &region->slots[i];
+
+        if (s->state == PAGED_SLOT_FREE) {
+            return i;
+        }
+
+        /* Keep the page the fast path points at */
+        if (s->page == region->last_page) {
+            continue;
+        }
+
+        if (victim < 0 || (UINT32)(region->clock - s->last_use) > oldest) {
+            victim = i;
+            oldest = region->clock - s->last_use;
+        }
+    }
+
+    if (victim < 0) {
+        victim = 0;
+    }
+
+    s = &region->slots[victim];
+    slot_wait(region, s);
+
+    if (s->dirty) {
+        slot_writeback(region, victim);
+        slot_wait(region, s);
+    }
+
+    region->page_slot[s->page] = -1;
+    if (s->page == region->last_page) {
+        region->last_page = NO_PAGE;
+    }
+
+    s->state = PAGED_SLOT_FREE;
+    region->stats.evictions++;
+    return victim;
+}
+
+static int slot_fill(paged_region_t* region, UINT32 page, int prefetch) {
+    int slot = slot_alloc(region);
+    paged_slot_t* s = &region->slots[slot];
+
+    s->page = page;
+    s->state = PAGED_SLOT_LOADING;
+    s->dirty = 0;
+    s->prefetched = prefetch;
+    s->last_use = ++region->clock;
+    region->page_slot[page] = slot;
+
+    region->store->read(region->store, &s->xfer, page << region->page_shift,
+                        slot_base(region, slot), region->page_size);
+    return slot;
+}
+
+/***************************************************************************
+ * Region Creation
+ ***************************************************************************/
+
+paged_region_t* paged_region_create(paged_store_t* store, UINT32 size,
+                                    UINT32 page_size, UINT32 cache_pages,
+                                    const char* name) {
+    paged_region_t* region;
+    UINT32 i;
+
+    if (!store || page_size < PAGED_DMA_ALIGN || (page_size & (page_size - 1))) {
+        printf("ERROR: Bad paged region setup for %s\n", name);
+        paged_store_destroy(store);
+        return NULL;
+    }
+
+    region = osd_calloc_tagged(1, sizeof(paged_region_t), OSD_MEM_REGION);
+    if (!region) {
+        paged_store_destroy(store);
+        return NULL;
+    }
+
+    region->name = name;
+    region->store = store;
+    region->size = size;
+    region->page_size = page_size;
+    while ((1u << region->page_shift) < page_size) {
+        region->page_shift++;
+    }
+    region->num_pages = (size + page_size - 1) >> region->page_shift;
+    region->num_slots = MIN(cache_pages, region->num_pages);
+    if (region->num_slots == 0) {
+        region->num_slots = 1;
+    }
+    region->last_page = NO_PAGE;
+
+    if (store->size < region->num_pages * page_size) {
+        printf("ERROR: Store too small for %s (%u < %u)\n",
+               name, store->size, region->num_pages * page_size);
+        paged_region_destroy(region);
+        return NULL;
+    }
+
+    region->cache = osd_memalign_tagged(PAGED_DMA_ALIGN, region->num_slots * page_size, OSD_MEM_REGION);
+    region->slots = osd_calloc_tagged(region->num_slots, sizeof(paged_slot_t), OSD_MEM_REGION);
+    region->page_slot = osd_malloc_tagged(region->num_pages * sizeof(INT16), OSD_MEM_REGION);
+    if (!region->cache || !region->slots || !region->page_slot) {
+        printf("ERROR: Failed to allocate cache for %s\n", name);
+        paged_region_destroy(region);
+        return NULL;
+    }
+
+    for (i = 0; i < region->num_pages; i++) {
+        region->page_slot[i] = -1;
+    }
+
+    printf("Paged region %s: %u bytes in %s, %u x %u byte cache\n",
+           name, size, store->name, region->num_slots, page_size);
+    return region;
+}
+
+void paged_region_destroy(paged_region_t* region) {
+    UINT32 i;
+
+    if (!region) {
+        return;
+    }
+
+    if (region->slots) {
+        for (i = 0; i < region->num_slots; i++) {
+            slot_wait(region, &region->slots[i]);
+        }
+    }
+
+    osd_free(region->cache);
+    osd_free(region->slots);
+    osd_free(region->page_slot);
+    paged_store_destroy(region->store);
+    osd_free(region);
+}
+
+/***************************************************************************
+ * Access
+ ***************************************************************************/
+
+UINT8* paged_region_lookup(paged_region_t* region, UINT32 offset, int write) {
+    UINT32 page;
+    int slot;
+    paged_slot_t* s;
+
+    if (offset >= region->size) {
+        logerror("Paged region %s: offset %08X out of range\n", region->name, offset);
+        offset %= region->size;
+    }
+
+    page = offset >> region->page_shift;
+    slot = region->page_slot[page];
+
+    if (slot >= 0) {
+        region->stats.hits++;
+    } else {
+        region->stats.misses++;
+        slot = slot_fill(region, page, 0);
+    }
+
+    s = &region->slots[slot];
+    if (s->state == PAGED_SLOT_LOADING) {
+        slot_wait(region, s);
+        s->state = PAGED_SLOT_READY;
+    }
+
+    if (s->prefetched) {
+        region->stats.prefetch_hits++;
+        s->prefetched = 0;
+    }
+
+    s->last_use = ++region->clock;
+    if (write) {
+        s->dirty = 1;
+    }
+
+    region->last_page = page;
+    region->last_base = slot_base(region, slot);
+    return region->last_base + (offset & (region->page_size - 1));
+}
+
+void paged_region_read(paged_region_t* region, UINT32 offset, UINT8* dst, UINT32 length) {
+    while (length > 0) {
+        UINT32 in_page = region->page_size - (offset & (region->page_size - 1));
+        UINT32 chunk = MIN(length, in_page);
+
+        memcpy(dst, paged_region_lookup(region, offset, 0), chunk);
+        offset += chunk;
+        dst += chunk;
+        length -= chunk;
+    }
+}
+
+void paged_region_prefetch(paged_region_t* region, UINT32 offset, UINT32 length) {
+    UINT32 first, last, page;
+    UINT32 started = 0;
+
+    if (length == 0 || offset >= region->size) {
+        return;
+    }
+
+    first = offset >> region->page_shift;
+    last = (MIN(offset + length, region->size) - 1) >> region->page_shift;
+
+    /* Never let a hint evict more than half the cache */
+    for (page = first; page <= last && started < region->num_slots / 2 + 1; page++) {
+        if (region->page_slot[page] >= 0) {
+            continue;
+        }
+        slot_fill(region, page, 1);
+        region->stats.prefetches++;
+        started++;
+    }
+}
+
+void paged_region_flush(paged_region_t* region) {
+    UINT32 i;
+
+    for (i = 0; i < region->num_slots; i++) {
+        paged_slot_t* s = &region->slots[i];
+        if (s->state == PAGED_SLOT_READY && s->dirty) {
+            slot_writeback(region, i);
+        }
+    }
+
+    for (i = 0; i < region->num_slots; i++) {
+        slot_wait(region, &region->slots[i]);
+    }
+}
+
+/***************************************************************************
+ * Loading
+ ***************************************************************************/
+
+int paged_region_load(paged_region_t* region, UINT32 offset, const UINT8* data, UINT32 length) {
+    paged_xfer_t xfer;
+    UINT8* bounce;
+
+    if (offset + length > region->size) {
+        printf("ERROR: Data too large for paged region %s\n", region->name);
+        return -1;
+    }
+
+    /* DMA needs an aligned MEM1 source, so stage one page at a time */
+    bounce = osd_memalign_tagged(PAGED_DMA_ALIGN, region->page_size, OSD_MEM_REGION);
+    if (!bounce) {
+        return -1;
+    }
+    memset(&xfer, 0, sizeof(xfer));
+
+    while (length > 0) {
+        UINT32 page = offset >> region->page_shift;
+        UINT32 start = offset & (region->page_size - 1);
+        UINT32 chunk = MIN(length, region->page_size - start);
+        UINT32 page_offset = page << region->page_shift;
+        int slot = region->page_slot[page];
+
+        if (chunk < region->page_size) {
+            region->store->read(region->store, &xfer, page_offset, bounce, region->page_size);
+            region->store->wait(region->store, &xfer);
+        }
+        memcpy(bounce + start, data, chunk);
+
+        region->store->write(region->store, &xfer, page_offset, bounce, region->page_size);
+        region->store->wait(region->store, &xfer);
+
+        /* Keep a resident copy coherent */
+        if (slot >= 0) {
+            slot_wait(region, &region->slots[slot]);
+            region->slots[slot].state = PAGED_SLOT_READY;
+            memcpy(slot_base(region, slot) + start, data, chunk);
+        }
+
+        offset += chunk;
+        data += chunk;
+        length -= chunk;
+    }
+
+    osd_free(bounce);
+    return 0;
+}
+
+/***************************************************************************
+ * Statistics
+ ***************************************************************************/
+
+void paged_region_get_stats(const paged_region_t* region, paged_stats_t* stats) {
+    *stats = region->stats;
+}
+
+void paged_region_reset_stats(paged_region_t* region) {
+    memset(&region->stats, 0, sizeof(region->stats));
+}
@@ -0,0 +1,167 @@
+/***************************************************************************
+ * MAME2003 Paged Memory Regions for GameCube
+ *
+ * Stores cold data (large GFX/sound ROMs, rewind buffers, secondary banks)
+ * in a backing store - ARAM on the GameCube - and pages it on demand into
+ * a fixed-size MEM1 cache with LRU eviction. Drivers can hint upcoming
+ * accesses so pages are already resident when they are needed.
+ ***************************************************************************/
+
+#ifndef MEMORY_PAGED_H
+#define MEMORY_PAGED_H
+
+#include "osd_gc.h"
+
+/***************************************************************************
+ * Backing Store
+ *
+ * A backing store moves data between its own storage and MEM1. Transfers
+ * are started asynchronously and polled or waited on, so the ARAM backend
+ * can use DMA and the host backend can simulate the DMA latency.
+ ***************************************************************************/
+
+/* Transfer addresses and lengths must be multiples of this (ARAM DMA) */
+#define PAGED_DMA_ALIGN     32
+
+typedef struct paged_store paged_store_t;
+
+/* Transfer ticket, owned by the caller until the transfer completes */
+typedef struct {
+#ifdef __powerpc__
+    ARQRequest request;       /* Must be first: the ARQ callback receives it */
+#endif
+    volatile int pending;     /* Non-zero while the transfer is in flight */
+    UINT64 complete_us;       /* Host backend: simulated completion time */
+} paged_xfer_t;
+
+struct paged_store {
+    const char* name;
+    UINT32 size;
+
+    /* Start a transfer; xfer->pending is cleared on completion */
+    void (*read)(paged_store_t* store, paged_xfer_t* xfer,
+                 UINT32 offset, void* dst, UINT32 length);
+    void (*write)(paged_store_t* store, paged_xfer_t* xfer,
+                  UINT32 offset, const void* src, UINT32 length);
+
+    /* Block until the transfer has completed */
+    void (*wait)(paged_store_t* store, paged_xfer_t* xfer);
+
+    void (*destroy)(paged_store_t* store);
+
+    /* Backend data */
+    UINT8* buffer;            /* Host backend storage */
+    UINT32 base;              /* ARAM backend start address */
+    UINT32 latency_us;        /* Host backend: per-transfer setup time */
+    UINT32 bytes_per_us;      /* Host backend: simulated bandwidth */
+
+    /* Statistics */
+    UINT32 transfers;
+    UINT64 bytes_moved;
+};
+
+/* ARAM through the ARQ DMA queue (GameCube only) */
+paged_store_t* paged_store_create_aram(UINT32 size);
+
+/* Plain MEM1 buffer with simulated DMA latency (host builds, benchmarks) */
+paged_store_t* paged_store_create_host(UINT32 size, UINT32 latency_us, UINT32 bytes_per_us);
+
+/* ARAM where available, otherwise a host buffer with ARAM-like timing */
+paged_store_t* paged_store_create_default(UINT32 size);
+
+/* ARAM stores are freed newest first; destroy them (and their regions)
+ * in reverse order of creation */
+void paged_store_destroy(paged_store_t* store);
+
+/***************************************************************************
+ * Paged Region
+ ***************************************************************************/
+
+/* Cache slot state */
+#define PAGED_SLOT_FREE      0
+#define PAGED_SLOT_LOADING   1
+#define PAGED_SLOT_READY     2
+
+typedef struct {
+    paged_xfer_t xfer;        /* Outstanding fill or writeback */
+    UINT32 page;              /* Page held by this slot */
+    UINT32 last_use;          /* LRU stamp */
+    UINT8 state;              /* PAGED_SLOT_xxx */
+    UINT8 dirty;              /* Page written since it was loaded */
+    UINT8 prefetched;         /* Loaded by a hint, not yet touched */
+} paged_slot_t;
+
+typedef struct {
+    UINT32 hits;              /* Accesses served from the cache */
+    UINT32 misses;            /* Accesses that had to wait for a fill */
+    UINT32 evictions;         /* Pages dropped to make room */
+    UINT32 writebacks;        /* Dirty pages written to the store */
+    UINT32 prefetches;        /* Fills started by hints */
+    UINT32 prefetch_hits;     /* Prefetched pages that were later used */
+    UINT64 stall_us;          /* Time spent waiting on the store */
+} paged_stats_t;
+
+typedef struct paged_region {
+    const char* name;
+    paged_store_t* store;
+
+    UINT32 size;              /* Region size in bytes */
+    UINT32 page_size;         /* Bytes per page (power of two) */
+    UINT32 page_shift;
+    UINT32 num_pages;
+
+    /* MEM1 cache */
+    UINT8* cache;             /* num_slots * page_size bytes, 32-byte aligned */
+    paged_slot_t* slots;
+    UINT32 num_slots;
+    INT16* page_slot;         /* Page -> slot, -1 when not resident */
+    UINT32 clock;             /* LRU clock */
+
+    /* Most recently used page, checked before the page table */
+    UINT32 last_page;
+    UINT8* last_base;
+
+    paged_stats_t stats;
+} paged_region_t;
+
+/* Creation - the region takes ownership of the store */
+paged_region_t* paged_region_create(paged_store_t* store, UINT32 size,
+                                    UINT32 page_size, UINT32 cache_pages,
+                                    const char* name);
+void paged_region_destroy(paged_region_t* region);
+
+/* Fill the backing store (e.g. ROM loading); bypasses the cache */
+int paged_region_load(paged_region_t* region, UINT32 offset, const UINT8* data, UINT32 length);
+
+/* Resolve an offset to a pointer into the cached page.
+ * The pointer covers the rest of that page only, and stays valid until the
+ * next call that can evict (page lookup, prefetch or bulk read). */
+UINT8* paged_region_lookup(paged_region_t* region, UINT32 offset, int write);
+
+/* Copy a range out of the region */
+void paged_region_read(paged_region_t* region, UINT32 offset, UINT8* dst, UINT32 length);
+
+/* Driver hint: these bytes will be needed soon */
+void paged_region_prefetch(paged_region_t* region, UINT32 offset, UINT32 length);
+
+/* Write all dirty pages back to the store */
+void paged_region_flush(paged_region_t* region);
+
+/* Statistics */
+void paged_region_get_stats(const paged_region_t* region, paged_stats_t* stats);
+void paged_region_reset_stats(paged_region_t* region);
+
+/* Byte access with a fast path for the most recently used page */
+static INLINE UINT8 paged_region_read_byte(paged_region_t* region, UINT32 offset) {
+    if ((offset >> region->page_shift) == region->last_page) {
+        region->stats.hits++;
+        return region->last_base[offset & (region->page_size - 1)];
+    }
+    return *paged_region_lookup(region, offset, 0);
+}
+
+static INLINE void paged_region_write_byte(paged_region_t* region, UINT32 offset, UINT8 data) {
+    *paged_region_lookup(region, offset, 1) = data;
+}
+
+#endif /* MEMORY_PAGED_H */
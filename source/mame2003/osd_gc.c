@@ -3,53 +3,200 @@
  ***************************************************************************/
 
 #include "osd_gc.h"
-#include <gccore.h>
-#include <fat.h>
 #include <malloc.h>
 #include <unistd.h>
+
+#ifdef __powerpc__
+#include <gccore.h>
+#include <fat.h>
 #include <ogc/lwp_watchdog.h>
+#else
+#include <time.h>
+#endif
+
+/* glibc 2.33 deprecated mallinfo, whose int fields wrap past 2GB */
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 33))
+#define OSD_MALLINFO    struct mallinfo2
+#define osd_mallinfo    mallinfo2
+#else
+#define OSD_MALLINFO    struct mallinfo
+#define osd_mallinfo    mallinfo
+#endif
 
 /***************************************************************************
  * Memory Management
  ***************************************************************************/
 
-static size_t total_allocated = 0;
-static size_t peak_allocated = 0;
-
-void* osd_malloc(size_t size) {
-    void* ptr = malloc(size);
-    if (ptr) {
-        total_allocated += size;
-        if (total_allocated > peak_allocated) {
-            peak_allocated = total_allocated;
-        }
+/*
+ * Every allocation carries a small header in front of the returned pointer
+ * recording its size and owning subsystem, so osd_free() can give the bytes
+ * back to the right counters. The header is 16 bytes, which keeps malloc's
+ * natural alignment; aligned allocations place it just below the aligned
+ * address and remember how far back the real block starts.
+ */
+
+#define OSD_MEM_MAGIC 0x4D454D31  /* 'MEM1' */
+
+typedef struct {
+    UINT32 size;          /* Payload size in bytes */
+    UINT16 tag;           /* OSD_MEM_xxx owner */
+    UINT16 offset;        /* Distance from the raw block to the payload */
+    UINT32 magic;         /* OSD_MEM_MAGIC while live */
+    UINT32 reserved;
+} osd_mem_header;
+
+static osd_mem_stats mem_stats;
+
+static const char* const mem_tag_names[OSD_MEM_TAG_COUNT] = {
+    "Other", "CPU", "Regions", "Video", "Audio", "State"
+};
+
+static void* mem_track(void* raw, size_t size, size_t offset, int tag) {
+    UINT8* ptr;
+    osd_mem_header* header;
+    osd_mem_tag_stats* t;
+    
+    if (!raw) {
+        return NULL;
     }
+    
+    if (tag < 0 || tag >= OSD_MEM_TAG_COUNT) {
+        tag = OSD_MEM_OTHER;
+    }
+    
+    ptr = (UINT8*)raw + offset;
+    header = (osd_mem_header*)ptr - 1;
+    header->size = (UINT32)size;
+    header->tag = (UINT16)tag;
+    header->offset = (UINT16)offset;
+    header->magic = OSD_MEM_MAGIC;
+    
+    mem_stats.live += size;
+    mem_stats.overhead += offset;
+    mem_stats.live_allocs++;
+    mem_stats.total_allocs++;
+    if (mem_stats.live > mem_stats.peak) {
+        mem_stats.peak = mem_stats.live;
+    }
+    
+    t = &mem_stats.tags[tag];
+    t->live += size;
+    t->allocs++;
+    if (t->live > t->peak) {
+        t->peak = t->live;
+    }
+    
     return ptr;
 }
 
-void* osd_calloc(size_t count, size_t size) {
-    void* ptr = calloc(count, size);
+void* osd_malloc_tagged(size_t size, int tag) {
+    return mem_track(malloc(size + sizeof(osd_mem_header)), size,
+                     sizeof(osd_mem_header), tag);
+}
+
+void* osd_calloc_tagged(size_t count, size_t size, int tag) {
+    void* ptr;
+    
+    if (size && count > (size_t)-1 / size) {
+        return NULL;
+    }
+    
+    ptr = osd_malloc_tagged(count * size, tag);
     if (ptr) {
-        total_allocated += (count * size);
-        if (total_allocated > peak_allocated) {
-            peak_allocated = total_allocated;
-        }
+        memset(ptr, 0, count * size);
     }
     return ptr;
 }
 
+void* osd_memalign_tagged(size_t alignment, size_t size, int tag) {
+    /* Alignment must cover the header so the payload stays aligned */
+    if (alignment < sizeof(osd_mem_header)) {
+        alignment = sizeof(osd_mem_header);
+    }
+    
+    return mem_track(memalign(alignment, size + alignment), size, alignment, tag);
+}
+
+void* osd_malloc(size_t size) {
+    return osd_malloc_tagged(size, OSD_MEM_OTHER);
+}
+
+void* osd_calloc(size_t count, size_t size) {
+    return osd_calloc_tagged(count, size, OSD_MEM_OTHER);
+}
+
 void osd_free(void* ptr) {
-    if (ptr) {
-        free(ptr);
+    osd_mem_header* header;
+    osd_mem_tag_stats* t;
+    
+    if (!ptr) {
+        return;
     }
+    
+    header = (osd_mem_header*)ptr - 1;
+    if (header->magic != OSD_MEM_MAGIC) {
+        printf("ERROR: osd_free on untracked pointer %p\n", ptr);
+        return;
+    }
+    
+    t = &mem_stats.tags[header->tag];
+    t->live -= header->size;
+    t->allocs--;
+    
+    mem_stats.live -= header->size;
+    mem_stats.overhead -= header->offset;
+    mem_stats.live_allocs--;
+    
+    header->magic = 0;
+    free((UINT8*)ptr - header->offset);
 }
 
 size_t osd_get_memory_usage(void) {
-    return total_allocated;
+    return mem_stats.live;
 }
 
 size_t osd_get_peak_memory_usage(void) {
-    return peak_allocated;
+    return mem_stats.peak;
+}
+
+void osd_get_memory_stats(osd_mem_stats* stats) {
+    OSD_MALLINFO mi = osd_mallinfo();
+    size_t unclaimed;
+    size_t top;
+    
+    *stats = mem_stats;
+    
+    /*
+     * newlib does not expose its free lists, so the largest block is
+     * estimated as the releasable top chunk plus the part of the MEM1
+     * arena the heap has not claimed yet. Free chunks below the top are
+     * counted as fragmented. A host heap has no arena of its own.
+     */
+#ifdef __powerpc__
+    unclaimed = (size_t)((UINT8*)SYS_GetArena1Hi() - (UINT8*)SYS_GetArena1Lo());
+#else
+    unclaimed = 0;
+#endif
+    top = (size_t)mi.keepcost;
+    
+    stats->heap_free = (size_t)mi.fordblks + unclaimed;
+    stats->largest_free = top + unclaimed;
+    if (stats->largest_free > stats->heap_free) {
+        stats->largest_free = stats->heap_free;
+    }
+    
+    stats->fragmentation = 0;
+    if (stats->heap_free) {
+        stats->fragmentation = (UINT32)(100 -
+            (UINT64)stats->largest_free * 100 / stats->heap_free);
+    }
+}
+
+const char* osd_get_memory_tag_name(int tag) {
+    if (tag < 0 || tag >= OSD_MEM_TAG_COUNT) {
+        return "?";
+    }
+    return mem_tag_names[tag];
 }
 
 /***************************************************************************
@@ -58,12 +205,35 @@ size_t osd_get_peak_memory_usage(void) {
 
 static uint64_t start_ticks = 0;
 
+#ifdef __powerpc__
 UINT32 osd_ticks(void) {
     uint64_t now = gettime();
     uint64_t diff_ticks = diff_ticks(start_ticks, now);
     return (UINT32)ticks_to_millisecs(diff_ticks);
 }
 
+UINT64 osd_ticks_us(void) {
+    uint64_t now = gettime();
+    return (UINT64)ticks_to_microsecs(diff_ticks(start_ticks, now));
+}
+#else
+/* Host: microseconds of the monotonic clock */
+static uint64_t host_clock_us(void) {
+    struct timespec ts;
+    
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+UINT32 osd_ticks(void) {
+    return (UINT32)(osd_ticks_us() / 1000);
+}
+
+UINT64 osd_ticks_us(void) {
+    return (UINT64)(host_clock_us() - start_ticks);
+}
+#endif
+
 UINT32 osd_ticks_per_second(void) {
     return 1000; /* milliseconds */
 }
@@ -74,35 +244,36 @@ void osd_sleep(int milliseconds) {
     }
 }
 
+void osd_sleep_us(UINT32 microseconds) {
+    if (microseconds > 0) {
+        usleep((useconds_t)microseconds);
+    }
+}
+
 /***************************************************************************
  * Video (Stub for now)
+ *
+ * The video system renders into indexed bitmaps of its own and presents
+ * them into the external framebuffer, so the display only records the
+ * mode.
  ***************************************************************************/
 
-static void* video_buffer = NULL;
 static int video_width = 0;
 static int video_height = 0;
 
 int osd_create_display(int width, int height, int depth) {
-    video_width = width;
-    video_height = height;
-    
-    /* Allocate framebuffer */
-    size_t buffer_size = width * height * 4; /* RGBA32 */
-    video_buffer = memalign(32, buffer_size);
-    
-    if (!video_buffer) {
+    if (width <= 0 || height <= 0) {
         return -1;
     }
     
-    memset(video_buffer, 0, buffer_size);
+    video_width = width;
+    video_height = height;
     return 0;
 }
 
 void osd_close_display(void) {
-    if (video_buffer) {
-        free(video_buffer);
-        video_buffer = NULL;
-    }
+    video_width = 0;
+    video_height = 0;
 }
 
 void osd_update_video(void) {
@@ -116,8 +287,10 @@ void osd_update_video(void) {
 static u16 pad_buttons = 0;
 
 void osd_poll_inputs(void) {
+#ifdef __powerpc__
     PAD_ScanPads();
     pad_buttons = PAD_ButtonsHeld(0);
+#endif
 }
 
 int osd_key_pressed(int keycode) {
@@ -163,6 +336,7 @@ void osd_fclose(osd_file file) {
  ***************************************************************************/
 
 int osd_init(void) {
+#ifdef __powerpc__
     /* Initialize timing */
     start_ticks = gettime();
     
@@ -171,11 +345,16 @@ int osd_init(void) {
         printf("Warning: FAT initialization failed\n");
         /* Not fatal - ROMs can be embedded */
     }
+#else
+    start_ticks = host_clock_us();
+#endif
     
     return 0;
 }
 
 void osd_exit(void) {
     osd_close_display();
+#ifdef __powerpc__
     fatUnmount("sd:");
+#endif
 }
@@ -2,6 +2,10 @@
  * GameCube OSD (Operating System Dependent) Layer
  * 
  * This file provides GameCube-specific definitions and interfaces for MAME2003
+ *
+ * libogc is only used on the console (__powerpc__). Host builds, which run
+ * the core and video modules under test, get the libogc integer types
+ * here and a portable implementation of the OSD functions.
  ***************************************************************************/
 
 #ifndef OSD_GC_H
@@ -12,7 +16,29 @@
 #include <string.h>
 #include <stdio.h>
 #include <stdlib.h>
+
+#ifdef __powerpc__
 #include <gccore.h>
+#else
+typedef uint8_t   u8;
+typedef uint16_t  u16;
+typedef uint32_t  u32;
+typedef uint64_t  u64;
+typedef int8_t    s8;
+typedef int16_t   s16;
+typedef int32_t   s32;
+typedef int64_t   s64;
+typedef volatile u8  vu8;
+typedef volatile u16 vu16;
+typedef volatile u32 vu32;
+typedef volatile u64 vu64;
+typedef volatile s8  vs8;
+typedef volatile s16 vs16;
+typedef volatile s32 vs32;
+typedef volatile s64 vs64;
+typedef float     f32;
+typedef double    f64;
+#endif
 
 /***************************************************************************
  * Platform Definitions
@@ -31,8 +57,8 @@
 #define INLINE __inline__
 #endif
 
-/* GameCube is big-endian (PowerPC) */
-#ifndef MSB_FIRST
+/* GameCube is big-endian (PowerPC); host builds keep their own order */
+#if !defined(MSB_FIRST) && defined(__powerpc__)
 #define MSB_FIRST 1
 #endif
 
@@ -79,11 +105,55 @@ typedef void* osd_file;
 #define GC_MEM1_SIZE  (24 * 1024 * 1024)  /* 24MB main RAM */
 #define GC_ARAM_SIZE  (16 * 1024 * 1024)  /* 16MB audio RAM */
 
-/* Memory allocation wrappers */
+/* Subsystem tags used for memory accounting */
+enum {
+    OSD_MEM_OTHER = 0,    /* Untagged allocations */
+    OSD_MEM_CPU,          /* CPU cores and their lookup tables */
+    OSD_MEM_REGION,       /* ROM/RAM memory regions */
+    OSD_MEM_VIDEO,        /* Framebuffers, bitmaps, tile caches */
+    OSD_MEM_AUDIO,        /* Sound buffers */
+    OSD_MEM_STATE,        /* Save state and rewind buffers */
+    OSD_MEM_TAG_COUNT
+};
+
+/* Per-subsystem usage */
+typedef struct {
+    size_t live;          /* Bytes currently allocated */
+    size_t peak;          /* High-water mark of live bytes */
+    UINT32 allocs;        /* Live allocation count */
+} osd_mem_tag_stats;
+
+/* Snapshot of the allocator state */
+typedef struct {
+    size_t live;          /* Bytes currently allocated (payload only) */
+    size_t peak;          /* High-water mark of live bytes */
+    size_t overhead;      /* Bytes spent on headers and alignment */
+    UINT32 live_allocs;   /* Allocations not yet freed */
+    UINT32 total_allocs;  /* Allocations since startup */
+
+    size_t heap_free;     /* Free bytes in the heap plus unclaimed arena */
+    size_t largest_free;  /* Largest block that can be allocated (estimate) */
+    UINT32 fragmentation; /* 0-100, share of free memory outside largest block */
+
+    osd_mem_tag_stats tags[OSD_MEM_TAG_COUNT];
+} osd_mem_stats;
+
+/* Memory allocation wrappers (untagged allocations count as OSD_MEM_OTHER) */
 void* osd_malloc(size_t size);
 void* osd_calloc(size_t count, size_t size);
 void  osd_free(void* ptr);
 
+/* Tagged allocation - every byte is accounted to a subsystem */
+void* osd_malloc_tagged(size_t size, int tag);
+void* osd_calloc_tagged(size_t count, size_t size, int tag);
+void* osd_memalign_tagged(size_t alignment, size_t size, int tag);
+
+/* Accounting queries */
+size_t osd_get_memory_usage(void);
+size_t osd_get_peak_memory_usage(void);
+void   osd_get_memory_stats(osd_mem_stats* stats);
+const char* osd_get_memory_tag_name(int tag);
+
 /***************************************************************************
  * Timing
  ***************************************************************************/
@@ -95,6 +165,9 @@ void  osd_free(void* ptr);
 UINT32 osd_ticks(void);
 UINT32 osd_ticks_per_second(void);
 
+/* Get ticks (microseconds) - for profiling and latency measurement */
+UINT64 osd_ticks_us(void);
+
 /***************************************************************************
  * Video
  ***************************************************************************/
@@ -176,6 +249,7 @@ INLINE UINT32 BYTE_SWAP32(UINT32 x) {
            ((x << 24) & 0xff000000);
 }
 
+#ifdef MSB_FIRST
 /* Read little-endian values (ROM data) */
 #define READ_LE16(ptr) BYTE_SWAP16(*(UINT16*)(ptr))
 #define READ_LE32(ptr) BYTE_SWAP32(*(UINT32*)(ptr))
@@ -183,6 +257,12 @@ INLINE UINT32 BYTE_SWAP32(UINT32 x) {
 /* Read big-endian values (native) */
 #define READ_BE16(ptr) (*(UINT16*)(ptr))
 #define READ_BE32(ptr) (*(UINT32*)(ptr))
+#else
+#define READ_LE16(ptr) (*(UINT16*)(ptr))
+#define READ_LE32(ptr) (*(UINT32*)(ptr))
+#define READ_BE16(ptr) BYTE_SWAP16(*(UINT16*)(ptr))
+#define READ_BE32(ptr) BYTE_SWAP32(*(UINT32*)(ptr))
+#endif
 
 /***************************************************************************
  * Function Declarations
@@ -211,5 +291,6 @@ void osd_fclose(osd_file file);
 
 /* Timing */
 void osd_sleep(int milliseconds);
+void osd_sleep_us(UINT32 microseconds);
 
 #endif /* OSD_GC_H */
@@ -22,6 +22,7 @@ static void init_default_config(mame2003_config_t* config) {
     config->screen_width = 640;
     config->screen_height = 480;
     config->refresh_rate = 60;
+    config->orientation = 0;  /* ROT0 */
     
     config->audio_enabled = 0; /* Disabled for now */
     config->audio_sample_rate = 48000;
@@ -54,6 +55,8 @@ int mame2003_init(mame2003_context_t* ctx) {
     
     /* Set default configuration */
     init_default_config(&ctx->config);
+    frameskip_init(&ctx->frameskip, ctx->config.frameskip, ctx->config.auto_frameskip,
+                   ctx->config.refresh_rate);
     
     /* Initialize video */
     if (osd_create_display(ctx->config.screen_width, 
@@ -65,6 +68,8 @@ int mame2003_init(mame2003_context_t* ctx) {
     }
     
     ctx->state = MAME_STATE_INIT;
+    ctx->memory_used = osd_get_memory_usage();
+    ctx->memory_peak = osd_get_peak_memory_usage();
     
     printf("MAME2003 GameCube initialized\n");
     printf("Version: %s\n", mame2003_get_version());
@@ -154,6 +159,9 @@ void mame2003_resume(mame2003_context_t* ctx) {
 }
 
 int mame2003_run_frame(mame2003_context_t* ctx) {
+    UINT64 start, emulated;
+    int draw;
+    
     if (!ctx) {
         return -1;
     }
@@ -162,22 +170,45 @@ int mame2003_run_frame(mame2003_context_t* ctx) {
         return 0;
     }
     
+    draw = mame2003_begin_frame(ctx);
+    start = osd_ticks_us();
+    
     /* TODO: Run one frame of emulation */
     /* This will involve:
      * 1. Execute CPU for one frame
-     * 2. Update video
-     * 3. Update audio
-     * 4. Handle inputs
+     * 2. Update audio
+     * 3. Handle inputs
      */
     
-    ctx->frames_rendered++;
+    emulated = osd_ticks_us();
     
-    /* Update video */
-    osd_update_video();
+    /* Track memory usage */
+    ctx->memory_used = osd_get_memory_usage();
+    ctx->memory_peak = osd_get_peak_memory_usage();
+    
+    /* Update video, unless this frame is skipped */
+    if (draw) {
+        osd_update_video();
+    }
     
+    mame2003_end_frame(ctx, (u32)(emulated - start), (u32)(osd_ticks_us() - emulated));
     return 0;
 }
 
+int mame2003_begin_frame(mame2003_context_t* ctx) {
+    return frameskip_begin_frame(&ctx->frameskip);
+}
+
+void mame2003_end_frame(mame2003_context_t* ctx, u32 emulate_us, u32 render_us) {
+    if (ctx->frameskip.drawing) {
+        ctx->frames_rendered++;
+    } else {
+        ctx->frames_skipped++;
+    }
+    
+    frameskip_end_frame(&ctx->frameskip, emulate_us, render_us);
+}
+
 /***************************************************************************
  * Configuration
  ***************************************************************************/
@@ -188,6 +219,8 @@ void mame2003_set_config(mame2003_context_t* ctx, const mame2003_config_t* confi
     }
     
     memcpy(&ctx->config, config, sizeof(mame2003_config_t));
+    frameskip_init(&ctx->frameskip, config->frameskip, config->auto_frameskip,
+                   config->refresh_rate);
 }
 
 void mame2003_get_config(const mame2003_context_t* ctx, mame2003_config_t* config) {
@@ -231,19 +264,49 @@ int mame2003_load_state(mame2003_context_t* ctx, const char* path) {
  ***************************************************************************/
 
 void mame2003_get_stats(const mame2003_context_t* ctx, char* buffer, size_t size) {
+    osd_mem_stats mem;
+    int len;
+    int i;
+    
     if (!ctx || !buffer || size == 0) {
         return;
     }
     
-    snprintf(buffer, size,
+    /* Memory figures are read live so the report is never stale */
+    osd_get_memory_stats(&mem);
+    
+    len = snprintf(buffer, size,
         "Frames: %d\n"
-        "Skipped: %d\n"
+        "Skipped: %d (frameskip %d%s)\n"
         "FPS: %d\n"
-        "Memory: %zu KB / %zu KB peak\n",
+        "Tiles drawn: %d\n"
+        "Memory: %zu KB / %zu KB peak (%u allocs, %zu B overhead)\n"
+        "Heap: %zu KB free, %zu KB largest, %u%% fragmented\n",
         ctx->frames_rendered,
         ctx->frames_skipped,
+        ctx->frameskip.level,
+        ctx->frameskip.auto_adjust ? ", auto" : "",
         ctx->current_fps,
-        ctx->memory_used / 1024,
-        ctx->memory_peak / 1024
+        ctx->tiles_drawn,
+        mem.live / 1024,
+        mem.peak / 1024,
+        mem.live_allocs,
+        mem.overhead,
+        mem.heap_free / 1024,
+        mem.largest_free / 1024,
+        mem.fragmentation
     );
+    
+    for (i = 0; i < OSD_MEM_TAG_COUNT && len > 0 && (size_t)len < size; i++) {
+        if (mem.tags[i].peak == 0) {
+            continue;
+        }
+        len += snprintf(buffer + len, size - len,
+            "  %-8s %6zu KB / %6zu KB peak (%u)\n",
+            osd_get_memory_tag_name(i),
+            mem.tags[i].live / 1024,
+            mem.tags[i].peak / 1024,
+            mem.tags[i].allocs
+        );
+    }
 }
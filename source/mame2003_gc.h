@@ -6,6 +6,7 @@
 #define MAME2003_GC_H
 
 #include "mame2003/osd_gc.h"
+#include "video/frameskip.h"
 
 /***************************************************************************
  * Version Information
@@ -25,6 +26,7 @@ typedef struct {
     int screen_width;
     int screen_height;
     int refresh_rate;
+    int orientation;          /* User rotation, ROTxxx (video/bitmap.h) */
     
     /* Audio settings */
     int audio_enabled;
@@ -34,8 +36,8 @@ typedef struct {
     int controller_port;
     
     /* Emulation settings */
-    int frameskip;
-    int auto_frameskip;
+    int frameskip;            /* Frames skipped out of every 12 (0..11) */
+    int auto_frameskip;       /* Adjust frameskip to the measured load */
     
     /* Debug settings */
     int show_fps;
@@ -61,6 +63,8 @@ typedef struct {
     int current_fps;
     int frames_rendered;
     int frames_skipped;
+    int tiles_drawn;          /* Tiles the last rendered frame redrew */
+    frameskip_t frameskip;
     
     /* Memory usage */
     size_t memory_used;
@@ -85,6 +89,11 @@ void mame2003_pause(mame2003_context_t* ctx);
 void mame2003_resume(mame2003_context_t* ctx);
 int  mame2003_run_frame(mame2003_context_t* ctx);
 
+/* Frame loop: begin returns 1 if the frame is to be drawn; skipped
+ * frames are emulated only. End reports the time spent in each phase. */
+int  mame2003_begin_frame(mame2003_context_t* ctx);
+void mame2003_end_frame(mame2003_context_t* ctx, u32 emulate_us, u32 render_us);
+
 /* Configuration */
 void mame2003_set_config(mame2003_context_t* ctx, const mame2003_config_t* config);
 void mame2003_get_config(const mame2003_context_t* ctx, mame2003_config_t* config);
@@ -0,0 +1,103 @@
+/***************************************************************************
+ * Indexed Bitmaps Implementation
+ ***************************************************************************/
+
+#include "bitmap.h"
+#include <stdio.h>
+#include <string.h>
+
+mame_bitmap* bitmap_alloc_depth(int width, int height, int depth) {
+    mame_bitmap* bitmap;
+    int bytes = depth / 8;
+
+    if ((depth != 8 && depth != 16) || width <= 0 || height <= 0) {
+        printf("ERROR: Unsupported bitmap %dx%d@%d\n", width, height, depth);
+        return NULL;
+    }
+
+    bitmap = (mame_bitmap*)osd_malloc_tagged(sizeof(mame_bitmap) + height * sizeof(void*),
+                                             OSD_MEM_VIDEO);
+    if (!bitmap) {
+        return NULL;
+    }
+
+    bitmap->width = width;
+    bitmap->height = height;
+    bitmap->depth = depth;
+
+    /* Rows start on a 32-byte cache line */
+    bitmap->rowbytes = (width * bytes + 31) & ~31;
+    bitmap->rowpixels = bitmap->rowbytes / bytes;
+    bitmap->line = (void**)(bitmap + 1);
+    bitmap->base = osd_memalign_tagged(32, bitmap->rowbytes * height, OSD_MEM_VIDEO);
+    if (!bitmap->base) {
+        osd_free(bitmap);
+        return NULL;
+    }
+
+    for (int y = 0; y < height; y++) {
+        bitmap->line[y] = (u8*)bitmap->base + y * bitmap->rowbytes;
+    }
+
+    memset(bitmap->base, 0, bitmap->rowbytes * height);
+    return bitmap;
+}
+
+void bitmap_free(mame_bitmap* bitmap) {
+    if (bitmap) {
+        osd_free(bitmap->base);
+        osd_free(bitmap);
+    }
+}
+
+void fillbitmap(mame_bitmap* bitmap, int pen, const rectangle* clip) {
+    int x0 = 0, x1 = bitmap->width - 1, y0 = 0, y1 = bitmap->height - 1;
+
+    if (clip) {
+        x0 = MAX(x0, clip->min_x);
+        x1 = MIN(x1, clip->max_x);
+        y0 = MAX(y0, clip->min_y);
+        y1 = MIN(y1, clip->max_y);
+    }
+    if (x0 > x1 || y0 > y1) {
+        return;
+    }
+
+    for (int y = y0; y <= y1; y++) {
+        if (bitmap->depth == 8) {
+            memset((u8*)bitmap->line[y] + x0, pen, x1 - x0 + 1);
+        } else {
+            u16* d = (u16*)bitmap->line[y];
+
+            for (int x = x0; x <= x1; x++) {
+                d[x] = pen;
+            }
+        }
+    }
+}
+
+void copybitmap_opaque(mame_bitmap* dest, const mame_bitmap* src) {
+    if (dest->depth != src->depth || dest->width != src->width || dest->height != src->height) {
+        printf("ERROR: Bitmap copy between different formats\n");
+        return;
+    }
+
+    memcpy(dest->base, src->base, src->rowbytes * src->height);
+}
+
+/***************************************************************************
+ * Orientation
+ ***************************************************************************/
+
+int orientation_compose(int first, int second) {
+    int flips = first & (ORIENTATION_FLIP_X | ORIENTATION_FLIP_Y);
+
+    /* Flipping X before a swap is flipping Y after it */
+    if (second & ORIENTATION_SWAP_XY) {
+        flips = ((flips & ORIENTATION_FLIP_X) ? ORIENTATION_FLIP_Y : 0) |
+                ((flips & ORIENTATION_FLIP_Y) ? ORIENTATION_FLIP_X : 0);
+    }
+
+    return ((first ^ second) & ORIENTATION_SWAP_XY) |
+           (flips ^ (second & (ORIENTATION_FLIP_X | ORIENTATION_FLIP_Y)));
+}
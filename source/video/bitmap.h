@@ -0,0 +1,66 @@
+/***************************************************************************
+ * Indexed Bitmaps for GameCube
+ *
+ * MAME-style bitmaps holding palette indices (pens) at 8 or 16 bits per
+ * pixel. Drivers render into a bitmap sized to the game's visible area;
+ * colours are only resolved when the frame is presented.
+ ***************************************************************************/
+
+#ifndef BITMAP_H
+#define BITMAP_H
+
+#include "../mame2003/osd_gc.h"
+#include "blit.h"
+
+/* Orientation: the swap is applied first, then the flips in the
+ * destination's coordinates */
+#define ORIENTATION_FLIP_X      0x0001
+#define ORIENTATION_FLIP_Y      0x0002
+#define ORIENTATION_SWAP_XY     0x0004
+
+#define ROT0                    0
+#define ROT90                   (ORIENTATION_SWAP_XY | ORIENTATION_FLIP_X)  /* Clockwise */
+#define ROT180                  (ORIENTATION_FLIP_X | ORIENTATION_FLIP_Y)
+#define ROT270                  (ORIENTATION_SWAP_XY | ORIENTATION_FLIP_Y)
+
+typedef struct mame_bitmap {
+    int width, height;        /* Visible area in pixels */
+    int depth;                /* 8 or 16 bits per pixel */
+    int rowpixels;            /* Pitch in pixels */
+    int rowbytes;
+    void* base;
+    void** line;              /* Start of each row */
+} mame_bitmap;
+
+/***************************************************************************
+ * Functions
+ ***************************************************************************/
+
+mame_bitmap* bitmap_alloc_depth(int width, int height, int depth);
+void bitmap_free(mame_bitmap* bitmap);
+
+/* Fill the clipped area (NULL = everything) with one pen */
+void fillbitmap(mame_bitmap* bitmap, int pen, const rectangle* clip);
+
+/* Copy a bitmap of the same size and depth */
+void copybitmap_opaque(mame_bitmap* dest, const mame_bitmap* src);
+
+/* Orientation 'second' applied after 'first' */
+int  orientation_compose(int first, int second);
+
+static INLINE int read_pixel(const mame_bitmap* bitmap, int x, int y) {
+    if (bitmap->depth == 8) {
+        return ((const u8*)bitmap->line[y])[x];
+    }
+    return ((const u16*)bitmap->line[y])[x];
+}
+
+static INLINE void plot_pixel(mame_bitmap* bitmap, int x, int y, int pen) {
+    if (bitmap->depth == 8) {
+        ((u8*)bitmap->line[y])[x] = pen;
+    } else {
+        ((u16*)bitmap->line[y])[x] = pen;
+    }
+}
+
+#endif /* BITMAP_H */
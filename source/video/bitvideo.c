@@ -0,0 +1,319 @@
+/***************************************************************************
+ * 1bpp Bitmapped Video Implementation
+ ***************************************************************************/
+
+#include "bitvideo.h"
+#include "../mame2003/memory.h"
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+
+/***************************************************************************
+ * Tables
+ ***************************************************************************/
+
+/* Pens stored in memory order, so the words are right on either
+ * endianness */
+static void bitvideo_pen_words(u64* words, int depth, const int* pens) {
+    u8 bytes[16];
+
+    if (depth == 8) {
+        for (int i = 0; i < 8; i++) {
+            bytes[i] = pens[i];
+        }
+    } else {
+        u16* p = (u16*)bytes;
+
+        for (int i = 0; i < 8; i++) {
+            p[i] = pens[i];
+        }
+    }
+    memcpy(words, bytes, depth);
+}
+
+static void bitvideo_build_expand(bitvideo_t* bv) {
+    int all = (bv->depth == 8) ? 0xFF : 0xFFFF;
+
+    for (int data = 0; data < 256; data++) {
+        int pens[8];
+
+        for (int x = 0; x < 8; x++) {
+            int bit = bv->lsb_first ? x : 7 - x;
+
+            pens[x] = (data >> bit) & 1 ? all : 0;
+        }
+        bitvideo_pen_words(bv->expand[data], bv->depth, pens);
+    }
+}
+
+/***************************************************************************
+ * Bitmapped Video
+ ***************************************************************************/
+
+bitvideo_t* bitvideo_create(const u8* vram, int width, int height, int depth, int lsb_first) {
+    bitvideo_t* bv;
+
+    if (!vram || width <= 0 || (width & 7) || width / 8 > BITVIDEO_MAX_COLUMNS || height <= 0 ||
+        (depth != 8 && depth != 16)) {
+        printf("ERROR: Unsupported 1bpp video %dx%d@%d\n", width, height, depth);
+        return NULL;
+    }
+
+    bv = (bitvideo_t*)osd_malloc_tagged(sizeof(bitvideo_t), OSD_MEM_VIDEO);
+    if (!bv) {
+        return NULL;
+    }
+    memset(bv, 0, sizeof(bitvideo_t));
+
+    bv->vram = vram;
+    bv->width = width;
+    bv->height = height;
+    bv->pitch = width / 8;
+    bv->depth = depth;
+    bv->words = depth / 8;
+    bv->lsb_first = lsb_first;
+    bv->tracker = -1;
+    bv->all_dirty = 1;
+    rect_set_empty(&bv->damage);
+
+    bv->shadow = (u8*)osd_malloc_tagged(bv->pitch * height, OSD_MEM_VIDEO);
+    if (!bv->shadow) {
+        bitvideo_free(bv);
+        return NULL;
+    }
+
+    bitvideo_build_expand(bv);
+    bitvideo_set_colors(bv, 0, width - 1, 1, 0);
+    return bv;
+}
+
+void bitvideo_free(bitvideo_t* bv) {
+    if (bv) {
+        if (bv->tracker >= 0) {
+            memory_untrack_writes(bv->tracker);
+        }
+        osd_free(bv->shadow);
+        osd_free(bv);
+    }
+}
+
+int bitvideo_track_memory(bitvideo_t* bv, UINT32 base) {
+    if (bv->tracker >= 0) {
+        memory_untrack_writes(bv->tracker);
+    }
+
+    bv->base = base;
+    bv->tracker = memory_track_writes(base, base + bv->pitch * bv->height - 1, MEMORY_TRACK_BYTES);
+    if (bv->tracker < 0) {
+        printf("ERROR: Failed to track 1bpp video memory\n");
+        return -1;
+    }
+
+    bv->all_dirty = 1;
+    return 0;
+}
+
+void bitvideo_set_colors(bitvideo_t* bv, int min_x, int max_x, int ink, int paper) {
+    min_x = MAX(min_x, 0);
+    max_x = MIN(max_x, bv->width - 1);
+    if (min_x > max_x) {
+        return;
+    }
+
+    for (int x = min_x; x <= max_x; x++) {
+        bv->ink_pens[x] = ink;
+        bv->paper_pens[x] = paper;
+    }
+
+    for (int col = min_x / 8; col <= max_x / 8; col++) {
+        int inks[8], papers[8];
+
+        for (int x = 0; x < 8; x++) {
+            inks[x] = bv->ink_pens[col * 8 + x];
+            papers[x] = bv->paper_pens[col * 8 + x];
+        }
+        bitvideo_pen_words(bv->paper[col], bv->depth, papers);
+        bitvideo_pen_words(bv->flip[col], bv->depth, inks);
+        for (int i = 0; i < bv->words; i++) {
+            bv->flip[col][i] ^= bv->paper[col][i];
+        }
+    }
+
+    bv->all_dirty = 1;
+}
+
+void bitvideo_mark_all_dirty(bitvideo_t* bv) {
+    bv->all_dirty = 1;
+}
+
+/***************************************************************************
+ * Drawing
+ ***************************************************************************/
+
+static INLINE void bitvideo_draw_byte(bitvideo_t* bv, int offset) {
+    int row = offset / bv->pitch;
+    int col = offset - row * bv->pitch;
+    u8 data = bv->vram[offset];
+    const u64* mask = bv->expand[data];
+    const u64* paper = bv->paper[col];
+    const u64* flip = bv->flip[col];
+    u64* d;
+
+    if (col >= bv->cols || row >= bv->rows) {
+        return;
+    }
+
+    /* Paper where the mask is clear, ink where it is set */
+    d = (u64*)bv->dest->line[row] + col * bv->words;
+    d[0] = paper[0] ^ (flip[0] & mask[0]);
+    if (bv->words == 2) {
+        d[1] = paper[1] ^ (flip[1] & mask[1]);
+    }
+    bv->shadow[offset] = data;
+    bv->bytes_drawn++;
+
+    {
+        rectangle area = { col * 8, col * 8 + 7, row, row };
+
+        union_rect(&bv->damage, &area);
+    }
+}
+
+/* Written bytes: only those holding a new value are drawn */
+static void bitvideo_dirty_range(UINT32 start, UINT32 end, void* param) {
+    bitvideo_t* bv = (bitvideo_t*)param;
+
+    for (int offset = start - bv->base; offset <= (int)(end - bv->base); offset++) {
+        if (bv->vram[offset] != bv->shadow[offset]) {
+            bitvideo_draw_byte(bv, offset);
+        }
+    }
+}
+
+int bitvideo_draw(bitvideo_t* bv, mame_bitmap* dest) {
+    int size = bv->pitch * bv->height;
+
+    if (dest->depth != bv->depth) {
+        printf("ERROR: 1bpp video drawn into a %d-bit bitmap, not %d-bit\n", dest->depth, bv->depth);
+        return -1;
+    }
+
+    /* A different bitmap holds none of what was drawn before */
+    if (dest != bv->dest) {
+        bv->dest = dest;
+        bv->all_dirty = 1;
+    }
+    bv->cols = MIN(bv->pitch, dest->width / 8);
+    bv->rows = MIN(bv->height, dest->height);
+    bv->bytes_drawn = 0;
+    rect_set_empty(&bv->damage);
+
+    if (bv->all_dirty) {
+        for (int offset = 0; offset < size; offset++) {
+            bitvideo_draw_byte(bv, offset);
+        }
+        bv->all_dirty = 0;
+        memory_dirty_clear(bv->tracker);
+    } else if (bv->tracker >= 0) {
+        if (memory_is_dirty(bv->tracker)) {
+            memory_dirty_iterate(bv->tracker, bitvideo_dirty_range, bv);
+        }
+    } else {
+        bitvideo_dirty_range(bv->base, bv->base + size - 1, bv);
+    }
+
+    bv->bytes_drawn_total += bv->bytes_drawn;
+    return bv->bytes_drawn;
+}
+
+/***************************************************************************
+ * Benchmark
+ ***************************************************************************/
+
+/* Generic path: every pixel looked up and plotted */
+static void bitvideo_plot(const bitvideo_t* bv, mame_bitmap* dest) {
+    for (int y = 0; y < bv->height; y++) {
+        for (int x = 0; x < bv->width; x++) {
+            int data = bv->vram[y * bv->pitch + x / 8];
+            int bit = (data >> (bv->lsb_first ? x & 7 : 7 - (x & 7))) & 1;
+
+            plot_pixel(dest, x, y, bit ? bv->ink_pens[x] : bv->paper_pens[x]);
+        }
+    }
+}
+
+static int bitvideo_mismatches(const mame_bitmap* a, const mame_bitmap* b) {
+    int rows = 0;
+
+    for (int y = 0; y < a->height; y++) {
+        if (memcmp(a->line[y], b->line[y], a->width * a->depth / 8)) {
+            rows++;
+        }
+    }
+    return rows;
+}
+
+int bitvideo_benchmark(int iterations) {
+    const int width = 256, height = 224, size = width / 8 * height;
+    u8* vram = (u8*)osd_malloc_tagged(size, OSD_MEM_VIDEO);
+    mame_bitmap* bitmap = bitmap_alloc_depth(width, height, 8);
+    mame_bitmap* plotted = bitmap_alloc_depth(width, height, 8);
+    bitvideo_t* bv = vram ? bitvideo_create(vram, width, height, 8, 1) : NULL;
+    UINT64 start, plot_us, full_us, dirty_us;
+    u32 seed = 0x1234567;
+    int mismatches;
+
+    if (!bitmap || !plotted || !bv) {
+        printf("ERROR: Failed to allocate 1bpp video benchmark\n");
+        bitvideo_free(bv);
+        bitmap_free(bitmap);
+        bitmap_free(plotted);
+        osd_free(vram);
+        return -1;
+    }
+
+    /* Invaders-style overlay: coloured bands across the image */
+    bitvideo_set_colors(bv, 184, 239, 2, 0);
+    bitvideo_set_colors(bv, 12, 68, 3, 0);
+    for (int i = 0; i < size; i++) {
+        seed = seed * 1103515245 + 12345;
+        vram[i] = seed >> 24;
+    }
+
+    start = osd_ticks_us();
+    for (int n = 0; n < iterations; n++) {
+        bitvideo_plot(bv, plotted);
+    }
+    plot_us = osd_ticks_us() - start;
+
+    start = osd_ticks_us();
+    for (int n = 0; n < iterations; n++) {
+        bitvideo_mark_all_dirty(bv);
+        bitvideo_draw(bv, bitmap);
+    }
+    full_us = osd_ticks_us() - start;
+    mismatches = bitvideo_mismatches(bitmap, plotted);
+
+    /* A typical frame: a few dozen bytes of moving sprites and bullets */
+    start = osd_ticks_us();
+    for (int n = 0; n < iterations; n++) {
+        for (int i = 0; i < 64; i++) {
+            seed = seed * 1103515245 + 12345;
+            vram[(seed >> 8) % size] ^= 1 << (n & 7);
+        }
+        bitvideo_draw(bv, bitmap);
+    }
+    dirty_us = osd_ticks_us() - start;
+    bitvideo_plot(bv, plotted);
+    mismatches += bitvideo_mismatches(bitmap, plotted);
+
+    printf("1bpp video %dx%d: plot %u us, LUT %u us, 64 changed bytes %u us per frame (%s)\n",
+           width, height, (u32)(plot_us / iterations), (u32)(full_us / iterations),
+           (u32)(dirty_us / iterations), mismatches ? "MISMATCH" : "match");
+
+    bitvideo_free(bv);
+    bitmap_free(bitmap);
+    bitmap_free(plotted);
+    osd_free(vram);
+    return mismatches;
+}
@@ -0,0 +1,89 @@
+/***************************************************************************
+ * 1bpp Bitmapped Video for GameCube
+ *
+ * Boards like Space Invaders have no tiles: video RAM is a plain 1bpp
+ * bitmap, and any colour comes from a cellophane overlay on the monitor.
+ * Each VRAM byte becomes 8 pens in the frame bitmap through a 256-entry
+ * table of precomputed masks, one 64-bit word per 8 pens (two at 16
+ * bits), and the overlay is a pair of ink/paper words per byte column,
+ * so a byte is drawn with three word operations per output word.
+ *
+ * Only bytes that changed are drawn: writes to tracked video RAM mark
+ * bytes dirty, and a shadow copy of what was last drawn drops writes
+ * that stored the same value again. The area drawn is returned as damage
+ * for the presentation.
+ ***************************************************************************/
+
+#ifndef BITVIDEO_H
+#define BITVIDEO_H
+
+#include "../mame2003/osd_gc.h"
+#include "bitmap.h"
+#include "blit.h"
+
+/***************************************************************************
+ * Configuration
+ ***************************************************************************/
+
+#define BITVIDEO_MAX_COLUMNS    64  /* Byte columns: up to 512 pixels wide */
+
+typedef struct {
+    const u8* vram;           /* Row-major, width / 8 bytes per row */
+    int width, height;        /* Pixels; width a multiple of 8 */
+    int pitch;                /* Bytes per row */
+    int depth;                /* Frame bitmap depth, 8 or 16 */
+    int words;                /* 64-bit output words per byte */
+    int lsb_first;            /* Bit 0 is the leftmost pixel */
+
+    /* Byte -> mask with all bits set in the pens of set pixels, in
+     * memory order */
+    u64 expand[256][2];
+
+    /* Overlay pens of each pixel column, and as words per byte column:
+     * the pens of clear pixels, and ink ^ paper */
+    u16 ink_pens[BITVIDEO_MAX_COLUMNS * 8];
+    u16 paper_pens[BITVIDEO_MAX_COLUMNS * 8];
+    u64 paper[BITVIDEO_MAX_COLUMNS][2];
+    u64 flip[BITVIDEO_MAX_COLUMNS][2];
+
+    u8* shadow;               /* VRAM as last drawn */
+    int all_dirty;
+    mame_bitmap* dest;        /* Bitmap drawn into last */
+    UINT32 base;              /* CPU address of the VRAM when tracked */
+    int tracker;              /* Write tracker on VRAM, or -1 */
+
+    /* Per draw */
+    rectangle damage;
+    int cols, rows;           /* Bytes that fit the bitmap */
+    u32 bytes_drawn;
+    u32 bytes_drawn_total;
+} bitvideo_t;
+
+/***************************************************************************
+ * Functions
+ ***************************************************************************/
+
+/* Video RAM of width x height pixels for a frame bitmap of 'depth'; all
+ * pixels ink 1 on paper 0 until an overlay is set. NULL on failure. */
+bitvideo_t* bitvideo_create(const u8* vram, int width, int height, int depth, int lsb_first);
+void bitvideo_free(bitvideo_t* bv);
+
+/* Track CPU writes to the video RAM at 'base'; without tracking every
+ * byte is compared against the shadow each draw */
+int  bitvideo_track_memory(bitvideo_t* bv, UINT32 base);
+
+/* Overlay pens for VRAM pixel columns min_x..max_x */
+void bitvideo_set_colors(bitvideo_t* bv, int min_x, int max_x, int ink, int paper);
+
+void bitvideo_mark_all_dirty(bitvideo_t* bv);
+
+/* Draw the changed bytes into 'dest' at its top-left; bytes past its
+ * edges are left out. The area drawn is left in bv->damage. Returns the
+ * bytes drawn, or -1 on a bitmap of the wrong depth. */
+int  bitvideo_draw(bitvideo_t* bv, mame_bitmap* dest);
+
+/* Time LUT and dirty redraws against plotting each pixel; returns the
+ * rows where they disagree */
+int bitvideo_benchmark(int iterations);
+
+#endif /* BITVIDEO_H */
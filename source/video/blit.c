@@ -0,0 +1,174 @@
+/***************************************************************************
+ * Tile Blitters Implementation
+ ***************************************************************************/
+
+#include "blit.h"
+#include <string.h>
+
+/***************************************************************************
+ * Tables
+ ***************************************************************************/
+
+/* ITU-R BT.601, same integer weights as the display conversion */
+u32 blit_yuy2_pair(u32 rgba0, u32 rgba1) {
+    int r0 = rgba0 >> 24, g0 = (rgba0 >> 16) & 0xFF, b0 = (rgba0 >> 8) & 0xFF;
+    int r1 = rgba1 >> 24, g1 = (rgba1 >> 16) & 0xFF, b1 = (rgba1 >> 8) & 0xFF;
+    int r = (r0 + r1) >> 1, g = (g0 + g1) >> 1, b = (b0 + b1) >> 1;
+    int y0 = (77 * r0 + 150 * g0 + 29 * b0) >> 8;
+    int y1 = (77 * r1 + 150 * g1 + 29 * b1) >> 8;
+    int u = ((-38 * r - 74 * g + 112 * b) >> 8) + 128;
+    int v = ((112 * r - 94 * g - 18 * b) >> 8) + 128;
+
+    y0 = MIN(MAX(y0, 0), 255);
+    y1 = MIN(MAX(y1, 0), 255);
+    u = MIN(MAX(u, 0), 255);
+    v = MIN(MAX(v, 0), 255);
+
+    return (y0 << 24) | (u << 16) | (y1 << 8) | v;
+}
+
+void blit_build_quad8_table(blit_quad8_table table, const u8* pens) {
+    u8 quad[4];
+
+    for (int n = 0; n < 256; n++) {
+        quad[0] = pens[n >> 6];
+        quad[1] = pens[(n >> 4) & 3];
+        quad[2] = pens[(n >> 2) & 3];
+        quad[3] = pens[n & 3];
+        memcpy(&table[n], quad, sizeof(u32));
+    }
+}
+
+void blit_build_pair16_table(blit_pair16_table table, const u16* pens) {
+    u16 pair[2];
+
+    for (int n = 0; n < 16; n++) {
+        pair[0] = pens[n >> 2];
+        pair[1] = pens[n & 3];
+        memcpy(&table[n], pair, sizeof(u32));
+    }
+}
+
+/***************************************************************************
+ * 2bpp to Indexed 8/16bpp
+ ***************************************************************************/
+
+/* One packed row: a 32-bit store per byte of source */
+static INLINE void blit_row_2bpp_8(u8* d, const u8* src, int bytes, const blit_quad8_table quads) {
+    for (int i = 0; i < bytes; i++) {
+        memcpy(d, &quads[src[i]], sizeof(u32));
+        d += 4;
+    }
+}
+
+static INLINE void blit_row_2bpp_16(u16* d, const u8* src, int bytes, const blit_pair16_table pairs) {
+    for (int i = 0; i < bytes; i++) {
+        memcpy(d, &pairs[src[i] >> 4], sizeof(u32));
+        memcpy(d + 2, &pairs[src[i] & 15], sizeof(u32));
+        d += 4;
+    }
+}
+
+void blit_tile_2bpp_8(u8* dst, int pitch, const gfx_element_t* gfx, u32 code,
+                      int x, int y, int flip, const blit_quad8_table quads,
+                      const rectangle* clip) {
+    int w = gfx->width;
+    int h = gfx->height;
+    int flipx = flip & BLIT_FLIPX;
+    int flipy = flip & BLIT_FLIPY;
+    int mirror = flipx && !gfx->data_flipx;
+    u8 line[MAX_GFX_SIZE];
+    int x0, x1, y0, y1;
+
+    if (gfx->bpp != 2) {
+        return;
+    }
+
+    if (x > clip->max_x || y > clip->max_y || x + w - 1 < clip->min_x || y + h - 1 < clip->min_y) {
+        return;
+    }
+
+    if (!mirror && x >= clip->min_x && x + w - 1 <= clip->max_x &&
+        y >= clip->min_y && y + h - 1 <= clip->max_y) {
+        u8* d = dst + y * pitch + x;
+
+        for (int row = 0; row < h; row++) {
+            blit_row_2bpp_8(d, gfx_element_row(gfx, code, flipy ? h - 1 - row : row, flipx),
+                            gfx->row_bytes, quads);
+            d += pitch;
+        }
+        return;
+    }
+
+    x0 = MAX(x, clip->min_x) - x;
+    x1 = MIN(x + w - 1, clip->max_x) - x;
+    y0 = MAX(y, clip->min_y);
+    y1 = MIN(y + h - 1, clip->max_y);
+
+    for (int sy = y0; sy <= y1; sy++) {
+        int row = sy - y;
+
+        blit_row_2bpp_8(line, gfx_element_row(gfx, code, flipy ? h - 1 - row : row, flipx && !mirror),
+                        gfx->row_bytes, quads);
+        if (mirror) {
+            for (int i = 0; i < w / 2; i++) {
+                u8 t = line[i];
+                line[i] = line[w - 1 - i];
+                line[w - 1 - i] = t;
+            }
+        }
+        memcpy(dst + sy * pitch + x + x0, line + x0, x1 - x0 + 1);
+    }
+}
+
+void blit_tile_2bpp_16(u16* dst, int pitch, const gfx_element_t* gfx, u32 code,
+                       int x, int y, int flip, const blit_pair16_table pairs,
+                       const rectangle* clip) {
+    int w = gfx->width;
+    int h = gfx->height;
+    int flipx = flip & BLIT_FLIPX;
+    int flipy = flip & BLIT_FLIPY;
+    int mirror = flipx && !gfx->data_flipx;
+    u16 line[MAX_GFX_SIZE];
+    int x0, x1, y0, y1;
+
+    if (gfx->bpp != 2) {
+        return;
+    }
+
+    if (x > clip->max_x || y > clip->max_y || x + w - 1 < clip->min_x || y + h - 1 < clip->min_y) {
+        return;
+    }
+
+    if (!mirror && x >= clip->min_x && x + w - 1 <= clip->max_x &&
+        y >= clip->min_y && y + h - 1 <= clip->max_y) {
+        u16* d = dst + y * pitch + x;
+
+        for (int row = 0; row < h; row++) {
+            blit_row_2bpp_16(d, gfx_element_row(gfx, code, flipy ? h - 1 - row : row, flipx),
+                             gfx->row_bytes, pairs);
+            d += pitch;
+        }
+        return;
+    }
+
+    x0 = MAX(x, clip->min_x) - x;
+    x1 = MIN(x + w - 1, clip->max_x) - x;
+    y0 = MAX(y, clip->min_y);
+    y1 = MIN(y + h - 1, clip->max_y);
+
+    for (int sy = y0; sy <= y1; sy++) {
+        int row = sy - y;
+
+        blit_row_2bpp_16(line, gfx_element_row(gfx, code, flipy ? h - 1 - row : row, flipx && !mirror),
+                         gfx->row_bytes, pairs);
+        if (mirror) {
+            for (int i = 0; i < w / 2; i++) {
+                u16 t = line[i];
+                line[i] = line[w - 1 - i];
+                line[w - 1 - i] = t;
+            }
+        }
+        memcpy(dst + sy * pitch + x + x0, line + x0, (x1 - x0 + 1) * sizeof(u16));
+    }
+}
@@ -0,0 +1,81 @@
+/***************************************************************************
+ * Tile Blitters for GameCube
+ *
+ * Draw whole tile rows at a time from packed graphics into the indexed
+ * frame bitmap. Each colour code has a table of precomputed pens for
+ * every packed byte (8bpp) or nibble (16bpp) of a 2bpp row, so a row of
+ * 8 pixels is two 32-bit stores at 8bpp with no per-pixel arithmetic.
+ * Clipping is decided once per tile.
+ ***************************************************************************/
+
+#ifndef BLIT_H
+#define BLIT_H
+
+#include "../mame2003/osd_gc.h"
+#include "gfx_decode.h"
+
+/* Inclusive clip rectangle, in destination pixels; empty when
+ * min > max */
+typedef struct {
+    int min_x, max_x;
+    int min_y, max_y;
+} rectangle;
+
+static INLINE void rect_set_empty(rectangle* rect) {
+    rect->min_x = rect->min_y = 0;
+    rect->max_x = rect->max_y = -1;
+}
+
+static INLINE int rect_is_empty(const rectangle* rect) {
+    return rect->min_x > rect->max_x || rect->min_y > rect->max_y;
+}
+
+/* Grow dst to cover src as well */
+static INLINE void union_rect(rectangle* dst, const rectangle* src) {
+    if (rect_is_empty(src)) {
+        return;
+    }
+    if (rect_is_empty(dst)) {
+        *dst = *src;
+        return;
+    }
+    dst->min_x = MIN(dst->min_x, src->min_x);
+    dst->max_x = MAX(dst->max_x, src->max_x);
+    dst->min_y = MIN(dst->min_y, src->min_y);
+    dst->max_y = MAX(dst->max_y, src->max_y);
+}
+
+/* Shrink dst to its overlap with src */
+static INLINE void sect_rect(rectangle* dst, const rectangle* src) {
+    dst->min_x = MAX(dst->min_x, src->min_x);
+    dst->max_x = MIN(dst->max_x, src->max_x);
+    dst->min_y = MAX(dst->min_y, src->min_y);
+    dst->max_y = MIN(dst->max_y, src->max_y);
+}
+
+/* Pack a pixel pair into one Y0 U Y1 V word; chroma is the average of
+ * the two */
+u32  blit_yuy2_pair(u32 rgba0, u32 rgba1);
+
+/* Indexed pens: an 8bpp quad table maps each packed byte (four 2bpp
+ * pixels) to the four pen bytes as one 32-bit store; a 16bpp pair table
+ * maps each nibble to two pen halfwords */
+typedef u32 blit_quad8_table[256];
+typedef u32 blit_pair16_table[16];
+
+void blit_build_quad8_table(blit_quad8_table table, const u8* pens);
+void blit_build_pair16_table(blit_pair16_table table, const u16* pens);
+
+/* Tile flips; both together turn the tile through 180 degrees */
+#define BLIT_FLIPX          0x01
+#define BLIT_FLIPY          0x02
+
+/* Opaque 2bpp tile to an indexed bitmap (pitch in pixels) */
+void blit_tile_2bpp_8(u8* dst, int pitch, const gfx_element_t* gfx, u32 code,
+                      int x, int y, int flip, const blit_quad8_table quads,
+                      const rectangle* clip);
+void blit_tile_2bpp_16(u16* dst, int pitch, const gfx_element_t* gfx, u32 code,
+                       int x, int y, int flip, const blit_pair16_table pairs,
+                       const rectangle* clip);
+
+#endif /* BLIT_H */
@@ -0,0 +1,153 @@
+/***************************************************************************
+ * Presentation Blitters Implementation
+ ***************************************************************************/
+
+#include "blitter.h"
+#include <stdio.h>
+#include <string.h>
+
+/***************************************************************************
+ * Template
+ *
+ * Destination (x, y) of the oriented image reads source (ux, uy) with
+ * the flips undone, swapped back when ORIENTATION_SWAP_XY is set. A
+ * destination row is then one walk through the source with a constant
+ * step: a pixel along a row, or a row pitch down a column (bitmap rows
+ * are evenly spaced). A column touches one cache line per source row,
+ * and the next destination row reads the same lines again, so a frame
+ * bitmap's column walk stays in cache without gathering blocks first.
+ * Pens are masked to the palette size, a power of two (palette_init
+ * refuses others), so stray bits can never index past the tables.
+ ***************************************************************************/
+
+#define BLITTER_SWAP(o)         (((o) & ORIENTATION_SWAP_XY) != 0)
+#define BLITTER_FX(o)           (((o) & ORIENTATION_FLIP_X) != 0)
+#define BLITTER_FY(o)           (((o) & ORIENTATION_FLIP_Y) != 0)
+
+/* Words taken by n pixels */
+#define BLITTER_WORDS_RGBA8888(n)   (n)
+#define BLITTER_WORDS_YUY2(n)       ((n) / 2)
+
+/* One pixel in, 'scale' words out */
+#define BLITTER_ROW_RGBA8888(scale)                                                 \
+    for (int x = 0; x < a->width; x++) {                                            \
+        u32 word = rgba[*s & mask];                                                 \
+                                                                                    \
+        for (int k = 0; k < (scale); k++) {                                         \
+            *d++ = word;                                                            \
+        }                                                                           \
+        s += step;                                                                  \
+    }
+
+/* Even zooms give each pixel whole words of its own; odd zooms take two
+ * pixels at a time, and output pair k pairs pixels 2k and 2k + 1 of the
+ * zoomed run */
+#define BLITTER_ROW_YUY2(scale)                                                     \
+    if ((scale) % 2 == 0) {                                                         \
+        for (int x = 0; x < a->width; x++) {                                        \
+            int p = *s & mask;                                                      \
+            u32 word = yuy2[p * stride + p];                                        \
+                                                                                    \
+            for (int k = 0; k < (scale) / 2; k++) {                                 \
+                *d++ = word;                                                        \
+            }                                                                       \
+            s += step;                                                              \
+        }                                                                           \
+    } else {                                                                        \
+        for (int x = 0; x < a->width; x += 2) {                                     \
+            int p0 = s[0] & mask;                                                   \
+            int p1 = s[step] & mask;                                                \
+                                                                                    \
+            for (int k = 0; k < (scale); k++) {                                     \
+                *d++ = yuy2[(2 * k < (scale) ? p0 : p1) * stride +                  \
+                            (2 * k + 1 < (scale) ? p0 : p1)];                       \
+            }                                                                       \
+            s += 2 * step;                                                          \
+        }                                                                           \
+    }
+
+#define BLITTER_FUNC(depth, type, format, scale, o)                                 \
+static void blitter_##depth##_##format##_x##scale##_##o(const blitter_args* a) {    \
+    const mame_bitmap* src = a->src;                                                \
+    const u32* rgba = a->palette->pen_rgba;                                         \
+    const u32* yuy2 = a->palette->pen_yuy2;                                         \
+    int stride = a->palette->total_pens;                                            \
+    int mask = a->palette->total_pens - 1;                                          \
+    int ow = BLITTER_SWAP(o) ? src->height : src->width;                            \
+    int oh = BLITTER_SWAP(o) ? src->width : src->height;                            \
+    int step = BLITTER_SWAP(o) ? (BLITTER_FX(o) ? -src->rowpixels : src->rowpixels) \
+                               : (BLITTER_FX(o) ? -1 : 1);                          \
+                                                                                    \
+    (void)rgba; (void)yuy2; (void)stride;                                           \
+    for (int y = a->y; y < a->y + a->height; y++) {                                 \
+        int ux = BLITTER_FX(o) ? ow - 1 - a->x : a->x;                              \
+        int uy = BLITTER_FY(o) ? oh - 1 - y : y;                                    \
+        const type* s = BLITTER_SWAP(o) ? (const type*)src->line[ux] + uy           \
+                                        : (const type*)src->line[uy] + ux;          \
+        u32* row = a->dst + y * (scale) * a->pitch +                                \
+                   BLITTER_WORDS_##format(a->x * (scale));                          \
+        u32* d = row;                                                               \
+                                                                                    \
+        BLITTER_ROW_##format(scale)                                                 \
+                                                                                    \
+        /* Repeat the row for the vertical zoom */                                  \
+        for (int r = 1; r < (scale); r++) {                                         \
+            memcpy(row + r * a->pitch, row, (d - row) * sizeof(u32));               \
+        }                                                                           \
+    }                                                                               \
+}
+
+/***************************************************************************
+ * Instances
+ ***************************************************************************/
+
+#define BLITTER_GEN_ORIENTATIONS(depth, type, format, scale)                        \
+    BLITTER_FUNC(depth, type, format, scale, 0)                                     \
+    BLITTER_FUNC(depth, type, format, scale, 1)                                     \
+    BLITTER_FUNC(depth, type, format, scale, 2)                                     \
+    BLITTER_FUNC(depth, type, format, scale, 3)                                     \
+    BLITTER_FUNC(depth, type, format, scale, 4)                                     \
+    BLITTER_FUNC(depth, type, format, scale, 5)                                     \
+    BLITTER_FUNC(depth, type, format, scale, 6)                                     \
+    BLITTER_FUNC(depth, type, format, scale, 7)
+
+/* One per zoom up to BLITTER_MAX_SCALE */
+#define BLITTER_GEN_SCALES(depth, type, format)                                     \
+    BLITTER_GEN_ORIENTATIONS(depth, type, format, 1)                                \
+    BLITTER_GEN_ORIENTATIONS(depth, type, format, 2)                                \
+    BLITTER_GEN_ORIENTATIONS(depth, type, format, 3)
+
+BLITTER_GEN_SCALES(8, u8, RGBA8888)
+BLITTER_GEN_SCALES(8, u8, YUY2)
+BLITTER_GEN_SCALES(16, u16, RGBA8888)
+BLITTER_GEN_SCALES(16, u16, YUY2)
+
+#define BLITTER_ENTRY_ORIENTATIONS(depth, format, scale) {                          \
+    blitter_##depth##_##format##_x##scale##_0, blitter_##depth##_##format##_x##scale##_1, \
+    blitter_##depth##_##format##_x##scale##_2, blitter_##depth##_##format##_x##scale##_3, \
+    blitter_##depth##_##format##_x##scale##_4, blitter_##depth##_##format##_x##scale##_5, \
+    blitter_##depth##_##format##_x##scale##_6, blitter_##depth##_##format##_x##scale##_7 }
+
+#define BLITTER_ENTRY_SCALES(depth, format) {                                       \
+    BLITTER_ENTRY_ORIENTATIONS(depth, format, 1),                                   \
+    BLITTER_ENTRY_ORIENTATIONS(depth, format, 2),                                   \
+    BLITTER_ENTRY_ORIENTATIONS(depth, format, 3) }
+
+/* [depth 8/16][format][scale - 1][orientation] */
+static const blitter_func blitter_table[2][BLITTER_FORMATS][BLITTER_MAX_SCALE][BLITTER_ORIENTATIONS] = {
+    { BLITTER_ENTRY_SCALES(8, RGBA8888), BLITTER_ENTRY_SCALES(8, YUY2) },
+    { BLITTER_ENTRY_SCALES(16, RGBA8888), BLITTER_ENTRY_SCALES(16, YUY2) }
+};
+
+/***************************************************************************
+ * Selection
+ ***************************************************************************/
+
+blitter_func blitter_select(int orientation, int depth, int format, int scale) {
+    if ((depth != 8 && depth != 16) || format < 0 || format >= BLITTER_FORMATS ||
+        scale < 1 || scale > BLITTER_MAX_SCALE) {
+        return NULL;
+    }
+
+    return blitter_table[depth == 16][format][scale - 1][orientation & (BLITTER_ORIENTATIONS - 1)];
+}
@@ -0,0 +1,52 @@
+/***************************************************************************
+ * Presentation Blitters for GameCube
+ *
+ * Resolve the frame bitmap through the palette into the target in one
+ * pass: orientation, integer zoom, bitmap depth and target format are
+ * all folded into the loop. Every combination is its own function,
+ * generated at compile time from one template, so the orientation steps,
+ * zoom factor and output words are constants of the inner loop. The
+ * caller picks the function once, when the target or orientation
+ * changes, and calls through the pointer every frame.
+ ***************************************************************************/
+
+#ifndef BLITTER_H
+#define BLITTER_H
+
+#include "../mame2003/osd_gc.h"
+#include "bitmap.h"
+#include "palette.h"
+
+/***************************************************************************
+ * Configuration
+ ***************************************************************************/
+
+/* Target formats */
+#define BLITTER_RGBA8888        0   /* One 32-bit RGBA word per pixel */
+#define BLITTER_YUY2            1   /* One Y0 U Y1 V word per pixel pair */
+#define BLITTER_FORMATS         2
+
+#define BLITTER_ORIENTATIONS    8   /* Every ORIENTATION_xxx combination */
+#define BLITTER_MAX_SCALE       3
+
+typedef struct {
+    const mame_bitmap* src;   /* Frame bitmap, before orientation */
+    u32* dst;                 /* Top-left of the game area in the target */
+    int pitch;                /* Target pitch in 32-bit words */
+    int x, y;                 /* Oriented source pixel to start from */
+    int width, height;        /* Oriented source pixels to draw; x and
+                               * width are even for YUY2 at odd zooms */
+    const palette_t* palette;
+} blitter_args;
+
+typedef void (*blitter_func)(const blitter_args* args);
+
+/***************************************************************************
+ * Functions
+ ***************************************************************************/
+
+/* The blitter for a combination, or NULL if there is none (depth other
+ * than 8/16, zoom above BLITTER_MAX_SCALE) */
+blitter_func blitter_select(int orientation, int depth, int format, int scale);
+
+#endif /* BLITTER_H */
@@ -0,0 +1,181 @@
+/***************************************************************************
+ * Frameskip Implementation
+ ***************************************************************************/
+
+#include "frameskip.h"
+#include <stdio.h>
+#include <string.h>
+
+/* 1 = skip; level n skips n frames of each 12, spread out (MAME's table) */
+static const u8 frameskip_table[FRAMESKIP_LEVELS][FRAMESKIP_LEVELS] = {
+    { 0,0,0,0,0,0,0,0,0,0,0,0 },
+    { 0,0,0,0,0,0,0,0,0,0,0,1 },
+    { 0,0,0,0,0,1,0,0,0,0,0,1 },
+    { 0,0,0,1,0,0,0,1,0,0,0,1 },
+    { 0,0,1,0,0,1,0,0,1,0,0,1 },
+    { 0,1,0,0,1,0,1,0,0,1,0,1 },
+    { 0,1,0,1,0,1,0,1,0,1,0,1 },
+    { 0,1,0,1,1,0,1,0,1,1,0,1 },
+    { 0,1,1,0,1,1,0,1,1,0,1,1 },
+    { 0,1,1,1,0,1,1,1,0,1,1,1 },
+    { 0,1,1,1,1,1,0,1,1,1,1,1 },
+    { 0,1,1,1,1,1,1,1,1,1,1,1 }
+};
+
+/***************************************************************************
+ * Frameskip
+ ***************************************************************************/
+
+void frameskip_init(frameskip_t* fs, int level, int auto_adjust, int refresh_rate) {
+    memset(fs, 0, sizeof(frameskip_t));
+    fs->level = MAX(0, MIN(level, FRAMESKIP_LEVELS - 1));
+    fs->auto_adjust = auto_adjust;
+    fs->budget_us = 1000000 / MAX(refresh_rate, 1);
+}
+
+int frameskip_begin_frame(frameskip_t* fs) {
+    fs->drawing = !frameskip_table[fs->level][fs->cycle];
+    fs->cycle = (fs->cycle + 1) % FRAMESKIP_LEVELS;
+    return fs->drawing;
+}
+
+/* Predicted time of one skip cycle at 'level' */
+static u32 frameskip_cycle_us(const frameskip_t* fs, int level) {
+    u32 emulate = fs->emulate_sum / 8;
+    u32 render = fs->render_sum / 8;
+
+    return FRAMESKIP_LEVELS * emulate + (FRAMESKIP_LEVELS - level) * render;
+}
+
+static void frameskip_adjust(frameskip_t* fs) {
+    u32 budget = FRAMESKIP_LEVELS * fs->budget_us;
+    int wanted = FRAMESKIP_LEVELS - 1;
+
+    budget -= budget / FRAMESKIP_HEADROOM;
+    for (int level = 0; level < FRAMESKIP_LEVELS; level++) {
+        if (frameskip_cycle_us(fs, level) <= budget) {
+            wanted = level;
+            break;
+        }
+    }
+
+    if (wanted > fs->level) {
+        /* Overrun ahead: skip more straight away */
+        fs->level = wanted;
+        fs->settle = 0;
+        fs->stats.raises++;
+    } else if (wanted < fs->level) {
+        /* Only come down once the cheaper level has held for a cycle */
+        if (++fs->settle >= FRAMESKIP_LEVELS) {
+            fs->level--;
+            fs->settle = 0;
+            fs->stats.lowers++;
+        }
+    } else {
+        fs->settle = 0;
+    }
+}
+
+void frameskip_end_frame(frameskip_t* fs, u32 emulate_us, u32 render_us) {
+    fs->stats.frames++;
+    if (fs->drawing) {
+        fs->stats.drawn++;
+    } else {
+        fs->stats.skipped++;
+    }
+    if (emulate_us > fs->budget_us) {
+        fs->stats.overloaded++;
+    }
+
+    if (fs->stats.frames == 1) {
+        fs->emulate_sum = emulate_us * 8;
+    } else {
+        fs->emulate_sum += emulate_us - fs->emulate_sum / 8;
+    }
+    if (fs->drawing) {
+        if (!fs->sampled) {
+            fs->render_sum = render_us * 8;
+            fs->sampled = 1;
+        } else {
+            fs->render_sum += render_us - fs->render_sum / 8;
+        }
+    }
+
+    if (fs->auto_adjust && fs->sampled) {
+        frameskip_adjust(fs);
+    }
+}
+
+void frameskip_get_stats(const frameskip_t* fs, frameskip_stats_t* stats) {
+    *stats = fs->stats;
+}
+
+/***************************************************************************
+ * Simulation
+ ***************************************************************************/
+
+void frameskip_simulate(int level, int auto_adjust, const u32* emulate_us, const u32* render_us,
+                        int frames, u32 refresh_us, frameskip_stats_t* stats, u32* late) {
+    frameskip_t fs;
+    UINT64 now = 0, deadline = 0;
+
+    frameskip_init(&fs, level, auto_adjust, 1);
+    fs.budget_us = refresh_us;
+    *late = 0;
+
+    /* Each frame's sound is due one refresh after the last; the loop
+     * sleeps when it is early, and a frame more than a refresh behind
+     * means the buffered sound ran out and playback restarts from now */
+    for (int frame = 0; frame < frames; frame++) {
+        int draw = frameskip_begin_frame(&fs);
+        u32 render = draw ? render_us[frame] : 0;
+
+        now += emulate_us[frame] + render;
+        deadline += refresh_us;
+        if (now > deadline + refresh_us) {
+            (*late)++;
+            deadline = now;
+        } else if (now < deadline) {
+            now = deadline;
+        }
+
+        frameskip_end_frame(&fs, emulate_us[frame], render);
+    }
+
+    frameskip_get_stats(&fs, stats);
+}
+
+void frameskip_benchmark(void) {
+    const u32 refresh_us = 16683;     /* 59.94 Hz */
+    const int frames = 600;
+    static const int levels[] = { 0, 2, 4 };
+    u32* emulate_us = (u32*)osd_malloc_tagged(frames * 2 * sizeof(u32), OSD_MEM_VIDEO);
+    u32* render_us = emulate_us + frames;
+    u32 seed = 0x2468ACE0;
+    frameskip_stats_t stats;
+    u32 late;
+
+    if (!emulate_us) {
+        printf("ERROR: Failed to allocate frameskip benchmark\n");
+        return;
+    }
+
+    /* Light for the first third, then drawing alone nearly fills a frame */
+    for (int i = 0; i < frames; i++) {
+        seed = seed * 1103515245 + 12345;
+        emulate_us[i] = 6000 + ((seed >> 16) % 1000);
+        render_us[i] = (i < frames / 3 ? 5000 : 14000) + ((seed >> 8) % 1500);
+    }
+
+    for (int i = 0; i < (int)(sizeof(levels) / sizeof(levels[0])); i++) {
+        frameskip_simulate(levels[i], 0, emulate_us, render_us, frames, refresh_us, &stats, &late);
+        printf("Frameskip %d: %u drawn, %u skipped, %u late\n",
+               levels[i], stats.drawn, stats.skipped, late);
+    }
+
+    frameskip_simulate(0, 1, emulate_us, render_us, frames, refresh_us, &stats, &late);
+    printf("Frameskip auto: %u drawn, %u skipped, %u late (%u up, %u down)\n",
+           stats.drawn, stats.skipped, late, stats.raises, stats.lowers);
+
+    osd_free(emulate_us);
+}
@@ -0,0 +1,81 @@
+/***************************************************************************
+ * Frameskip for GameCube
+ *
+ * Emulation (and with it sound) runs every frame; drawing, conversion and
+ * the XFB flush run only on the frames the skip pattern lets through. As
+ * in MAME, the level is how many frames out of every 12 are skipped, and
+ * the skipped frames are spread evenly over the 12. Nothing that tracks
+ * changes is cleared on a skipped frame, so the next drawn frame picks up
+ * everything written since the last one.
+ *
+ * In auto mode the emulation and render phases are timed every frame.
+ * From their averages the cost of a whole 12-frame cycle is predicted at
+ * each level, and the lowest level that fits the display's frame budget
+ * is used: raised at once when a cycle would overrun, lowered one step
+ * at a time after a full cycle in which the lower level would have fit.
+ ***************************************************************************/
+
+#ifndef FRAMESKIP_H
+#define FRAMESKIP_H
+
+#include "../mame2003/osd_gc.h"
+
+/***************************************************************************
+ * Configuration
+ ***************************************************************************/
+
+#define FRAMESKIP_LEVELS        12  /* Pattern length; levels are 0..11 */
+#define FRAMESKIP_HEADROOM      16  /* Keep 1/16 of the budget spare */
+
+typedef struct {
+    u32 frames;
+    u32 drawn;
+    u32 skipped;
+    u32 raises;               /* Auto level increases */
+    u32 lowers;               /* Auto level decreases */
+    u32 overloaded;           /* Frames that emulation alone overran */
+} frameskip_stats_t;
+
+typedef struct {
+    int level;                /* Frames skipped out of every 12 */
+    int auto_adjust;
+    u32 budget_us;            /* One frame at the display rate */
+
+    int cycle;                /* Position in the skip pattern */
+    int drawing;              /* The current frame is being drawn */
+
+    /* Phase times, sums of the last ~8 samples (average = sum / 8) */
+    u32 emulate_sum;
+    u32 render_sum;
+    int sampled;              /* Render time has been measured */
+    int settle;               /* Frames a lower level would have fit */
+
+    frameskip_stats_t stats;
+} frameskip_t;
+
+/***************************************************************************
+ * Functions
+ ***************************************************************************/
+
+/* Fixed level (0..11), or a starting level that auto mode adjusts */
+void frameskip_init(frameskip_t* fs, int level, int auto_adjust, int refresh_rate);
+
+/* Start a frame: 1 if it is to be drawn, 0 if only emulated */
+int  frameskip_begin_frame(frameskip_t* fs);
+
+/* Finish a frame with the time spent emulating and drawing it (render_us
+ * is ignored for skipped frames); adjusts the level in auto mode */
+void frameskip_end_frame(frameskip_t* fs, u32 emulate_us, u32 render_us);
+
+void frameskip_get_stats(const frameskip_t* fs, frameskip_stats_t* stats);
+
+/* Run 'frames' frames with the given phase times against a display
+ * refreshing every refresh_us; late counts frames whose sound would have
+ * run dry (more than one frame behind) */
+void frameskip_simulate(int level, int auto_adjust, const u32* emulate_us, const u32* render_us,
+                        int frames, u32 refresh_us, frameskip_stats_t* stats, u32* late);
+
+/* Fixed levels against auto mode on a workload that cannot draw every frame */
+void frameskip_benchmark(void);
+
+#endif /* FRAMESKIP_H */
@@ -0,0 +1,270 @@
+/***************************************************************************
+ * Graphics Decoding Implementation
+ ***************************************************************************/
+
+#include "gfx_decode.h"
+#include "../mame2003/memory.h"
+#include <string.h>
+#include <stdio.h>
+
+u32 gfx_expand_2bpp[256];
+u16 gfx_expand_4bpp[256];
+
+/***************************************************************************
+ * Expansion Tables
+ ***************************************************************************/
+
+void gfx_expand_init(void) {
+    static int initialized = 0;
+    u8 pens[4];
+    int i;
+
+    if (initialized) {
+        return;
+    }
+
+    /* Built through a byte array so pens land in memory order on any host */
+    for (i = 0; i < 256; i++) {
+        pens[0] = (i >> 6) & 3;
+        pens[1] = (i >> 4) & 3;
+        pens[2] = (i >> 2) & 3;
+        pens[3] = i & 3;
+        memcpy(&gfx_expand_2bpp[i], pens, 4);
+
+        pens[0] = i >> 4;
+        pens[1] = i & 15;
+        memcpy(&gfx_expand_4bpp[i], pens, 2);
+    }
+
+    initialized = 1;
+}
+
+/***************************************************************************
+ * Elements
+ ***************************************************************************/
+
+gfx_element_t* gfx_element_create(int width, int height, u32 total, int planes, int flags) {
+    gfx_element_t* gfx;
+    int bpp = (planes <= 1) ? 1 : (planes == 2) ? 2 : 4;
+    u32 size, code;
+
+    if (planes > 4 || width * bpp > 64 || (width * bpp) & 7 || height > MAX_GFX_SIZE) {
+        printf("ERROR: Unsupported gfx layout %dx%d, %d planes\n", width, height, planes);
+        return NULL;
+    }
+
+    gfx_expand_init();
+
+    gfx = (gfx_element_t*)osd_calloc_tagged(1, sizeof(gfx_element_t), OSD_MEM_VIDEO);
+    if (!gfx) {
+        return NULL;
+    }
+
+    gfx->width = width;
+    gfx->height = height;
+    gfx->total = total;
+    gfx->bpp = bpp;
+    gfx->row_bytes = width * bpp / 8;
+    gfx->element_bytes = height * gfx->row_bytes;
+
+    size = total * gfx->element_bytes;
+    gfx->data = (u8*)osd_memalign_tagged(32, size, OSD_MEM_VIDEO);
+    if (gfx->data && (flags & GFX_DECODE_FLIPX)) {
+        gfx->data_flipx = (u8*)osd_memalign_tagged(32, size, OSD_MEM_VIDEO);
+    }
+    gfx->pen_usage = (u32*)osd_malloc_tagged(total * sizeof(u32), OSD_MEM_VIDEO);
+    if (!gfx->data || ((flags & GFX_DECODE_FLIPX) && !gfx->data_flipx) || !gfx->pen_usage) {
+        printf("ERROR: Failed to allocate %u bytes of gfx\n", size);
+        gfx_element_free(gfx);
+        return NULL;
+    }
+
+    memset(gfx->data, 0, size);
+    if (gfx->data_flipx) {
+        memset(gfx->data_flipx, 0, size);
+    }
+
+    /* Cleared elements hold only pen 0 */
+    for (code = 0; code < total; code++) {
+        gfx->pen_usage[code] = 1;
+    }
+
+    return gfx;
+}
+
+void gfx_element_free(gfx_element_t* gfx) {
+    if (!gfx) {
+        return;
+    }
+
+    if (gfx->data) {
+        osd_free(gfx->data);
+    }
+    if (gfx->data_flipx) {
+        osd_free(gfx->data_flipx);
+    }
+    if (gfx->pen_usage) {
+        osd_free(gfx->pen_usage);
+    }
+
+    osd_free(gfx);
+}
+
+/* Pack one row of pens, MSB first */
+static void gfx_pack_row(const gfx_element_t* gfx, const u8* pens, int step, u8* dst) {
+    int mask = (1 << gfx->bpp) - 1;
+    int x, bit;
+
+    memset(dst, 0, gfx->row_bytes);
+    for (x = 0; x < gfx->width; x++) {
+        bit = x * gfx->bpp;
+        dst[bit >> 3] |= (pens[x * step] & mask) << (8 - gfx->bpp - (bit & 7));
+    }
+}
+
+void gfx_element_set(gfx_element_t* gfx, u32 code, const u8* pens) {
+    u32 offset = (code % gfx->total) * gfx->element_bytes;
+    u32 usage = 0;
+    int mask = (1 << gfx->bpp) - 1;
+    int i, y;
+
+    for (i = 0; i < gfx->width * gfx->height; i++) {
+        usage |= 1 << (pens[i] & mask);
+    }
+    gfx->pen_usage[code % gfx->total] = usage;
+
+    for (y = 0; y < gfx->height; y++) {
+        const u8* row = pens + y * gfx->width;
+
+        gfx_pack_row(gfx, row, 1, gfx->data + offset + y * gfx->row_bytes);
+        if (gfx->data_flipx) {
+            gfx_pack_row(gfx, row + gfx->width - 1, -1,
+                         gfx->data_flipx + offset + y * gfx->row_bytes);
+        }
+    }
+}
+
+void gfx_element_expand_row(const gfx_element_t* gfx, u32 code, int y, int flipx, u8* dst) {
+    const u8* row = gfx_element_row(gfx, code, y, flipx);
+    int i, x;
+    u8 t;
+
+    switch (gfx->bpp) {
+        case 2:
+            for (i = 0; i < gfx->row_bytes; i++) {
+                memcpy(dst + i * 4, &gfx_expand_2bpp[row[i]], 4);
+            }
+            break;
+
+        case 4:
+            for (i = 0; i < gfx->row_bytes; i++) {
+                memcpy(dst + i * 2, &gfx_expand_4bpp[row[i]], 2);
+            }
+            break;
+
+        default:
+            for (x = 0; x < gfx->width; x++) {
+                dst[x] = (row[x >> 3] >> (7 - (x & 7))) & 1;
+            }
+            break;
+    }
+
+    /* No mirrored copy for this element: reverse in place */
+    if (flipx && !gfx->data_flipx) {
+        for (x = 0; x < gfx->width / 2; x++) {
+            t = dst[x];
+            dst[x] = dst[gfx->width - 1 - x];
+            dst[gfx->width - 1 - x] = t;
+        }
+    }
+}
+
+/***************************************************************************
+ * Decoding
+ ***************************************************************************/
+
+static INLINE int gfx_readbit(const u8* src, u32 bitnum) {
+    return src[bitnum >> 3] & (0x80 >> (bitnum & 7));
+}
+
+gfx_element_t* gfx_decode_data(const u8* src, u32 length, const gfx_layout* layout, int flags) {
+    gfx_element_t* gfx;
+    u8 pens[MAX_GFX_SIZE * MAX_GFX_SIZE];
+    u32 code, offset, last;
+    int plane, x, y, bit;
+
+    if (layout->width > MAX_GFX_SIZE || layout->height > MAX_GFX_SIZE ||
+        layout->planes > MAX_GFX_PLANES) {
+        printf("ERROR: Bad gfx layout\n");
+        return NULL;
+    }
+
+    /* Highest bit the layout touches must lie inside the data */
+    last = (layout->total - 1) * layout->charincrement;
+    bit = 0;
+    for (plane = 0; plane < layout->planes; plane++) {
+        bit = MAX(bit, (int)layout->planeoffset[plane]);
+    }
+    for (x = 0; x < layout->width; x++) {
+        for (y = 0; y < layout->height; y++) {
+            if (last + bit + layout->xoffset[x] + layout->yoffset[y] >= length * 8) {
+                printf("ERROR: Gfx layout exceeds %u bytes of data\n", length);
+                return NULL;
+            }
+        }
+    }
+
+    gfx = gfx_element_create(layout->width, layout->height, layout->total, layout->planes, flags);
+    if (!gfx) {
+        return NULL;
+    }
+
+    for (code = 0; code < layout->total; code++) {
+        offset = code * layout->charincrement;
+        memset(pens, 0, sizeof(pens));
+
+        for (plane = 0; plane < layout->planes; plane++) {
+            bit = 1 << (layout->planes - 1 - plane);
+            for (y = 0; y < layout->height; y++) {
+                u32 yoffs = offset + layout->planeoffset[plane] + layout->yoffset[y];
+                for (x = 0; x < layout->width; x++) {
+                    if (gfx_readbit(src, yoffs + layout->xoffset[x])) {
+                        pens[y * layout->width + x] |= bit;
+                    }
+                }
+            }
+        }
+
+        gfx_element_set(gfx, code, pens);
+    }
+
+    return gfx;
+}
+
+gfx_element_t* gfx_decode(const gfx_decode_info* info) {
+    const u8* base = memory_region_get_base(info->memory_region);
+    u32 size = memory_region_get_size(info->memory_region);
+    gfx_element_t* gfx;
+
+    if (!base || info->start >= size) {
+        return NULL;
+    }
+
+    gfx = gfx_decode_data(base + info->start, size - info->start, info->layout, info->flags);
+    if (gfx) {
+        u32 code, usage[3] = { 0, 0, 0 };
+
+        for (code = 0; code < gfx->total; code++) {
+            usage[gfx_element_usage(gfx, code)]++;
+        }
+
+        gfx->color_base = info->color_codes_start;
+        gfx->total_colors = info->total_color_codes;
+        printf("Decoded %u %dx%d gfx (%d bytes packed%s; %u blank, %u opaque)\n",
+               gfx->total, gfx->width, gfx->height, gfx->total * gfx->element_bytes,
+               gfx->data_flipx ? ", x2 mirrored" : "",
+               usage[GFX_USAGE_BLANK], usage[GFX_USAGE_OPAQUE]);
+    }
+
+    return gfx;
+}
@@ -0,0 +1,113 @@
+/***************************************************************************
+ * Graphics Decoding for GameCube
+ *
+ * Decodes tile and sprite ROMs described by MAME-style GfxLayouts once at
+ * load time into packed rows the blitters read directly. Each row holds
+ * all pixels of one line, MSB first, at the element's bit depth; a byte
+ * of packed pixels is widened with a 256-entry lookup table.
+ ***************************************************************************/
+
+#ifndef GFX_DECODE_H
+#define GFX_DECODE_H
+
+#include "../mame2003/osd_gc.h"
+
+/***************************************************************************
+ * Layouts
+ ***************************************************************************/
+
+#define MAX_GFX_PLANES      8
+#define MAX_GFX_SIZE        32
+#define MAX_GFX_ELEMENTS    8
+
+/* Offsets are in bits from the start of an element; bit 0 is the MSB of
+ * the first byte. Plane 0 supplies the highest bit of each pen. */
+typedef struct {
+    u16 width, height;                /* Pixel size of one element */
+    u32 total;                        /* Number of elements */
+    u16 planes;                       /* Bits per pixel */
+    u32 planeoffset[MAX_GFX_PLANES];
+    u32 xoffset[MAX_GFX_SIZE];
+    u32 yoffset[MAX_GFX_SIZE];
+    u32 charincrement;                /* Bits from one element to the next */
+} gfx_layout;
+
+/* Decode flags */
+#define GFX_DECODE_FLIPX    0x01      /* Also build horizontally mirrored rows */
+
+typedef struct {
+    int memory_region;                /* -1 terminates a list */
+    u32 start;                        /* Byte offset into the region */
+    const gfx_layout* layout;
+    int color_codes_start;
+    int total_color_codes;
+    int flags;                        /* GFX_DECODE_xxx */
+} gfx_decode_info;
+
+/***************************************************************************
+ * Decoded Elements
+ ***************************************************************************/
+
+typedef struct {
+    int width, height;
+    u32 total;
+    int bpp;                          /* 1, 2 or 4 (planes rounded up) */
+    int row_bytes;                    /* width * bpp / 8, at most 8 */
+    int element_bytes;                /* height * row_bytes */
+
+    u8* data;                         /* Packed rows, element by element */
+    u8* data_flipx;                   /* Mirrored rows, or NULL */
+    u32* pen_usage;                   /* Per element: bit n set if pen n is used */
+
+    int color_base;
+    int total_colors;
+} gfx_element_t;
+
+/* Pen usage classes - what drawing an element with pen 0 transparent
+ * actually needs */
+#define GFX_USAGE_BLANK     0         /* Only pen 0: nothing to draw */
+#define GFX_USAGE_OPAQUE    1         /* Never pen 0: a plain copy */
+#define GFX_USAGE_MIXED     2         /* Needs the transparency mask */
+
+/* Creation */
+gfx_element_t* gfx_element_create(int width, int height, u32 total, int planes, int flags);
+void gfx_element_free(gfx_element_t* gfx);
+
+/* Decode one layout from a ROM region; NULL if the region is missing */
+gfx_element_t* gfx_decode(const gfx_decode_info* info);
+
+/* Decode one layout from raw data */
+gfx_element_t* gfx_decode_data(const u8* src, u32 length, const gfx_layout* layout, int flags);
+
+/* Store one element from 8bpp pens (also updates the mirrored copy) */
+void gfx_element_set(gfx_element_t* gfx, u32 code, const u8* pens);
+
+/* Packed pixels to 8bpp pens: 4 pens per byte at 2bpp, 2 at 4bpp */
+extern u32 gfx_expand_2bpp[256];
+extern u16 gfx_expand_4bpp[256];
+void gfx_expand_init(void);
+
+/* Expand one row to 8bpp pens */
+void gfx_element_expand_row(const gfx_element_t* gfx, u32 code, int y, int flipx, u8* dst);
+
+static INLINE const u8* gfx_element_row(const gfx_element_t* gfx, u32 code, int y, int flipx) {
+    const u8* base = (flipx && gfx->data_flipx) ? gfx->data_flipx : gfx->data;
+    return base + (code % gfx->total) * gfx->element_bytes + y * gfx->row_bytes;
+}
+
+static INLINE u8 gfx_element_pixel(const gfx_element_t* gfx, u32 code, int x, int y) {
+    const u8* row = gfx_element_row(gfx, code, y, 0);
+    int bit = x * gfx->bpp;
+    return (row[bit >> 3] >> (8 - gfx->bpp - (bit & 7))) & ((1 << gfx->bpp) - 1);
+}
+
+static INLINE int gfx_element_usage(const gfx_element_t* gfx, u32 code) {
+    u32 usage = gfx->pen_usage[code % gfx->total];
+
+    if (!(usage & ~1)) {
+        return GFX_USAGE_BLANK;
+    }
+    return (usage & 1) ? GFX_USAGE_MIXED : GFX_USAGE_OPAQUE;
+}
+
+#endif /* GFX_DECODE_H */
@@ -0,0 +1,413 @@
+/***************************************************************************
+ * GX Texture Encoding Implementation
+ ***************************************************************************/
+
+#include "gxtex.h"
+#include <stdio.h>
+#include <string.h>
+
+#ifdef __powerpc__
+#include <gccore.h>
+
+/* Texels are stored big-endian, the CPU's own order */
+#define GXTEX_BE16(v)           ((u16)(v))
+#else
+#define GXTEX_BE16(v)           ((u16)((((v) >> 8) & 0xFF) | (((v) & 0xFF) << 8)))
+#endif
+
+/***************************************************************************
+ * Texel Conversion
+ ***************************************************************************/
+
+u16 gxtex_rgb565(u32 rgba) {
+    return ((rgba >> 16) & 0xF800) | ((rgba >> 13) & 0x07E0) | ((rgba >> 11) & 0x001F);
+}
+
+u16 gxtex_rgb5a3(u32 rgba) {
+    u32 a = rgba & 0xFF;
+
+    if (a >= 0xE0) {
+        return 0x8000 | ((rgba >> 17) & 0x7C00) | ((rgba >> 14) & 0x03E0) | ((rgba >> 11) & 0x001F);
+    }
+    return ((a >> 5) << 12) | ((rgba >> 20) & 0x0F00) | ((rgba >> 16) & 0x00F0) | ((rgba >> 12) & 0x000F);
+}
+
+u8 gxtex_i8(u32 rgba) {
+    u32 r = rgba >> 24, g = (rgba >> 16) & 0xFF, b = (rgba >> 8) & 0xFF;
+
+    return (r * 77 + g * 150 + b * 29) >> 8;
+}
+
+/***************************************************************************
+ * Textures
+ ***************************************************************************/
+
+gxtex_t* gxtex_create(int width, int height, int format) {
+    gxtex_t* tex;
+
+    if (width <= 0 || height <= 0 || format < GXTEX_RGB565 || format > GXTEX_CI8) {
+        printf("ERROR: Unsupported GX texture %dx%d format %d\n", width, height, format);
+        return NULL;
+    }
+
+    tex = (gxtex_t*)osd_malloc_tagged(sizeof(gxtex_t), OSD_MEM_VIDEO);
+    if (!tex) {
+        return NULL;
+    }
+    memset(tex, 0, sizeof(gxtex_t));
+
+    tex->format = format;
+    tex->width = width;
+    tex->height = height;
+    tex->texel_bytes = (format == GXTEX_RGB565 || format == GXTEX_RGB5A3) ? 2 : 1;
+    tex->tile_width = GXTEX_TILE_BYTES / GXTEX_TILE_HEIGHT / tex->texel_bytes;
+    tex->tiles_x = (width + tex->tile_width - 1) / tex->tile_width;
+    tex->tiles_y = (height + GXTEX_TILE_HEIGHT - 1) / GXTEX_TILE_HEIGHT;
+    tex->size = tex->tiles_x * tex->tiles_y * GXTEX_TILE_BYTES;
+
+    tex->data = (u8*)osd_memalign_tagged(32, tex->size, OSD_MEM_VIDEO);
+    if (format == GXTEX_CI8) {
+        tex->tlut = (u16*)osd_memalign_tagged(32, PALETTE_MAX_PENS * sizeof(u16), OSD_MEM_VIDEO);
+        tex->tlut_entries = PALETTE_MAX_PENS;
+    }
+    if (!tex->data || (format == GXTEX_CI8 && !tex->tlut)) {
+        printf("ERROR: Failed to allocate GX texture\n");
+        gxtex_free(tex);
+        return NULL;
+    }
+
+    memset(tex->data, 0, tex->size);
+    if (tex->tlut) {
+        memset(tex->tlut, 0, PALETTE_MAX_PENS * sizeof(u16));
+        for (int pen = 0; pen < PALETTE_MAX_PENS; pen++) {
+            tex->pen_texel[pen] = pen;
+        }
+    }
+    return tex;
+}
+
+void gxtex_free(gxtex_t* tex) {
+    if (tex) {
+        osd_free(tex->data);
+        osd_free(tex->tlut);
+        osd_free(tex);
+    }
+}
+
+int gxtex_set_palette(gxtex_t* tex, const u32* pen_rgba, int count) {
+    int changed = 0;
+
+    count = MIN(count, PALETTE_MAX_PENS);
+    for (int pen = 0; pen < count; pen++) {
+        u16 texel;
+
+        switch (tex->format) {
+            case GXTEX_RGB565: texel = GXTEX_BE16(gxtex_rgb565(pen_rgba[pen])); break;
+            case GXTEX_RGB5A3: texel = GXTEX_BE16(gxtex_rgb5a3(pen_rgba[pen])); break;
+            case GXTEX_I8:     texel = gxtex_i8(pen_rgba[pen]); break;
+            default:
+                /* CI8: the pens stay, their colours go to the TLUT */
+                texel = GXTEX_BE16(gxtex_rgb5a3(pen_rgba[pen]));
+                if (tex->tlut[pen] != texel) {
+                    tex->tlut[pen] = texel;
+                    tex->tlut_dirty = 1;
+                    changed++;
+                }
+                continue;
+        }
+
+        if (tex->pen_texel[pen] != texel) {
+            tex->pen_texel[pen] = texel;
+            changed++;
+        }
+    }
+    return changed;
+}
+
+/***************************************************************************
+ * Encoding
+ *
+ * Tiles are written whole, a row of texels at a time; 'row' points at
+ * the first source pixel of the tile's row and 'texel' converts one
+ * source pixel. Rows and columns past the image are zero.
+ ***************************************************************************/
+
+#define GXTEX_ENCODE(texel_t, src_t, row, texel)                                    \
+    for (int ty = ty0; ty <= ty1; ty++) {                                           \
+        for (int tx = tx0; tx <= tx1; tx++) {                                       \
+            texel_t* d = (texel_t*)(tex->data + (ty * tex->tiles_x + tx) * GXTEX_TILE_BYTES); \
+            int x0 = tx * tw;                                                       \
+            int n = MIN(tw, tex->width - x0);                                       \
+                                                                                    \
+            for (int r = 0; r < GXTEX_TILE_HEIGHT; r++, d += tw) {                  \
+                int y = ty * GXTEX_TILE_HEIGHT + r;                                 \
+                const src_t* s;                                                     \
+                                                                                    \
+                if (y >= tex->height) {                                             \
+                    memset(d, 0, tw * sizeof(texel_t));                             \
+                    continue;                                                       \
+                }                                                                   \
+                s = (row) + x0;                                                     \
+                for (int c = 0; c < n; c++) {                                       \
+                    d[c] = texel(s[c]);                                             \
+                }                                                                   \
+                for (int c = n; c < tw; c++) {                                      \
+                    d[c] = 0;                                                       \
+                }                                                                   \
+            }                                                                       \
+        }                                                                           \
+    }
+
+#define GXTEX_PEN(v)            (tex->pen_texel[(v) & (PALETTE_MAX_PENS - 1)])
+#define GXTEX_RGB565_BE(v)      GXTEX_BE16(gxtex_rgb565(v))
+#define GXTEX_RGB5A3_BE(v)      GXTEX_BE16(gxtex_rgb5a3(v))
+
+/* Tiles covering 'rect' clipped to the image, and the bytes they span;
+ * 0 if nothing is left */
+static int gxtex_tile_range(gxtex_t* tex, const rectangle* rect,
+                            int* tx0, int* tx1, int* ty0, int* ty1) {
+    int x0 = 0, x1 = tex->width - 1, y0 = 0, y1 = tex->height - 1;
+
+    if (rect) {
+        x0 = MAX(x0, rect->min_x);
+        x1 = MIN(x1, rect->max_x);
+        y0 = MAX(y0, rect->min_y);
+        y1 = MIN(y1, rect->max_y);
+    }
+
+    tex->flush_offset = 0;
+    tex->flush_size = 0;
+    if (x0 > x1 || y0 > y1) {
+        return 0;
+    }
+
+    *tx0 = x0 / tex->tile_width;
+    *tx1 = x1 / tex->tile_width;
+    *ty0 = y0 / GXTEX_TILE_HEIGHT;
+    *ty1 = y1 / GXTEX_TILE_HEIGHT;
+
+    tex->flush_offset = (*ty0 * tex->tiles_x + *tx0) * GXTEX_TILE_BYTES;
+    tex->flush_size = (*ty1 * tex->tiles_x + *tx1 + 1) * GXTEX_TILE_BYTES - tex->flush_offset;
+    return 1;
+}
+
+int gxtex_encode_bitmap(gxtex_t* tex, const mame_bitmap* src, const rectangle* rect) {
+    int tw = tex->tile_width;
+    int tx0, tx1, ty0, ty1;
+
+    if (src->width != tex->width || src->height != tex->height) {
+        printf("ERROR: Bitmap %dx%d does not fit a %dx%d texture\n",
+               src->width, src->height, tex->width, tex->height);
+        return -1;
+    }
+    if (!gxtex_tile_range(tex, rect, &tx0, &tx1, &ty0, &ty1)) {
+        return 0;
+    }
+
+    if (src->depth == 8) {
+        if (tex->texel_bytes == 2) {
+            GXTEX_ENCODE(u16, u8, (const u8*)src->line[y], GXTEX_PEN)
+        } else {
+            GXTEX_ENCODE(u8, u8, (const u8*)src->line[y], (u8)GXTEX_PEN)
+        }
+    } else {
+        if (tex->texel_bytes == 2) {
+            GXTEX_ENCODE(u16, u16, (const u16*)src->line[y], GXTEX_PEN)
+        } else {
+            GXTEX_ENCODE(u8, u16, (const u16*)src->line[y], (u8)GXTEX_PEN)
+        }
+    }
+    return 0;
+}
+
+int gxtex_encode_rgba(gxtex_t* tex, const u32* src, int pitch, const rectangle* rect) {
+    int tw = tex->tile_width;
+    int tx0, tx1, ty0, ty1;
+
+    if (tex->format == GXTEX_CI8) {
+        printf("ERROR: CI8 textures are encoded from pens\n");
+        return -1;
+    }
+    if (!gxtex_tile_range(tex, rect, &tx0, &tx1, &ty0, &ty1)) {
+        return 0;
+    }
+
+    switch (tex->format) {
+        case GXTEX_RGB565:
+            GXTEX_ENCODE(u16, u32, src + y * pitch, GXTEX_RGB565_BE)
+            break;
+        case GXTEX_RGB5A3:
+            GXTEX_ENCODE(u16, u32, src + y * pitch, GXTEX_RGB5A3_BE)
+            break;
+        default:
+            GXTEX_ENCODE(u8, u32, src + y * pitch, gxtex_i8)
+            break;
+    }
+    return 0;
+}
+
+void gxtex_flush(gxtex_t* tex) {
+#ifdef __powerpc__
+    if (tex->flush_size) {
+        DCFlushRange(tex->data + tex->flush_offset, tex->flush_size);
+    }
+    if (tex->tlut && tex->tlut_dirty) {
+        DCFlushRange(tex->tlut, tex->tlut_entries * sizeof(u16));
+    }
+#endif
+    tex->flush_size = 0;
+    tex->tlut_dirty = 0;
+}
+
+/***************************************************************************
+ * Self Test
+ ***************************************************************************/
+
+/* Source pixel (y * width + x) of each texel, in memory order: an 8x8
+ * image of 4x4 tiles, and a 16x8 image of 8x4 tiles */
+static const u8 gxtex_order_16[64] = {
+      0,   1,   2,   3,   8,   9,  10,  11,  16,  17,  18,  19,  24,  25,  26,  27,
+      4,   5,   6,   7,  12,  13,  14,  15,  20,  21,  22,  23,  28,  29,  30,  31,
+     32,  33,  34,  35,  40,  41,  42,  43,  48,  49,  50,  51,  56,  57,  58,  59,
+     36,  37,  38,  39,  44,  45,  46,  47,  52,  53,  54,  55,  60,  61,  62,  63
+};
+
+static const u8 gxtex_order_8[128] = {
+      0,   1,   2,   3,   4,   5,   6,   7,  16,  17,  18,  19,  20,  21,  22,  23,
+     32,  33,  34,  35,  36,  37,  38,  39,  48,  49,  50,  51,  52,  53,  54,  55,
+      8,   9,  10,  11,  12,  13,  14,  15,  24,  25,  26,  27,  28,  29,  30,  31,
+     40,  41,  42,  43,  44,  45,  46,  47,  56,  57,  58,  59,  60,  61,  62,  63,
+     64,  65,  66,  67,  68,  69,  70,  71,  80,  81,  82,  83,  84,  85,  86,  87,
+     96,  97,  98,  99, 100, 101, 102, 103, 112, 113, 114, 115, 116, 117, 118, 119,
+     72,  73,  74,  75,  76,  77,  78,  79,  88,  89,  90,  91,  92,  93,  94,  95,
+    104, 105, 106, 107, 108, 109, 110, 111, 120, 121, 122, 123, 124, 125, 126, 127
+};
+
+/* Texel at a byte offset, as a host value */
+static u32 gxtex_read(const gxtex_t* tex, u32 offset) {
+    const u8* p = tex->data + offset;
+
+    return tex->texel_bytes == 2 ? (p[0] << 8) | p[1] : p[0];
+}
+
+/* What pen 'pen' should encode to, as a host value */
+static u32 gxtex_expect(const gxtex_t* tex, const u32* pen_rgba, int pen) {
+    switch (tex->format) {
+        case GXTEX_RGB565: return gxtex_rgb565(pen_rgba[pen]);
+        case GXTEX_RGB5A3: return gxtex_rgb5a3(pen_rgba[pen]);
+        case GXTEX_I8:     return gxtex_i8(pen_rgba[pen]);
+        default:           return pen;
+    }
+}
+
+/* Every texel against the bitmap through the reference addressing */
+static int gxtex_check_image(const gxtex_t* tex, const mame_bitmap* src, const u32* pen_rgba) {
+    int errors = 0;
+
+    for (int y = 0; y < tex->tiles_y * GXTEX_TILE_HEIGHT; y++) {
+        for (int x = 0; x < tex->tiles_x * tex->tile_width; x++) {
+            u32 want = (x < src->width && y < src->height) ?
+                       gxtex_expect(tex, pen_rgba, read_pixel(src, x, y)) : 0;
+
+            if (gxtex_read(tex, gxtex_texel_offset(tex, x, y)) != want) {
+                errors++;
+            }
+        }
+    }
+    return errors;
+}
+
+int gxtex_self_test(void) {
+    static const int formats[] = { GXTEX_RGB565, GXTEX_RGB5A3, GXTEX_I8, GXTEX_CI8 };
+    u32 pen_rgba[PALETTE_MAX_PENS];
+    u32 seed = 0x13579BDF;
+    int errors = 0;
+    int checks = 0;
+
+    /* Known texels */
+    errors += gxtex_rgb565(0xFF8040FF) != 0xFC08;
+    errors += gxtex_rgb5a3(0xFF8040FF) != 0xFE08;
+    errors += gxtex_rgb5a3(0xFF804080) != 0x4F84;
+    errors += gxtex_i8(0xFFFFFFFF) != 0xFF;
+    checks += 4;
+
+    /* Pens 0..63 have distinct 565 colours; the rest are random */
+    for (int pen = 0; pen < PALETTE_MAX_PENS; pen++) {
+        seed = seed * 1103515245 + 12345;
+        pen_rgba[pen] = pen < 64 ? ((pen & 31) << 27) | ((pen >> 5) << 18) | 0xFF
+                                 : (seed & 0xFFFFFF00) | ((seed >> 4) & 0xFF);
+    }
+
+    /* Tile order against the reference layouts */
+    for (int n = 0; n < 2; n++) {
+        int wide = (n == 1);
+        gxtex_t* tex = gxtex_create(wide ? 16 : 8, 8, wide ? GXTEX_CI8 : GXTEX_RGB565);
+        mame_bitmap* bitmap = bitmap_alloc_depth(wide ? 16 : 8, 8, 8);
+
+        if (!tex || !bitmap) {
+            gxtex_free(tex);
+            bitmap_free(bitmap);
+            return -1;
+        }
+        for (int i = 0; i < bitmap->width * bitmap->height; i++) {
+            plot_pixel(bitmap, i % bitmap->width, i / bitmap->width, i);
+        }
+        gxtex_set_palette(tex, pen_rgba, PALETTE_MAX_PENS);
+        gxtex_encode_bitmap(tex, bitmap, NULL);
+
+        for (int i = 0; i < (wide ? 128 : 64); i++) {
+            int pen = wide ? gxtex_order_8[i] : gxtex_order_16[i];
+
+            errors += gxtex_read(tex, i * tex->texel_bytes) != gxtex_expect(tex, pen_rgba, pen);
+            checks++;
+        }
+        gxtex_free(tex);
+        bitmap_free(bitmap);
+    }
+
+    /* Ragged sizes, both depths: a partial encode of a changed area must
+     * leave the same texture as a full one, inside its flush range */
+    for (int n = 0; n < 8; n++) {
+        gxtex_t* tex = gxtex_create(22, 18, formats[n & 3]);
+        mame_bitmap* bitmap = bitmap_alloc_depth(22, 18, n < 4 ? 8 : 16);
+        rectangle area = { 5, 13, 3, 9 };
+
+        if (!tex || !bitmap) {
+            gxtex_free(tex);
+            bitmap_free(bitmap);
+            return -1;
+        }
+        for (int y = 0; y < 18; y++) {
+            for (int x = 0; x < 22; x++) {
+                seed = seed * 1103515245 + 12345;
+                plot_pixel(bitmap, x, y, (seed >> 16) & (PALETTE_MAX_PENS - 1));
+            }
+        }
+        gxtex_set_palette(tex, pen_rgba, PALETTE_MAX_PENS);
+        gxtex_encode_bitmap(tex, bitmap, NULL);
+        errors += gxtex_check_image(tex, bitmap, pen_rgba);
+
+        for (int y = area.min_y; y <= area.max_y; y++) {
+            for (int x = area.min_x; x <= area.max_x; x++) {
+                plot_pixel(bitmap, x, y, (x * 7 + y) & (PALETTE_MAX_PENS - 1));
+            }
+        }
+        gxtex_encode_bitmap(tex, bitmap, &area);
+        errors += gxtex_check_image(tex, bitmap, pen_rgba);
+        errors += tex->flush_offset > gxtex_texel_offset(tex, area.min_x, area.min_y) ||
+                  tex->flush_offset + tex->flush_size <
+                  gxtex_texel_offset(tex, area.max_x, area.max_y) + tex->texel_bytes ||
+                  (tex->flush_offset & 31) || (tex->flush_size & 31);
+        checks += 2 * tex->tiles_x * tex->tiles_y * 32 / tex->texel_bytes + 1;
+
+        gxtex_free(tex);
+        bitmap_free(bitmap);
+    }
+
+    if (errors) {
+        printf("ERROR: GX texture encoder failed %d of %d checks\n", errors, checks);
+        return -1;
+    }
+    printf("GX texture encoder: %d checks passed\n", checks);
+    return 0;
+}
@@ -0,0 +1,101 @@
+/***************************************************************************
+ * GX Texture Encoding for GameCube
+ *
+ * Converts the frame bitmap (pens) or an RGBA image into the tiled
+ * layouts GX samples from. Every format is stored as 32-byte tiles in
+ * row-major tile order: 4x4 texels for the 16-bit formats (RGB565,
+ * RGB5A3), 8x4 for the 8-bit ones (I8, CI8), each tile's texels in
+ * row-major order and big-endian. Pens go through a per-pen texel table
+ * built from the palette; for CI8 the pens are the texels and the
+ * palette becomes the TLUT, so colour changes never re-encode the image.
+ *
+ * Encoding can be limited to a rectangle, widened to whole tiles; the
+ * byte range it touched is kept for the cache flush before GX reads it.
+ * Everything but the flush is plain C and runs on the host.
+ ***************************************************************************/
+
+#ifndef GXTEX_H
+#define GXTEX_H
+
+#include "../mame2003/osd_gc.h"
+#include "bitmap.h"
+#include "palette.h"
+
+/***************************************************************************
+ * Configuration
+ ***************************************************************************/
+
+/* Texture formats */
+#define GXTEX_RGB565            0
+#define GXTEX_RGB5A3            1   /* Opaque 555, or 4443 with alpha */
+#define GXTEX_I8                2   /* Luminance of the colour */
+#define GXTEX_CI8               3   /* Pens, through an RGB5A3 TLUT */
+
+#define GXTEX_TILE_BYTES        32
+#define GXTEX_TILE_HEIGHT       4
+
+typedef struct {
+    int format;
+    int width, height;        /* Texels */
+    int tile_width;           /* 4 for 16-bit texels, 8 for 8-bit */
+    int texel_bytes;
+    int tiles_x, tiles_y;
+
+    u8* data;                 /* 32-byte aligned tiles */
+    u32 size;
+
+    /* Pen -> texel in the texture's format, stored in texture byte order
+     * (CI8: the pen itself) */
+    u16 pen_texel[PALETTE_MAX_PENS];
+
+    /* CI8 only: RGB5A3 colour of each pen, big-endian, 32-byte aligned */
+    u16* tlut;
+    int tlut_entries;
+    int tlut_dirty;
+
+    /* Bytes written by the last encode, for the flush */
+    u32 flush_offset;
+    u32 flush_size;
+} gxtex_t;
+
+/***************************************************************************
+ * Functions
+ ***************************************************************************/
+
+/* Texture for a width x height image; NULL on failure */
+gxtex_t* gxtex_create(int width, int height, int format);
+void gxtex_free(gxtex_t* tex);
+
+/* Texels of the first 'count' pens from their RGBA words (e.g. the
+ * palette's pen_rgba after palette_update); returns how many changed.
+ * Changes to RGB565/RGB5A3/I8 textures take effect at the next encode of
+ * the tiles using those pens; CI8 textures only reload the TLUT. */
+int  gxtex_set_palette(gxtex_t* tex, const u32* pen_rgba, int count);
+
+/* Encode the tiles covering 'rect' (NULL = everything) from a pen bitmap
+ * of the texture's size, or from RGBA words (pitch in words; not for
+ * CI8). Texels outside the image are 0. Return -1 on a bad source. */
+int  gxtex_encode_bitmap(gxtex_t* tex, const mame_bitmap* src, const rectangle* rect);
+int  gxtex_encode_rgba(gxtex_t* tex, const u32* src, int pitch, const rectangle* rect);
+
+/* Write the last encode (and a changed TLUT) out of the data cache */
+void gxtex_flush(gxtex_t* tex);
+
+/* Byte offset of texel (x, y) in the texture */
+static INLINE u32 gxtex_texel_offset(const gxtex_t* tex, int x, int y) {
+    u32 tile = (y / GXTEX_TILE_HEIGHT) * tex->tiles_x + x / tex->tile_width;
+    u32 texel = (y % GXTEX_TILE_HEIGHT) * tex->tile_width + x % tex->tile_width;
+
+    return tile * GXTEX_TILE_BYTES + texel * tex->texel_bytes;
+}
+
+/* Texel conversions from an RGBA word, in host order */
+u16  gxtex_rgb565(u32 rgba);
+u16  gxtex_rgb5a3(u32 rgba);
+u8   gxtex_i8(u32 rgba);
+
+/* Check tile order against reference layouts and partial encodes
+ * against full ones; 0 if everything matches */
+int  gxtex_self_test(void);
+
+#endif /* GXTEX_H */
@@ -0,0 +1,198 @@
+/***************************************************************************
+ * Palette Implementation
+ ***************************************************************************/
+
+#include "palette.h"
+#include "blit.h"
+#include "../mame2003/memory.h"
+#include <stdio.h>
+#include <string.h>
+
+/***************************************************************************
+ * Initialization
+ ***************************************************************************/
+
+int palette_init(palette_t* palette, int total_colors, int color_codes, int pens_per_code) {
+    int total_pens = color_codes * pens_per_code;
+
+    memset(palette, 0, sizeof(palette_t));
+
+    /* The blitters mask pens with total_pens - 1 */
+    if (total_colors < 1 || total_colors > PALETTE_MAX_COLORS ||
+        total_pens < 1 || total_pens > PALETTE_MAX_PENS || (total_pens & (total_pens - 1))) {
+        printf("ERROR: Unsupported palette of %d colours, %d pens\n", total_colors, total_pens);
+        return -1;
+    }
+
+    palette->pen_yuy2 = (u32*)osd_malloc_tagged(total_pens * total_pens * sizeof(u32),
+                                                OSD_MEM_VIDEO);
+    if (!palette->pen_yuy2) {
+        printf("ERROR: Failed to allocate palette tables\n");
+        return -1;
+    }
+
+    palette->total_colors = total_colors;
+    palette->total_pens = total_pens;
+    palette->pens_per_code = pens_per_code;
+
+    for (int i = 0; i < total_colors; i++) {
+        palette->colors[i].a = 0xFF;
+    }
+
+    /* Every pen is built by the first update */
+    for (int pen = 0; pen < total_pens; pen++) {
+        palette->pen_color[pen] = pen % total_colors;
+        palette->dirty[pen >> 5] |= 1 << (pen & 31);
+    }
+    palette->dirty_count = total_pens;
+
+    return 0;
+}
+
+void palette_free(palette_t* palette) {
+    if (palette->pen_yuy2) {
+        osd_free(palette->pen_yuy2);
+        palette->pen_yuy2 = NULL;
+    }
+}
+
+/***************************************************************************
+ * PROM Decoding
+ ***************************************************************************/
+
+static u8 palette_channel(u8 value, const palette_channel_t* channel) {
+    int level = 0;
+
+    for (int i = 0; i < 3; i++) {
+        if (channel->weight[i] && ((value >> channel->bit[i]) & 1)) {
+            level += channel->weight[i];
+        }
+    }
+    return MIN(level, 0xFF);
+}
+
+color_t palette_decode_color(u8 value, const palette_prom_info* info) {
+    color_t color;
+
+    color.r = palette_channel(value, &info->red);
+    color.g = palette_channel(value, &info->green);
+    color.b = palette_channel(value, &info->blue);
+    color.a = 0xFF;
+    return color;
+}
+
+int palette_load_proms(palette_t* palette, const palette_prom_info* info) {
+    const u8* base = memory_region_get_base(info->memory_region);
+    u32 size = memory_region_get_size(info->memory_region);
+    int colors = MIN(info->total_colors, palette->total_colors);
+
+    if (!base || info->color_offset + colors > size ||
+        info->lookup_offset + palette->total_pens > size) {
+        return -1;
+    }
+
+    for (int i = 0; i < colors; i++) {
+        palette_set_color(palette, i, palette_decode_color(base[info->color_offset + i], info));
+    }
+
+    for (int pen = 0; pen < palette->total_pens; pen++) {
+        palette_set_pen_color(palette, pen,
+                              (base[info->lookup_offset + pen] & info->lookup_mask) % colors);
+    }
+
+    printf("Decoded %d colours, %d pens from PROMs\n", colors, palette->total_pens);
+    return 0;
+}
+
+/***************************************************************************
+ * Changes
+ ***************************************************************************/
+
+static INLINE void palette_mark_pen(palette_t* palette, int pen) {
+    if (!palette_pen_dirty(palette, pen)) {
+        palette->dirty[pen >> 5] |= 1 << (pen & 31);
+        palette->dirty_count++;
+    }
+}
+
+void palette_set_color(palette_t* palette, int color, color_t value) {
+    if (color < 0 || color >= palette->total_colors ||
+        !memcmp(&palette->colors[color], &value, sizeof(color_t))) {
+        return;
+    }
+
+    palette->colors[color] = value;
+    for (int pen = 0; pen < palette->total_pens; pen++) {
+        if (palette->pen_color[pen] == color) {
+            palette_mark_pen(palette, pen);
+        }
+    }
+}
+
+void palette_set_pen_color(palette_t* palette, int pen, int color) {
+    if (pen < 0 || pen >= palette->total_pens || color < 0 || color >= palette->total_colors ||
+        palette->pen_color[pen] == color) {
+        return;
+    }
+
+    palette->pen_color[pen] = color;
+    palette_mark_pen(palette, pen);
+}
+
+int palette_code_dirty(const palette_t* palette, int code) {
+    int first = code * palette->pens_per_code;
+
+    for (int pen = first; pen < first + palette->pens_per_code && pen < palette->total_pens; pen++) {
+        if (palette_pen_dirty(palette, pen)) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+/***************************************************************************
+ * Target Words
+ ***************************************************************************/
+
+int palette_update(palette_t* palette) {
+    int total = palette->total_pens;
+    u8 list[PALETTE_MAX_PENS];
+    int count = 0;
+
+    palette->pens_updated = 0;
+    if (!palette->dirty_count) {
+        return 0;
+    }
+
+    for (int pen = 0; pen < total; pen++) {
+        if (palette_pen_dirty(palette, pen)) {
+            color_t c = palette->colors[palette->pen_color[pen]];
+
+            palette->pen_rgba[pen] = palette_rgba_word(c);
+            palette->pen_rgb565[pen] = ((c.r >> 3) << 11) | ((c.g >> 2) << 5) | (c.b >> 3);
+            list[count++] = pen;
+        }
+    }
+
+    /* Pair words: whole rows of dirty pens, and the dirty columns of the
+     * others */
+    for (int p0 = 0; p0 < total; p0++) {
+        u32* row = palette->pen_yuy2 + p0 * total;
+        u32 rgba = palette->pen_rgba[p0];
+
+        if (palette_pen_dirty(palette, p0)) {
+            for (int p1 = 0; p1 < total; p1++) {
+                row[p1] = blit_yuy2_pair(rgba, palette->pen_rgba[p1]);
+            }
+        } else {
+            for (int i = 0; i < count; i++) {
+                row[list[i]] = blit_yuy2_pair(rgba, palette->pen_rgba[list[i]]);
+            }
+        }
+    }
+
+    memset(palette->dirty, 0, sizeof(palette->dirty));
+    palette->dirty_count = 0;
+    palette->pens_updated = count;
+    return count;
+}
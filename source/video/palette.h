@@ -0,0 +1,99 @@
+/***************************************************************************
+ * Palette for GameCube
+ *
+ * Pens are what the bitmaps hold: colour code * pens per code + pixel.
+ * Each pen looks up a colour, decoded at load time from the colour PROM
+ * through the board's resistor weights, with the lookup PROM choosing the
+ * colour of every pen. Target words for each pen (RGBA, RGB565, and YUY2
+ * for every pen pair) are kept ready; a changed colour marks only the pens
+ * that use it, and only those are rebuilt before the next frame.
+ ***************************************************************************/
+
+#ifndef PALETTE_H
+#define PALETTE_H
+
+#include "../mame2003/osd_gc.h"
+
+/***************************************************************************
+ * Configuration
+ ***************************************************************************/
+
+#define PALETTE_MAX_COLORS      256
+#define PALETTE_MAX_PENS        256     /* Pens fit in an 8bpp bitmap */
+
+typedef struct {
+    u8 r, g, b, a;
+} color_t;
+
+/* One channel of a resistor DAC: PROM bit numbers and the intensity each
+ * contributes when set; unused bits have weight 0 */
+typedef struct {
+    u8 bit[3];
+    u8 weight[3];
+} palette_channel_t;
+
+typedef struct {
+    int memory_region;                /* Usually REGION_PROMS */
+    u32 color_offset;                 /* Colour PROM: one byte per colour */
+    int total_colors;
+    u32 lookup_offset;                /* Lookup PROM: one byte per pen */
+    u8 lookup_mask;
+    palette_channel_t red, green, blue;
+} palette_prom_info;
+
+typedef struct {
+    int total_colors;
+    int total_pens;
+    int pens_per_code;                /* 4 for 2bpp graphics */
+
+    color_t colors[PALETTE_MAX_COLORS];
+    u8 pen_color[PALETTE_MAX_PENS];   /* Pen -> colour */
+
+    /* Target words, rebuilt for dirty pens by palette_update */
+    u32 pen_rgba[PALETTE_MAX_PENS];
+    u16 pen_rgb565[PALETTE_MAX_PENS];
+    u32* pen_yuy2;                    /* total_pens^2, indexed by pen pair */
+
+    /* Pens whose colour changed since the last update */
+    u32 dirty[PALETTE_MAX_PENS / 32];
+    int dirty_count;
+
+    /* Statistics */
+    u32 pens_updated;                 /* Pens rebuilt by the last update */
+} palette_t;
+
+/***************************************************************************
+ * Functions
+ ***************************************************************************/
+
+/* color_codes * pens_per_code must be a power of two, so the pens can
+ * be masked to the tables */
+int  palette_init(palette_t* palette, int total_colors, int color_codes, int pens_per_code);
+void palette_free(palette_t* palette);
+
+/* Decode colours through a resistor network */
+color_t palette_decode_color(u8 value, const palette_prom_info* info);
+
+/* Colours and pen lookup from the PROM region; -1 if it is not loaded */
+int  palette_load_proms(palette_t* palette, const palette_prom_info* info);
+
+/* Runtime palette RAM */
+void palette_set_color(palette_t* palette, int color, color_t value);
+void palette_set_pen_color(palette_t* palette, int pen, int color);
+
+/* Rebuild the target words of dirty pens; returns how many */
+int  palette_update(palette_t* palette);
+
+/* Did any pen of a colour code change since the last update? For
+ * callers with colour-resolved tables of their own. */
+int  palette_code_dirty(const palette_t* palette, int code);
+
+static INLINE int palette_pen_dirty(const palette_t* palette, int pen) {
+    return (palette->dirty[pen >> 5] >> (pen & 31)) & 1;
+}
+
+static INLINE u32 palette_rgba_word(color_t color) {
+    return (color.r << 24) | (color.g << 16) | (color.b << 8) | color.a;
+}
+
+#endif /* PALETTE_H */
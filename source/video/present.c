@@ -0,0 +1,277 @@
+/***************************************************************************
+ * Frame Presentation Implementation
+ ***************************************************************************/
+
+#include "present.h"
+#include <stdio.h>
+#include <string.h>
+
+#ifdef __powerpc__
+#include <gccore.h>
+
+/* The retrace callback runs in interrupt context */
+#define PRESENT_LOCK(level)     _CPU_ISR_Disable(level)
+#define PRESENT_UNLOCK(level)   _CPU_ISR_Restore(level)
+#else
+#define PRESENT_LOCK(level)     ((level) = 0)
+#define PRESENT_UNLOCK(level)   ((void)(level))
+#endif
+
+/***************************************************************************
+ * Presenter
+ ***************************************************************************/
+
+int present_init(presenter_t* p, void** buffers, int count,
+                 present_set_next_func set_next, void* param) {
+    if (count < 2 || count > PRESENT_MAX_BUFFERS) {
+        printf("ERROR: Presenter needs 2 to %d buffers, not %d\n", PRESENT_MAX_BUFFERS, count);
+        return -1;
+    }
+
+    memset(p, 0, sizeof(presenter_t));
+    for (int i = 0; i < count; i++) {
+        p->buffers[i] = buffers[i];
+        p->state[i] = PRESENT_FREE;
+    }
+    p->count = count;
+    p->set_next = set_next;
+    p->param = param;
+    p->pending = -1;
+    p->scanout = -1;
+    for (int i = 0; i < count; i++) {
+        p->damage[i].min_x = p->damage[i].min_y = 0;
+        p->damage[i].max_x = p->damage[i].max_y = 0x7FFF;
+    }
+    return 0;
+}
+
+int present_acquire(presenter_t* p) {
+    u32 level;
+    int index = -1;
+
+    PRESENT_LOCK(level);
+    for (int i = 0; i < p->count; i++) {
+        if (p->state[i] == PRESENT_FREE) {
+            p->state[i] = PRESENT_RENDERING;
+            index = i;
+            break;
+        }
+    }
+    if (index < 0) {
+        p->stats.waits++;
+    }
+    PRESENT_UNLOCK(level);
+
+    return index;
+}
+
+void present_submit(presenter_t* p, int index) {
+    u32 level;
+
+    if (index < 0 || index >= p->count || p->state[index] != PRESENT_RENDERING) {
+        printf("ERROR: Presenting buffer %d that was not acquired\n", index);
+        return;
+    }
+
+    PRESENT_LOCK(level);
+    p->stats.submitted++;
+    if (p->pending < 0 && p->queued == 0) {
+        /* The VI latches it at the next retrace like any other flip */
+        p->state[index] = PRESENT_PENDING;
+        p->pending = index;
+        if (p->set_next) {
+            p->set_next(p->buffers[index], p->param);
+        }
+    } else {
+        p->state[index] = PRESENT_QUEUED;
+        p->queue[p->queued++] = index;
+    }
+    PRESENT_UNLOCK(level);
+}
+
+void present_cancel(presenter_t* p, int index) {
+    u32 level;
+
+    if (index < 0 || index >= p->count || p->state[index] != PRESENT_RENDERING) {
+        printf("ERROR: Cancelling buffer %d that was not acquired\n", index);
+        return;
+    }
+
+    PRESENT_LOCK(level);
+    p->state[index] = PRESENT_FREE;
+    PRESENT_UNLOCK(level);
+}
+
+void present_add_damage(presenter_t* p, int index, const rectangle* area) {
+    for (int i = 0; i < p->count; i++) {
+        if (i != index) {
+            union_rect(&p->damage[i], area);
+        }
+    }
+}
+
+void present_take_damage(presenter_t* p, int index, rectangle* area) {
+    *area = p->damage[index];
+    rect_set_empty(&p->damage[index]);
+}
+
+void present_retrace(presenter_t* p) {
+    int next;
+
+    p->stats.retraces++;
+
+    /* What was handed over at the last retrace is being scanned out now */
+    if (p->pending >= 0) {
+        if (p->scanout >= 0) {
+            p->state[p->scanout] = PRESENT_FREE;
+        }
+        p->scanout = p->pending;
+        p->state[p->scanout] = PRESENT_SCANOUT;
+        p->pending = -1;
+        p->stats.flips++;
+    } else if (p->scanout >= 0) {
+        p->stats.repeats++;
+    }
+
+    /* Oldest queued frame goes out on the next field */
+    if (p->queued > 0) {
+        next = p->queue[0];
+        for (int i = 1; i < p->queued; i++) {
+            p->queue[i - 1] = p->queue[i];
+        }
+        p->queued--;
+
+        p->state[next] = PRESENT_PENDING;
+        p->pending = next;
+        if (p->set_next) {
+            p->set_next(p->buffers[next], p->param);
+        }
+    }
+}
+
+int present_idle(const presenter_t* p) {
+    return p->queued == 0 && p->pending < 0;
+}
+
+void present_get_stats(const presenter_t* p, present_stats_t* stats) {
+    *stats = p->stats;
+}
+
+/***************************************************************************
+ * VI Backend
+ ***************************************************************************/
+
+#ifdef __powerpc__
+static presenter_t* present_vi = NULL;
+
+static void present_vi_set_next(void* buffer, void* param) {
+    VIDEO_SetNextFramebuffer(buffer);
+    VIDEO_Flush();
+}
+
+static void present_vi_retrace(u32 retrace_count) {
+    if (present_vi) {
+        present_retrace(present_vi);
+    }
+}
+
+void present_attach_vi(presenter_t* p) {
+    p->set_next = present_vi_set_next;
+    present_vi = p;
+    VIDEO_SetPostRetraceCallback(present_vi_retrace);
+}
+
+void present_detach_vi(presenter_t* p, void* buffer) {
+    VIDEO_SetPostRetraceCallback(NULL);
+    present_vi = NULL;
+
+    VIDEO_SetNextFramebuffer(buffer);
+    VIDEO_Flush();
+    VIDEO_WaitVSync();
+
+    /* Nothing of ours is on screen any more */
+    for (int i = 0; i < p->count; i++) {
+        p->state[i] = PRESENT_FREE;
+    }
+    p->queued = 0;
+    p->pending = -1;
+    p->scanout = -1;
+}
+#endif
+
+/***************************************************************************
+ * Simulation
+ ***************************************************************************/
+
+void present_simulate(int buffers, const u32* frame_us, int frames, u32 refresh_us,
+                      present_stats_t* stats) {
+    static u8 dummy[PRESENT_MAX_BUFFERS];
+    void* list[PRESENT_MAX_BUFFERS];
+    presenter_t p;
+    UINT64 now = 0, next_retrace = refresh_us, done = 0;
+    int frame = 0, index = -1;
+
+    for (int i = 0; i < PRESENT_MAX_BUFFERS; i++) {
+        list[i] = &dummy[i];
+    }
+
+    memset(stats, 0, sizeof(present_stats_t));
+    if (present_init(&p, list, buffers, NULL, NULL) != 0) {
+        return;
+    }
+
+    /* The renderer starts a frame as soon as it has a buffer and
+     * otherwise sleeps until the next retrace, like the VI loop */
+    while (frame < frames || !present_idle(&p)) {
+        if (index < 0 && frame < frames) {
+            index = present_acquire(&p);
+            if (index >= 0) {
+                done = now + frame_us[frame];
+            }
+        }
+
+        if (index >= 0 && done <= next_retrace) {
+            now = done;
+            present_submit(&p, index);
+            index = -1;
+            frame++;
+            continue;
+        }
+
+        now = next_retrace;
+        next_retrace += refresh_us;
+        present_retrace(&p);
+    }
+
+    /* Last frame onto the screen */
+    present_retrace(&p);
+    present_get_stats(&p, stats);
+}
+
+void present_benchmark(void) {
+    const u32 refresh_us = 16683;     /* 59.94 Hz */
+    const int frames = 600;
+    u32* frame_us = (u32*)osd_malloc_tagged(frames * sizeof(u32), OSD_MEM_VIDEO);
+    u32 seed = 0x12345678;
+
+    if (!frame_us) {
+        printf("ERROR: Failed to allocate present benchmark\n");
+        return;
+    }
+
+    /* Under 15 ms on average, but one frame in four runs long */
+    for (int i = 0; i < frames; i++) {
+        seed = seed * 1103515245 + 12345;
+        frame_us[i] = ((i & 3) == 3 ? 19000 : 12000) + ((seed >> 16) % 2000);
+    }
+
+    for (int buffers = 2; buffers <= PRESENT_MAX_BUFFERS; buffers++) {
+        present_stats_t stats;
+
+        present_simulate(buffers, frame_us, frames, refresh_us, &stats);
+        printf("Present x%d: %u frames over %u retraces, %u repeated, %u waits\n",
+               buffers, stats.flips, stats.retraces, stats.repeats, stats.waits);
+    }
+
+    osd_free(frame_us);
+}
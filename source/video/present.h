@@ -0,0 +1,115 @@
+/***************************************************************************
+ * Frame Presentation for GameCube
+ *
+ * Cycles two or three external framebuffers so emulation and rendering of
+ * the next frame overlap scan-out of the current one. The renderer
+ * acquires a free buffer, fills it and submits it. Flips take effect at
+ * a retrace; the VI post-retrace callback frees the buffer that just left
+ * the screen and hands the oldest queued frame to the VI. The presenter
+ * itself knows nothing about the VI: a backend sets the next buffer, so
+ * the host can drive it from simulated retraces.
+ *
+ * Each buffer also keeps the area of the frame bitmap changed since it
+ * was last drawn, so a renderer can redraw only that.
+ ***************************************************************************/
+
+#ifndef PRESENT_H
+#define PRESENT_H
+
+#include "../mame2003/osd_gc.h"
+#include "blit.h"
+
+/***************************************************************************
+ * Configuration
+ ***************************************************************************/
+
+#define PRESENT_MAX_BUFFERS     3
+#define PRESENT_BUFFERS         3   /* Buffers the front end allocates */
+
+/* Buffer states */
+#define PRESENT_FREE            0
+#define PRESENT_RENDERING       1   /* Acquired by the renderer */
+#define PRESENT_QUEUED          2   /* Submitted, waiting for a retrace */
+#define PRESENT_PENDING         3   /* Handed to the VI for the next field */
+#define PRESENT_SCANOUT         4   /* On screen */
+
+/* Backend: make 'buffer' the one shown from the next retrace on */
+typedef void (*present_set_next_func)(void* buffer, void* param);
+
+typedef struct {
+    u32 retraces;
+    u32 submitted;            /* Frames handed in by the renderer */
+    u32 flips;                /* Frames that reached the screen */
+    u32 repeats;              /* Retraces that showed the previous frame again */
+    u32 waits;                /* Acquires that found no free buffer */
+} present_stats_t;
+
+typedef struct {
+    void* buffers[PRESENT_MAX_BUFFERS];
+    int count;
+
+    present_set_next_func set_next;
+    void* param;
+
+    /* Shared with the retrace callback */
+    volatile u8 state[PRESENT_MAX_BUFFERS];
+    volatile s8 queue[PRESENT_MAX_BUFFERS];   /* Submitted frames, oldest first */
+    volatile int queued;
+    volatile int pending;     /* Buffer given to the VI, or -1 */
+    volatile int scanout;     /* Buffer on screen, or -1 */
+
+    /* Bitmap area each buffer lacks; renderer side only */
+    rectangle damage[PRESENT_MAX_BUFFERS];
+
+    present_stats_t stats;
+} presenter_t;
+
+/***************************************************************************
+ * Functions
+ ***************************************************************************/
+
+/* Two or three buffers; set_next may be NULL for a simulated display */
+int  present_init(presenter_t* p, void** buffers, int count,
+                  present_set_next_func set_next, void* param);
+
+/* Index of a free buffer to render into, or -1 if every buffer is queued
+ * or on screen (wait for a retrace and try again) */
+int  present_acquire(presenter_t* p);
+
+/* Queue a rendered buffer; with nothing else waiting it is handed to
+ * the backend at once and shown from the next retrace */
+void present_submit(presenter_t* p, int index);
+
+/* Give back an acquired buffer that turned out not to need drawing */
+void present_cancel(presenter_t* p, int index);
+
+/* A frame changed 'area': every buffer but 'index' (the one it was drawn
+ * into, or -1) now lacks it. Buffers start out lacking everything. */
+void present_add_damage(presenter_t* p, int index, const rectangle* area);
+
+/* Area buffer 'index' lacks, cleared on the assumption it is redrawn */
+void present_take_damage(presenter_t* p, int index, rectangle* area);
+
+/* Retrace handler: the pending buffer is now on screen and the next
+ * queued one is handed to the backend */
+void present_retrace(presenter_t* p);
+
+/* Nothing queued or pending: the last submitted frame is on screen */
+int  present_idle(const presenter_t* p);
+
+void present_get_stats(const presenter_t* p, present_stats_t* stats);
+
+/* GameCube only: drive the presenter from the VI post-retrace callback,
+ * and stop flipping with 'buffer' (e.g. the console) put back on screen */
+void present_attach_vi(presenter_t* p);
+void present_detach_vi(presenter_t* p, void* buffer);
+
+/* Pace 'frames' frames with the given render times (microseconds)
+ * against a simulated display refreshing every refresh_us */
+void present_simulate(int buffers, const u32* frame_us, int frames, u32 refresh_us,
+                      present_stats_t* stats);
+
+/* Compare double and triple buffering on a jittery workload */
+void present_benchmark(void);
+
+#endif /* PRESENT_H */
@@ -0,0 +1,269 @@
+/***************************************************************************
+ * Sprite Engine Implementation
+ ***************************************************************************/
+
+#include "sprite.h"
+#include <string.h>
+
+/* Store masks for a nibble of 2bpp pens: pen 0 keeps the destination */
+static blit_quad8_table sprite_mask_8;
+static blit_pair16_table sprite_mask_16;
+static int sprite_tables_ready = 0;
+
+static void sprite_init_tables(void) {
+    static const u8 pen_masks_8[4] = { 0x00, 0xFF, 0xFF, 0xFF };
+    static const u16 pen_masks_16[4] = { 0x0000, 0xFFFF, 0xFFFF, 0xFFFF };
+
+    blit_build_quad8_table(sprite_mask_8, pen_masks_8);
+    blit_build_pair16_table(sprite_mask_16, pen_masks_16);
+    sprite_tables_ready = 1;
+}
+
+/***************************************************************************
+ * List Building
+ ***************************************************************************/
+
+void sprite_list_begin(sprite_list_t* list, const rectangle* clip) {
+    if (!sprite_tables_ready) {
+        sprite_init_tables();
+    }
+
+    list->count = 0;
+    list->clip = *clip;
+    list->clip.max_y = MIN(list->clip.max_y, SPRITE_MAX_LINES - 1);
+    list->sprites_drawn = 0;
+    list->sprites_skipped = 0;
+    list->sprites_opaque = 0;
+    list->spans_drawn = 0;
+    list->max_per_line = 0;
+}
+
+int sprite_list_add(sprite_list_t* list, const gfx_element_t* gfx, u32 code,
+                    int color, int x, int y, int flags) {
+    sprite_t* s;
+
+    if (list->count >= MAX_SPRITES || !gfx) {
+        return -1;
+    }
+
+    s = &list->sprites[list->count++];
+    s->gfx = gfx;
+    s->code = code;
+    s->color = color;
+    s->flags = flags;
+    s->x = x;
+    s->y = y;
+    return 0;
+}
+
+void sprite_list_build(sprite_list_t* list) {
+    const rectangle* clip = &list->clip;
+    u16 cursor[SPRITE_MAX_LINES];
+    int usage, y, i;
+
+    memset(list->line_start, 0, sizeof(list->line_start));
+    rect_set_empty(&list->bounds);
+
+    /* Clip each sprite once and count the lines it covers */
+    for (i = 0; i < list->count; i++) {
+        sprite_t* s = &list->sprites[i];
+        int y0 = MAX(s->y, clip->min_y);
+        int y1 = MIN(s->y + s->gfx->height - 1, clip->max_y);
+
+        s->x0 = MAX(s->x, clip->min_x) - s->x;
+        s->x1 = MIN(s->x + s->gfx->width - 1, clip->max_x) - s->x;
+        if (s->x0 > s->x1 || y0 > y1 || s->gfx->bpp != 2) {
+            continue;
+        }
+
+        /* Nothing to composite: take it out of the list */
+        usage = gfx_element_usage(s->gfx, s->code);
+        if (usage == GFX_USAGE_BLANK) {
+            s->x1 = s->x0 - 1;
+            list->sprites_skipped++;
+            continue;
+        }
+        s->opaque = (usage == GFX_USAGE_OPAQUE);
+        list->sprites_opaque += s->opaque;
+
+        for (y = y0; y <= y1; y++) {
+            list->line_start[y + 1]++;
+        }
+        list->sprites_drawn++;
+
+        {
+            rectangle area = { s->x + s->x0, s->x + s->x1, y0, y1 };
+
+            union_rect(&list->bounds, &area);
+        }
+    }
+
+    /* Counts to bucket offsets */
+    for (y = 0; y < SPRITE_MAX_LINES; y++) {
+        if (list->line_start[y + 1] > list->max_per_line) {
+            list->max_per_line = list->line_start[y + 1];
+        }
+        list->line_start[y + 1] += list->line_start[y];
+        cursor[y] = list->line_start[y];
+    }
+
+    /* Fill the buckets in drawing order */
+    for (i = 0; i < list->count; i++) {
+        sprite_t* s = &list->sprites[i];
+        int y0 = MAX(s->y, clip->min_y);
+        int y1 = MIN(s->y + s->gfx->height - 1, clip->max_y);
+
+        if (s->x0 > s->x1 || y0 > y1 || s->gfx->bpp != 2) {
+            continue;
+        }
+
+        for (y = y0; y <= y1; y++) {
+            list->line_sprites[cursor[y]++] = i;
+        }
+    }
+}
+
+/***************************************************************************
+ * Compositing
+ ***************************************************************************/
+
+/* Masked composite of one packed row into 8bpp: four pixels per byte */
+static INLINE void sprite_row_2bpp_8(u8* d, const u8* src, int bytes, const blit_quad8_table quads) {
+    u32 cur, m;
+
+    for (int i = 0; i < bytes; i++) {
+        m = sprite_mask_8[src[i]];
+        memcpy(&cur, d, sizeof(u32));
+        cur = (cur & ~m) | (quads[src[i]] & m);
+        memcpy(d, &cur, sizeof(u32));
+        d += 4;
+    }
+}
+
+static INLINE void sprite_row_2bpp_16(u16* d, const u8* src, int bytes, const blit_pair16_table pairs) {
+    u32 cur, m;
+
+    for (int i = 0; i < bytes; i++) {
+        m = sprite_mask_16[src[i] >> 4];
+        memcpy(&cur, d, sizeof(u32));
+        cur = (cur & ~m) | (pairs[src[i] >> 4] & m);
+        memcpy(d, &cur, sizeof(u32));
+
+        m = sprite_mask_16[src[i] & 15];
+        memcpy(&cur, d + 2, sizeof(u32));
+        cur = (cur & ~m) | (pairs[src[i] & 15] & m);
+        memcpy(d + 2, &cur, sizeof(u32));
+        d += 4;
+    }
+}
+
+static INLINE void sprite_copy_2bpp_8(u8* d, const u8* src, int bytes, const blit_quad8_table quads) {
+    for (int i = 0; i < bytes; i++) {
+        memcpy(d, &quads[src[i]], sizeof(u32));
+        d += 4;
+    }
+}
+
+static INLINE void sprite_copy_2bpp_16(u16* d, const u8* src, int bytes, const blit_pair16_table pairs) {
+    for (int i = 0; i < bytes; i++) {
+        memcpy(d, &pairs[src[i] >> 4], sizeof(u32));
+        memcpy(d + 2, &pairs[src[i] & 15], sizeof(u32));
+        d += 4;
+    }
+}
+
+void sprite_list_draw_8(sprite_list_t* list, u8* dst, int pitch, const blit_quad8_table* colors) {
+    u8 pens[MAX_GFX_SIZE];
+
+    for (int y = list->clip.min_y; y <= list->clip.max_y; y++) {
+        u8* row_dst = dst + y * pitch;
+
+        for (int k = list->line_start[y]; k < list->line_start[y + 1]; k++) {
+            const sprite_t* s = &list->sprites[list->line_sprites[k]];
+            const gfx_element_t* gfx = s->gfx;
+            int row = y - s->y;
+            int flipx = s->flags & SPRITE_FLIPX;
+            u8* d = row_dst + s->x;
+
+            if (s->flags & SPRITE_FLIPY) {
+                row = gfx->height - 1 - row;
+            }
+
+            if (!(flipx && !gfx->data_flipx) && s->x0 == 0 && s->x1 == gfx->width - 1) {
+                const u8* src = gfx_element_row(gfx, s->code, row, flipx);
+
+                if (s->opaque) {
+                    sprite_copy_2bpp_8(d, src, gfx->row_bytes, colors[s->color]);
+                } else {
+                    sprite_row_2bpp_8(d, src, gfx->row_bytes, colors[s->color]);
+                }
+            } else {
+                /* Clipped or unmirrored data: pixel by pixel, pen values
+                 * taken from the solid quads of the table */
+                u8 value[4];
+
+                for (int p = 0; p < 4; p++) {
+                    u8 quad[4];
+
+                    memcpy(quad, &colors[s->color][p * 0x55], sizeof(u32));
+                    value[p] = quad[0];
+                }
+                gfx_element_expand_row(gfx, s->code, row, flipx, pens);
+                for (int i = s->x0; i <= s->x1; i++) {
+                    u8 m = pens[i] ? 0xFF : 0x00;
+
+                    d[i] = (d[i] & ~m) | (value[pens[i]] & m);
+                }
+            }
+
+            list->spans_drawn++;
+        }
+    }
+}
+
+void sprite_list_draw_16(sprite_list_t* list, u16* dst, int pitch, const blit_pair16_table* colors) {
+    u8 pens[MAX_GFX_SIZE];
+
+    for (int y = list->clip.min_y; y <= list->clip.max_y; y++) {
+        u16* row_dst = dst + y * pitch;
+
+        for (int k = list->line_start[y]; k < list->line_start[y + 1]; k++) {
+            const sprite_t* s = &list->sprites[list->line_sprites[k]];
+            const gfx_element_t* gfx = s->gfx;
+            int row = y - s->y;
+            int flipx = s->flags & SPRITE_FLIPX;
+            u16* d = row_dst + s->x;
+
+            if (s->flags & SPRITE_FLIPY) {
+                row = gfx->height - 1 - row;
+            }
+
+            if (!(flipx && !gfx->data_flipx) && s->x0 == 0 && s->x1 == gfx->width - 1) {
+                const u8* src = gfx_element_row(gfx, s->code, row, flipx);
+
+                if (s->opaque) {
+                    sprite_copy_2bpp_16(d, src, gfx->row_bytes, colors[s->color]);
+                } else {
+                    sprite_row_2bpp_16(d, src, gfx->row_bytes, colors[s->color]);
+                }
+            } else {
+                u16 value[4];
+
+                for (int p = 0; p < 4; p++) {
+                    u16 pair[2];
+
+                    memcpy(pair, &colors[s->color][p * 5], sizeof(u32));
+                    value[p] = pair[0];
+                }
+                gfx_element_expand_row(gfx, s->code, row, flipx, pens);
+                for (int i = s->x0; i <= s->x1; i++) {
+                    u16 m = pens[i] ? 0xFFFF : 0x0000;
+
+                    d[i] = (d[i] & ~m) | (value[pens[i]] & m);
+                }
+            }
+
+            list->spans_drawn++;
+        }
+    }
+}
@@ -0,0 +1,83 @@
+/***************************************************************************
+ * Sprite Engine for GameCube
+ *
+ * Board-independent sprite compositing for tile-and-sprite hardware. A
+ * driver fills a sprite list from its sprite RAM once per frame; the list
+ * is clipped once per sprite, bucketed by scanline, and drawn a line at a
+ * time. Pen 0 is transparent: each packed byte or nibble selects
+ * precomputed pens and a store mask, so there is no per-pixel branch.
+ * Sprites whose pen usage shows no pen 0 skip the mask, and blank ones
+ * are dropped when the list is built.
+ ***************************************************************************/
+
+#ifndef SPRITE_H
+#define SPRITE_H
+
+#include "../mame2003/osd_gc.h"
+#include "gfx_decode.h"
+#include "blit.h"
+
+/***************************************************************************
+ * Configuration
+ ***************************************************************************/
+
+#define MAX_SPRITES             128
+#define SPRITE_MAX_LINES        512
+#define SPRITE_MAX_SPANS        (MAX_SPRITES * MAX_GFX_SIZE)
+
+/* Sprite flags */
+#define SPRITE_FLIPX            0x01
+#define SPRITE_FLIPY            0x02
+
+typedef struct {
+    const gfx_element_t* gfx;
+    u32 code;
+    u8 color;                 /* Index into the colour pair tables */
+    u8 flags;                 /* SPRITE_xxx */
+    s16 x, y;                 /* Top-left corner in destination pixels */
+
+    /* Visible part, set when the list is built */
+    s16 x0, x1;               /* Visible columns, sprite-relative */
+    u8 opaque;                /* Never pen 0: rows are stored unmasked */
+} sprite_t;
+
+typedef struct {
+    sprite_t sprites[MAX_SPRITES];
+    int count;                /* In drawing order - later sprites on top */
+
+    rectangle clip;
+    rectangle bounds;         /* Covers every sprite drawn; set when built */
+
+    /* Scanline buckets: sprites covering line y are
+     * line_sprites[line_start[y] .. line_start[y + 1] - 1] */
+    u16 line_start[SPRITE_MAX_LINES + 1];
+    u8 line_sprites[SPRITE_MAX_SPANS];
+
+    /* Statistics for the last frame */
+    u32 sprites_drawn;        /* Sprites with a visible part */
+    u32 sprites_skipped;      /* Visible but only pen 0 */
+    u32 sprites_opaque;       /* Drawn without a mask */
+    u32 spans_drawn;          /* Sprite rows composited */
+    u32 max_per_line;
+} sprite_list_t;
+
+/***************************************************************************
+ * Functions
+ ***************************************************************************/
+
+/* Start a new frame of sprites clipped to a visible area */
+void sprite_list_begin(sprite_list_t* list, const rectangle* clip);
+
+/* Queue one sprite; returns -1 when the list is full */
+int sprite_list_add(sprite_list_t* list, const gfx_element_t* gfx, u32 code,
+                    int color, int x, int y, int flags);
+
+/* Clip and bucket the queued sprites by scanline */
+void sprite_list_build(sprite_list_t* list);
+
+/* Composite onto an indexed bitmap (pitch in pixels) using the same
+ * quad/pair tables as the tiles */
+void sprite_list_draw_8(sprite_list_t* list, u8* dst, int pitch, const blit_quad8_table* colors);
+void sprite_list_draw_16(sprite_list_t* list, u16* dst, int pitch, const blit_pair16_table* colors);
+
+#endif /* SPRITE_H */
@@ -0,0 +1,488 @@
+/***************************************************************************
+ * Tilemap Implementation
+ ***************************************************************************/
+
+#include "tilemap.h"
+#include <stdio.h>
+#include <string.h>
+
+/* Mask pens per category: pen 0 transparent, others 0x80 | category */
+static blit_quad8_table tilemap_mask_quads[TILEMAP_MAX_CATEGORIES];
+static int tilemap_tables_ready = 0;
+
+static void tilemap_init_tables(void) {
+    for (int c = 0; c < TILEMAP_MAX_CATEGORIES; c++) {
+        u8 pens[4] = { 0, 0x80 | c, 0x80 | c, 0x80 | c };
+
+        blit_build_quad8_table(tilemap_mask_quads[c], pens);
+    }
+    tilemap_tables_ready = 1;
+}
+
+/***************************************************************************
+ * Scan Mappers
+ ***************************************************************************/
+
+u32 tilemap_scan_rows(u32 col, u32 row, u32 num_cols, u32 num_rows) {
+    return row * num_cols + col;
+}
+
+u32 tilemap_scan_cols(u32 col, u32 row, u32 num_cols, u32 num_rows) {
+    return col * num_rows + row;
+}
+
+/***************************************************************************
+ * Creation
+ ***************************************************************************/
+
+tilemap_t* tilemap_create(tile_get_info_func get_info, tilemap_scan_func scan, int type,
+                          int tile_width, int tile_height, int cols, int rows,
+                          int depth, void* param) {
+    tilemap_t* tmap;
+    int count = cols * rows;
+    u32 memory_size = 0;
+
+    if (!tilemap_tables_ready) {
+        tilemap_init_tables();
+    }
+
+    tmap = (tilemap_t*)osd_malloc_tagged(sizeof(tilemap_t), OSD_MEM_VIDEO);
+    if (!tmap) {
+        return NULL;
+    }
+    memset(tmap, 0, sizeof(tilemap_t));
+
+    tmap->get_info = get_info;
+    tmap->param = param;
+    tmap->type = type;
+    tmap->tile_width = tile_width;
+    tmap->tile_height = tile_height;
+    tmap->cols = cols;
+    tmap->rows = rows;
+    tmap->width = cols * tile_width;
+    tmap->height = rows * tile_height;
+    tmap->enable = 1;
+    tmap->scroll_rows = 1;
+    tmap->scroll_cols = 1;
+    tmap->all_dirty = 1;
+    tmap->moved = 1;
+    rect_set_empty(&tmap->updated);
+
+    tmap->pixmap = bitmap_alloc_depth(tmap->width, tmap->height, depth);
+    if (type == TILEMAP_TRANSPARENT) {
+        tmap->mask = bitmap_alloc_depth(tmap->width, tmap->height, 8);
+    }
+
+    /* Video RAM may be larger than the screen, with gaps the scan skips */
+    for (int row = 0; row < rows; row++) {
+        for (int col = 0; col < cols; col++) {
+            memory_size = MAX(memory_size, scan(col, row, cols, rows) + 1);
+        }
+    }
+    if (memory_size > TILEMAP_NO_TILE) {
+        printf("ERROR: Tilemap scan out of range\n");
+        tilemap_dispose(tmap);
+        return NULL;
+    }
+    tmap->memory_size = memory_size;
+
+    tmap->memory_to_tile = (u16*)osd_malloc_tagged(memory_size * sizeof(u16), OSD_MEM_VIDEO);
+    tmap->tile_to_memory = (u16*)osd_malloc_tagged(count * sizeof(u16), OSD_MEM_VIDEO);
+    tmap->tile_dirty = (u8*)osd_malloc_tagged(count, OSD_MEM_VIDEO);
+
+    if (!tmap->pixmap || (type == TILEMAP_TRANSPARENT && !tmap->mask) ||
+        !tmap->memory_to_tile || !tmap->tile_to_memory || !tmap->tile_dirty) {
+        printf("ERROR: Failed to allocate %dx%d tilemap\n", cols, rows);
+        tilemap_dispose(tmap);
+        return NULL;
+    }
+
+    /* Both directions of the scan mapping */
+    memset(tmap->memory_to_tile, 0xFF, memory_size * sizeof(u16));
+    for (int row = 0; row < rows; row++) {
+        for (int col = 0; col < cols; col++) {
+            u32 memory_index = scan(col, row, cols, rows);
+
+            if (tmap->memory_to_tile[memory_index] != TILEMAP_NO_TILE) {
+                printf("ERROR: Tilemap scan repeats a memory index at %d,%d\n", col, row);
+                tilemap_dispose(tmap);
+                return NULL;
+            }
+            tmap->memory_to_tile[memory_index] = row * cols + col;
+            tmap->tile_to_memory[row * cols + col] = memory_index;
+        }
+    }
+    memset(tmap->tile_dirty, 1, count);
+
+    return tmap;
+}
+
+void tilemap_dispose(tilemap_t* tmap) {
+    if (!tmap) {
+        return;
+    }
+
+    bitmap_free(tmap->pixmap);
+    bitmap_free(tmap->mask);
+    osd_free(tmap->memory_to_tile);
+    osd_free(tmap->tile_to_memory);
+    osd_free(tmap->tile_dirty);
+    osd_free(tmap);
+}
+
+void tilemap_set_pen_tables(tilemap_t* tmap, const blit_quad8_table* quads,
+                            const blit_pair16_table* pairs) {
+    tmap->quads = quads;
+    tmap->pairs = pairs;
+    tmap->all_dirty = 1;
+}
+
+/***************************************************************************
+ * State
+ ***************************************************************************/
+
+void tilemap_mark_tile_dirty(tilemap_t* tmap, int memory_index) {
+    if (memory_index >= 0 && memory_index < tmap->memory_size &&
+        tmap->memory_to_tile[memory_index] != TILEMAP_NO_TILE) {
+        tmap->tile_dirty[tmap->memory_to_tile[memory_index]] = 1;
+    }
+}
+
+void tilemap_mark_all_tiles_dirty(tilemap_t* tmap) {
+    tmap->all_dirty = 1;
+}
+
+void tilemap_set_flip(tilemap_t* tmap, int flip) {
+    if (tmap->flip != flip) {
+        tmap->flip = flip;
+        tmap->all_dirty = 1;
+    }
+}
+
+void tilemap_set_enable(tilemap_t* tmap, int enable) {
+    if (tmap->enable != enable) {
+        tmap->enable = enable;
+        tmap->moved = 1;
+    }
+}
+
+void tilemap_set_priority(tilemap_t* tmap, int priority) {
+    tmap->priority = priority;
+}
+
+void tilemap_set_scroll_rows(tilemap_t* tmap, int count) {
+    if (count < 1 || count > TILEMAP_MAX_SCROLL || tmap->height % count) {
+        printf("ERROR: %d scroll rows do not divide the tilemap\n", count);
+        return;
+    }
+    tmap->scroll_rows = count;
+    tmap->scroll_cols = 1;
+    tmap->moved = 1;
+}
+
+void tilemap_set_scroll_cols(tilemap_t* tmap, int count) {
+    if (count < 1 || count > TILEMAP_MAX_SCROLL || tmap->width % count) {
+        printf("ERROR: %d scroll columns do not divide the tilemap\n", count);
+        return;
+    }
+    tmap->scroll_cols = count;
+    tmap->scroll_rows = 1;
+    tmap->moved = 1;
+}
+
+void tilemap_set_scrollx(tilemap_t* tmap, int which, int value) {
+    if (which >= 0 && which < TILEMAP_MAX_SCROLL && tmap->scrollx[which] != value) {
+        tmap->scrollx[which] = value;
+        tmap->moved = 1;
+    }
+}
+
+void tilemap_set_scrolly(tilemap_t* tmap, int which, int value) {
+    if (which >= 0 && which < TILEMAP_MAX_SCROLL && tmap->scrolly[which] != value) {
+        tmap->scrolly[which] = value;
+        tmap->moved = 1;
+    }
+}
+
+/***************************************************************************
+ * Pixmap Update
+ ***************************************************************************/
+
+/* Pen 0 of a colour code, from the solid entry of its pen table */
+static int tilemap_pen0(const tilemap_t* tmap, int color) {
+    if (tmap->pixmap->depth == 8) {
+        u8 quad[4];
+
+        memcpy(quad, &tmap->quads[color][0], sizeof(u32));
+        return quad[0];
+    } else {
+        u16 pair[2];
+
+        memcpy(pair, &tmap->pairs[color][0], sizeof(u32));
+        return pair[0];
+    }
+}
+
+static void tilemap_draw_tile(tilemap_t* tmap, int tile_index) {
+    mame_bitmap* pixmap = tmap->pixmap;
+    rectangle all = { 0, tmap->width - 1, 0, tmap->height - 1 };
+    rectangle tile;
+    tile_info_t info;
+    int col = tile_index % tmap->cols;
+    int row = tile_index / tmap->cols;
+    int flip, usage, x, y;
+
+    memset(&info, 0, sizeof(info));
+    tmap->get_info(tmap->tile_to_memory[tile_index], &info, tmap->param);
+
+    /* A flipped tilemap mirrors the position and the tile itself */
+    if (tmap->flip & TILEMAP_FLIPX) {
+        col = tmap->cols - 1 - col;
+    }
+    if (tmap->flip & TILEMAP_FLIPY) {
+        row = tmap->rows - 1 - row;
+    }
+    x = col * tmap->tile_width;
+    y = row * tmap->tile_height;
+    flip = (info.flags ^ tmap->flip) & (BLIT_FLIPX | BLIT_FLIPY);
+
+    tile.min_x = x;
+    tile.max_x = x + tmap->tile_width - 1;
+    tile.min_y = y;
+    tile.max_y = y + tmap->tile_height - 1;
+    union_rect(&tmap->updated, &tile);
+
+    if (!info.gfx) {
+        fillbitmap(pixmap, 0, &tile);
+        if (tmap->mask) {
+            fillbitmap(tmap->mask, 0, &tile);
+        }
+        tmap->tiles_blank++;
+        return;
+    }
+
+    usage = gfx_element_usage(info.gfx, info.code);
+
+    /* Only pen 0: a fill of that pen, and nothing in the mask */
+    if (usage == GFX_USAGE_BLANK) {
+        fillbitmap(pixmap, tilemap_pen0(tmap, info.color), &tile);
+        if (tmap->mask) {
+            fillbitmap(tmap->mask, 0, &tile);
+        }
+        tmap->tiles_blank++;
+        return;
+    }
+
+    if (pixmap->depth == 8) {
+        blit_tile_2bpp_8((u8*)pixmap->base, pixmap->rowpixels, info.gfx, info.code,
+                         x, y, flip, tmap->quads[info.color], &all);
+    } else {
+        blit_tile_2bpp_16((u16*)pixmap->base, pixmap->rowpixels, info.gfx, info.code,
+                          x, y, flip, tmap->pairs[info.color], &all);
+    }
+
+    /* Never pen 0: the mask is solid */
+    if (!tmap->mask || usage == GFX_USAGE_OPAQUE) {
+        if (tmap->mask) {
+            fillbitmap(tmap->mask, 0x80 | (info.category % TILEMAP_MAX_CATEGORIES), &tile);
+        }
+        tmap->tiles_opaque++;
+        return;
+    }
+
+    blit_tile_2bpp_8((u8*)tmap->mask->base, tmap->mask->rowpixels, info.gfx, info.code,
+                     x, y, flip, tilemap_mask_quads[info.category % TILEMAP_MAX_CATEGORIES],
+                     &all);
+    tmap->tiles_masked++;
+}
+
+static INLINE int tilemap_wrap(int value, int size) {
+    value %= size;
+    return value < 0 ? value + size : value;
+}
+
+void tilemap_update(tilemap_t* tmap) {
+    int count = tmap->cols * tmap->rows;
+
+    tmap->tiles_drawn = 0;
+    tmap->tiles_blank = 0;
+    tmap->tiles_opaque = 0;
+    tmap->tiles_masked = 0;
+
+    for (int t = 0; t < count; t++) {
+        if (!tmap->all_dirty && !tmap->tile_dirty[t]) {
+            continue;
+        }
+        tilemap_draw_tile(tmap, t);
+        tmap->tile_dirty[t] = 0;
+        tmap->tiles_drawn++;
+    }
+
+    tmap->all_dirty = 0;
+}
+
+/***************************************************************************
+ * Damage
+ ***************************************************************************/
+
+void tilemap_get_damage(const tilemap_t* tmap, const rectangle* area, rectangle* damage) {
+    rect_set_empty(damage);
+    if (tmap->moved) {
+        *damage = *area;
+        return;
+    }
+    if (!tmap->enable || rect_is_empty(&tmap->updated)) {
+        return;
+    }
+
+    /* One scroll for the whole layer: redrawn tiles appear moved back by
+     * it, unless they wrap or the area shows the pixmap more than once */
+    if (tmap->scroll_rows == 1 && tmap->scroll_cols == 1 &&
+        area->min_x >= 0 && area->max_x < tmap->width &&
+        area->min_y >= 0 && area->max_y < tmap->height) {
+        const rectangle* u = &tmap->updated;
+        int x = tilemap_wrap(u->min_x - tmap->scrollx[0], tmap->width);
+        int y = tilemap_wrap(u->min_y - tmap->scrolly[0], tmap->height);
+
+        if (x + u->max_x - u->min_x < tmap->width && y + u->max_y - u->min_y < tmap->height) {
+            damage->min_x = x;
+            damage->max_x = x + u->max_x - u->min_x;
+            damage->min_y = y;
+            damage->max_y = y + u->max_y - u->min_y;
+            sect_rect(damage, area);
+            return;
+        }
+    }
+
+    *damage = *area;
+}
+
+void tilemap_reset_damage(tilemap_t* tmap) {
+    rect_set_empty(&tmap->updated);
+    tmap->moved = 0;
+}
+
+/***************************************************************************
+ * Drawing
+ ***************************************************************************/
+
+#define TILEMAP_OPAQUE_SPAN     0
+#define TILEMAP_MASKED_SPAN     1
+#define TILEMAP_CATEGORY_SPAN   2
+
+/* Copy 'len' pixmap pixels of row sy from sx to dest (x, y) */
+static INLINE void tilemap_copy_span(mame_bitmap* dest, int x, int y, const tilemap_t* tmap,
+                                     int sx, int sy, int len, int mode, int category) {
+    const u8* m = mode != TILEMAP_OPAQUE_SPAN ? (const u8*)tmap->mask->line[sy] + sx : NULL;
+    u8 want = 0x80 | category;
+
+    if (dest->depth == 8) {
+        const u8* s = (const u8*)tmap->pixmap->line[sy] + sx;
+        u8* d = (u8*)dest->line[y] + x;
+
+        if (mode == TILEMAP_OPAQUE_SPAN) {
+            memcpy(d, s, len);
+        } else if (mode == TILEMAP_MASKED_SPAN) {
+            for (int i = 0; i < len; i++) {
+                u8 k = -(m[i] >> 7);
+
+                d[i] = (d[i] & ~k) | (s[i] & k);
+            }
+        } else {
+            for (int i = 0; i < len; i++) {
+                u8 k = (m[i] == want) ? 0xFF : 0x00;
+
+                d[i] = (d[i] & ~k) | (s[i] & k);
+            }
+        }
+    } else {
+        const u16* s = (const u16*)tmap->pixmap->line[sy] + sx;
+        u16* d = (u16*)dest->line[y] + x;
+
+        if (mode == TILEMAP_OPAQUE_SPAN) {
+            memcpy(d, s, len * sizeof(u16));
+        } else {
+            for (int i = 0; i < len; i++) {
+                u16 k = (mode == TILEMAP_MASKED_SPAN ? (m[i] & 0x80) : (m[i] == want)) ? 0xFFFF : 0;
+
+                d[i] = (d[i] & ~k) | (s[i] & k);
+            }
+        }
+    }
+}
+
+void tilemap_draw(mame_bitmap* dest, const rectangle* clip, tilemap_t* tmap,
+                  u32 flags, int category) {
+    rectangle area = { 0, dest->width - 1, 0, dest->height - 1 };
+    int mode;
+
+    if (!tmap->enable || dest->depth != tmap->pixmap->depth) {
+        return;
+    }
+
+    tilemap_update(tmap);
+
+    if (clip) {
+        area.min_x = MAX(area.min_x, clip->min_x);
+        area.max_x = MIN(area.max_x, clip->max_x);
+        area.min_y = MAX(area.min_y, clip->min_y);
+        area.max_y = MIN(area.max_y, clip->max_y);
+    }
+
+    if (!tmap->mask || (flags & TILEMAP_IGNORE_TRANSPARENCY)) {
+        mode = TILEMAP_OPAQUE_SPAN;
+    } else {
+        mode = (category < 0) ? TILEMAP_MASKED_SPAN : TILEMAP_CATEGORY_SPAN;
+    }
+
+    for (int y = area.min_y; y <= area.max_y; y++) {
+        int x = area.min_x;
+
+        /* Runs of the row that map to one pixmap row without wrapping */
+        while (x <= area.max_x) {
+            int sx, sy, len;
+
+            if (tmap->scroll_cols > 1) {
+                int group_width = tmap->width / tmap->scroll_cols;
+                int group;
+
+                sx = tilemap_wrap(x + tmap->scrollx[0], tmap->width);
+                group = sx / group_width;
+                sy = tilemap_wrap(y + tmap->scrolly[group], tmap->height);
+                len = (group + 1) * group_width - sx;
+            } else {
+                sy = tilemap_wrap(y + tmap->scrolly[0], tmap->height);
+                sx = tilemap_wrap(x + tmap->scrollx[sy / (tmap->height / tmap->scroll_rows)],
+                                  tmap->width);
+                len = tmap->width - sx;
+            }
+            len = MIN(len, area.max_x - x + 1);
+
+            tilemap_copy_span(dest, x, y, tmap, sx, sy, len, mode, category);
+            x += len;
+        }
+    }
+}
+
+void tilemap_draw_layers(mame_bitmap* dest, const rectangle* clip, tilemap_t** layers, int count) {
+    tilemap_t* order[16];
+
+    count = MIN(count, 16);
+    memcpy(order, layers, count * sizeof(tilemap_t*));
+
+    /* Insertion sort keeps equal priorities in the given order */
+    for (int i = 1; i < count; i++) {
+        tilemap_t* t = order[i];
+        int j = i;
+
+        while (j > 0 && order[j - 1]->priority > t->priority) {
+            order[j] = order[j - 1];
+            j--;
+        }
+        order[j] = t;
+    }
+
+    for (int i = 0; i < count; i++) {
+        tilemap_draw(dest, clip, order[i], 0, -1);
+    }
+}
@@ -0,0 +1,148 @@
+/***************************************************************************
+ * Tilemaps for GameCube
+ *
+ * A tilemap keeps the whole playfield rendered in a pixmap of pens. The
+ * driver supplies a "get tile info" callback and a scan mapper from
+ * (column, row) to its video RAM layout; only tiles marked dirty are
+ * fetched and redrawn, so scrolling costs a copy, not a re-render.
+ * Transparent tilemaps also keep a mask of opaque pixels with a
+ * category per tile, so one layer can be split front and back.
+ ***************************************************************************/
+
+#ifndef TILEMAP_H
+#define TILEMAP_H
+
+#include "../mame2003/osd_gc.h"
+#include "gfx_decode.h"
+#include "blit.h"
+#include "bitmap.h"
+
+/***************************************************************************
+ * Configuration
+ ***************************************************************************/
+
+#define TILEMAP_MAX_CATEGORIES  4
+#define TILEMAP_MAX_SCROLL      256
+
+/* Tilemap types */
+#define TILEMAP_OPAQUE          0
+#define TILEMAP_TRANSPARENT     1   /* Pen 0 shows what is underneath */
+
+/* Whole-tilemap flips (flip screen) */
+#define TILEMAP_FLIPX           0x01
+#define TILEMAP_FLIPY           0x02
+
+/* tilemap_draw flags */
+#define TILEMAP_IGNORE_TRANSPARENCY 0x10
+
+/* Per-tile flags */
+#define TILE_FLIPX              0x01
+#define TILE_FLIPY              0x02
+
+typedef struct {
+    const gfx_element_t* gfx;
+    u32 code;
+    u8 color;                 /* Colour code (pen table index) */
+    u8 flags;                 /* TILE_xxx */
+    u8 category;              /* 0 .. TILEMAP_MAX_CATEGORIES - 1 */
+} tile_info_t;
+
+typedef void (*tile_get_info_func)(int tile_index, tile_info_t* info, void* param);
+
+/* Memory index of the tile at (col, row). Indices need not be dense:
+ * video RAM the screen does not show maps to no tile. */
+typedef u32 (*tilemap_scan_func)(u32 col, u32 row, u32 num_cols, u32 num_rows);
+
+#define TILEMAP_NO_TILE         0xFFFF
+
+u32 tilemap_scan_rows(u32 col, u32 row, u32 num_cols, u32 num_rows);
+u32 tilemap_scan_cols(u32 col, u32 row, u32 num_cols, u32 num_rows);
+
+typedef struct tilemap {
+    tile_get_info_func get_info;
+    void* param;
+    int type;
+    int tile_width, tile_height;
+    int cols, rows;
+    int width, height;        /* In pixels */
+    int flip;                 /* TILEMAP_FLIPx */
+    int enable;
+    int priority;             /* Drawing order for tilemap_draw_layers */
+
+    /* Pen tables per colour code, for the pixmap's depth */
+    const blit_quad8_table* quads;
+    const blit_pair16_table* pairs;
+
+    /* Cached rendering */
+    mame_bitmap* pixmap;
+    mame_bitmap* mask;        /* Transparent only: 0 or 0x80 | category */
+    u16* memory_to_tile;      /* Memory index -> tile index (row * cols + col),
+                                 TILEMAP_NO_TILE where nothing is shown */
+    u16* tile_to_memory;
+    int memory_size;          /* Highest memory index the scan gives, plus one */
+    u8* tile_dirty;           /* By tile index */
+    int all_dirty;
+
+    /* Changes since tilemap_reset_damage: pixmap area of the tiles
+     * redrawn, and whether scrolling or enable changed */
+    rectangle updated;
+    int moved;
+
+    /* Scrolling: either per row group (one scrolly) or per column
+     * group (one scrollx) */
+    int scroll_rows, scroll_cols;
+    int scrollx[TILEMAP_MAX_SCROLL];
+    int scrolly[TILEMAP_MAX_SCROLL];
+
+    /* Statistics for the last update, by the path each tile took */
+    u32 tiles_drawn;          /* Tiles redrawn */
+    u32 tiles_blank;          /* Only pen 0: filled, no blit */
+    u32 tiles_opaque;         /* Blitted; mask filled solid if any */
+    u32 tiles_masked;         /* Blitted with a mask blit */
+} tilemap_t;
+
+/***************************************************************************
+ * Functions
+ ***************************************************************************/
+
+tilemap_t* tilemap_create(tile_get_info_func get_info, tilemap_scan_func scan, int type,
+                          int tile_width, int tile_height, int cols, int rows,
+                          int depth, void* param);
+void tilemap_dispose(tilemap_t* tmap);
+
+void tilemap_set_pen_tables(tilemap_t* tmap, const blit_quad8_table* quads,
+                            const blit_pair16_table* pairs);
+
+/* Invalidation - by memory index, as the driver writes video RAM */
+void tilemap_mark_tile_dirty(tilemap_t* tmap, int memory_index);
+void tilemap_mark_all_tiles_dirty(tilemap_t* tmap);
+
+void tilemap_set_flip(tilemap_t* tmap, int flip);
+void tilemap_set_enable(tilemap_t* tmap, int enable);
+void tilemap_set_priority(tilemap_t* tmap, int priority);
+
+/* Scrolling - scroll_rows/scroll_cols split the pixmap into equal
+ * groups; the scroll value of a group is looked up by pixmap row or
+ * column. Positive values move the tilemap left / up. */
+void tilemap_set_scroll_rows(tilemap_t* tmap, int count);
+void tilemap_set_scroll_cols(tilemap_t* tmap, int count);
+void tilemap_set_scrollx(tilemap_t* tmap, int which, int value);
+void tilemap_set_scrolly(tilemap_t* tmap, int which, int value);
+
+/* Redraw dirty tiles into the pixmap (tilemap_draw does this too) */
+void tilemap_update(tilemap_t* tmap);
+
+/* Draw onto a bitmap of the same depth. category -1 draws every tile;
+ * otherwise only opaque pixels of that category are drawn. */
+void tilemap_draw(mame_bitmap* dest, const rectangle* clip, tilemap_t* tmap,
+                  u32 flags, int category);
+
+/* Part of 'area' of a destination drawn at the current scroll that
+ * changed since tilemap_reset_damage; empty if nothing did */
+void tilemap_get_damage(const tilemap_t* tmap, const rectangle* area, rectangle* damage);
+void tilemap_reset_damage(tilemap_t* tmap);
+
+/* Draw the enabled tilemaps from lowest to highest priority */
+void tilemap_draw_layers(mame_bitmap* dest, const rectangle* clip, tilemap_t** layers, int count);
+
+#endif /* TILEMAP_H */
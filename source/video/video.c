@@ -3,6 +3,8 @@
  ***************************************************************************/
 
 #include "video.h"
+#include "blit.h"
+#include "../mame2003/memory.h"
 #include <string.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -11,7 +13,8 @@
 /***************************************************************************
  * Pac-Man Default Palette
  * 
- * Colors from original Pac-Man arcade hardware
+ * Colors from original Pac-Man arcade hardware, one per colour code;
+ * used when the colour PROMs are not loaded
  ***************************************************************************/
 
 static const color_t pacman_palette[PALETTE_SIZE] = {
@@ -34,168 +37,769 @@ static const color_t pacman_palette[PALETTE_SIZE] = {
 };
 
 /***************************************************************************
- * Simple 8x8 Tile Graphics (Test Pattern)
+ * Test Pattern Graphics
  * 
- * For now, we'll generate test patterns for each tile
- * Later we'll load actual Pac-Man tile graphics
+ * Used until the driver's GFX ROMs are decoded, and as a fallback when
+ * they are not present
  ***************************************************************************/
 
-static void generate_test_tile(u8* tile_data, u8 tile_index) {
-    /* Create a test pattern based on tile index */
+static void generate_test_tile(u8* pens, u8 tile_index) {
+    /* Create a checkerboard pattern with tile index influence */
     for (int y = 0; y < 8; y++) {
         for (int x = 0; x < 8; x++) {
-            int pixel_idx = y * 8 + x;
-            
-            /* Create a checkerboard pattern with tile index influence */
             if ((x + y + tile_index) & 1) {
-                tile_data[pixel_idx] = (tile_index & 0x0F);  /* Use low nibble as color */
+                pens[y * 8 + x] = 1 + (tile_index % 3);
             } else {
-                tile_data[pixel_idx] = 0;  /* Black */
+                pens[y * 8 + x] = 0;
             }
         }
     }
 }
 
+static gfx_element_t* create_test_tiles(void) {
+    gfx_element_t* gfx = gfx_element_create(8, 8, 256, 2, GFX_DECODE_FLIPX);
+    u8 pens[64];
+    
+    if (!gfx) {
+        return NULL;
+    }
+    
+    for (int i = 0; i < 256; i++) {
+        generate_test_tile(pens, i);
+        gfx_element_set(gfx, i, pens);
+    }
+    
+    return gfx;
+}
+
 /***************************************************************************
  * Initialization
  ***************************************************************************/
 
+static const rectangle video_visible = { 0, VIDEO_WIDTH - 1, 0, VIDEO_HEIGHT - 1 };
+
+/* Pen tables: colour code c maps pixel p to pen c * 4 + p. They do not
+ * depend on the colours, so palette changes never redraw tiles. */
+static void video_build_code_tables(video_state_t* state) {
+    u8 pens8[4];
+    u16 pens16[4];
+    
+    for (int code = 0; code < VIDEO_COLOR_CODES; code++) {
+        for (int p = 0; p < 4; p++) {
+            pens8[p] = pens16[p] = code * 4 + p;
+        }
+        blit_build_quad8_table(state->pen_quads[code], pens8);
+        blit_build_pair16_table(state->pen_pairs[code], pens16);
+    }
+}
+
 int video_init(video_state_t* state, u32* framebuffer, int width, int height) {
     printf("Initializing video system...\n");
     
     memset(state, 0, sizeof(video_state_t));
     
-    state->framebuffer = framebuffer;
-    state->fb_width = width;
-    state->fb_height = height;
     state->frame_count = 0;
+    state->clip = video_visible;
+    state->vram_tracker = -1;
+    state->cram_tracker = -1;
+    state->last_sprite_count = -1;
+    rect_set_empty(&state->damage);
+    rect_set_empty(&state->last_sprite_bounds);
+    state->stale = video_visible;
+    
+    if (video_set_target(state, framebuffer, width, height, VIDEO_FORMAT_RGBA8888) != 0) {
+        return -1;
+    }
     
     /* Set default palette */
+    video_build_code_tables(state);
+    if (palette_init(&state->palette, VIDEO_COLORS, VIDEO_COLOR_CODES, 4) != 0) {
+        return -1;
+    }
     video_set_default_palette(state);
     
-    /* Allocate tile graphics (256 tiles × 64 bytes each) */
-    state->tile_gfx = malloc(256 * 64);
-    if (!state->tile_gfx) {
+    /* Test tiles until real graphics are decoded (256 tiles, 2bpp) */
+    printf("Generating test tile graphics...\n");
+    state->gfx[0] = create_test_tiles();
+    if (!state->gfx[0]) {
         printf("ERROR: Failed to allocate tile graphics\n");
         return -1;
     }
+    state->tile_count = state->gfx[0]->total;
     
-    /* Generate test tiles */
-    printf("Generating test tile graphics...\n");
-    for (int i = 0; i < 256; i++) {
-        generate_test_tile(state->tile_gfx + (i * 64), i);
+    /* Indexed bitmap sized to the visible area */
+    state->bitmap = bitmap_alloc_depth(VIDEO_WIDTH, VIDEO_HEIGHT, VIDEO_BITMAP_DEPTH);
+    if (!state->bitmap) {
+        printf("ERROR: Failed to allocate video bitmap\n");
+        return -1;
     }
-    state->tile_count = 256;
     
     printf("Video system initialized\n");
     printf("  Framebuffer: %p (%dx%d)\n", framebuffer, width, height);
+    printf("  Bitmap: %dx%d@%d (%d bytes)\n", VIDEO_WIDTH, VIDEO_HEIGHT, VIDEO_BITMAP_DEPTH,
+           state->bitmap->rowbytes * VIDEO_HEIGHT);
     printf("  Tiles: %d\n", state->tile_count);
     
     return 0;
 }
 
+int video_create_tilemap(video_state_t* state, tile_get_info_func get_info, tilemap_scan_func scan,
+                         int cols, int rows) {
+    tilemap_t* tilemap = tilemap_create(get_info, scan, TILEMAP_OPAQUE,
+                                        VIDEO_TILE_WIDTH, VIDEO_TILE_HEIGHT,
+                                        cols, rows, VIDEO_BITMAP_DEPTH, state);
+    
+    if (!tilemap) {
+        printf("ERROR: Failed to create tilemap\n");
+        return -1;
+    }
+    tilemap_set_pen_tables(tilemap, state->pen_quads, state->pen_pairs);
+    
+    tilemap_dispose(state->tilemap);
+    state->tilemap = tilemap;
+    return 0;
+}
+
 void video_shutdown(video_state_t* state) {
     printf("Shutting down video system...\n");
     
-    if (state->tile_gfx) {
-        free(state->tile_gfx);
-        state->tile_gfx = NULL;
+    if (state->vram_tracker >= 0) {
+        memory_untrack_writes(state->vram_tracker);
+    }
+    if (state->cram_tracker >= 0) {
+        memory_untrack_writes(state->cram_tracker);
+    }
+    
+    bitmap_free(state->bitmap);
+    tilemap_dispose(state->tilemap);
+    palette_free(&state->palette);
+    
+    for (int i = 0; i < MAX_GFX_ELEMENTS; i++) {
+        gfx_element_free(state->gfx[i]);
+        state->gfx[i] = NULL;
     }
     
     memset(state, 0, sizeof(video_state_t));
 }
 
+/***************************************************************************
+ * Render Target
+ ***************************************************************************/
+
+/* Largest integer zoom of the displayed area that fits, centred (on an
+ * even pixel), and the blitter for it */
+static void video_layout(video_state_t* state) {
+    int swap = state->orientation & ORIENTATION_SWAP_XY;
+    int width = swap ? VIDEO_HEIGHT : VIDEO_WIDTH;
+    int height = swap ? VIDEO_WIDTH : VIDEO_HEIGHT;
+    blitter_func blitter = state->blitter;
+    int x_offset = state->x_offset;
+    int y_offset = state->y_offset;
+    
+    state->scale = MAX(1, MIN(state->fb_width / width, state->fb_height / height));
+    state->scale = MIN(state->scale, BLITTER_MAX_SCALE);
+    state->x_offset = MAX(0, (state->fb_width - width * state->scale) / 2) & ~1;
+    state->y_offset = MAX(0, (state->fb_height - height * state->scale) / 2);
+    state->blitter = blitter_select(state->orientation, VIDEO_BITMAP_DEPTH, state->format,
+                                    state->scale);
+    
+    /* The game area moved or changed shape: draw all of it again */
+    if (state->blitter != blitter || state->x_offset != x_offset || state->y_offset != y_offset) {
+        state->stale = video_visible;
+    }
+}
+
+int video_set_target(video_state_t* state, u32* framebuffer, int width, int height, int format) {
+    if (format == VIDEO_FORMAT_YUY2 && (width & 1)) {
+        printf("ERROR: YUY2 target width must be even\n");
+        return -1;
+    }
+    
+    state->framebuffer = framebuffer;
+    state->fb_width = width;
+    state->fb_height = height;
+    state->fb_pitch = (format == VIDEO_FORMAT_YUY2) ? width / 2 : width;
+    state->format = format;
+    video_layout(state);
+    
+    return 0;
+}
+
+int video_set_orientation(video_state_t* state, int game_orientation, int user_orientation) {
+    /* The blitter turns the image while presenting it */
+    state->orientation = orientation_compose(game_orientation, user_orientation);
+    video_layout(state);
+    return 0;
+}
+
+/***************************************************************************
+ * Graphics Decoding
+ ***************************************************************************/
+
+int video_decode_gfx(video_state_t* state, const gfx_decode_info* info) {
+    int decoded = 0;
+    
+    for (int i = 0; i < MAX_GFX_ELEMENTS && info[i].memory_region != -1; i++) {
+        gfx_element_t* gfx = gfx_decode(&info[i]);
+        
+        if (!gfx) {
+            printf("GFX region 0x%02X not loaded, keeping test graphics\n",
+                   info[i].memory_region);
+            continue;
+        }
+        
+        gfx_element_free(state->gfx[i]);
+        state->gfx[i] = gfx;
+        decoded++;
+    }
+    
+    if (state->gfx[0]) {
+        state->tile_count = state->gfx[0]->total;
+    }
+    
+    video_mark_all_dirty(state);
+    return decoded;
+}
+
 /***************************************************************************
  * Palette
  ***************************************************************************/
 
+int video_decode_palette(video_state_t* state, const palette_prom_info* info) {
+    if (palette_load_proms(&state->palette, info) != 0) {
+        printf("PROM region 0x%02X not loaded, keeping default palette\n", info->memory_region);
+        return -1;
+    }
+    return 0;
+}
+
+/* Hand palette: pixel 0 of every code is entry 0, the others take the
+ * entry of their colour code */
 void video_set_palette(video_state_t* state, const color_t* palette) {
-    memcpy(state->palette, palette, sizeof(state->palette));
+    for (int i = 0; i < PALETTE_SIZE; i++) {
+        palette_set_color(&state->palette, i, palette[i]);
+    }
+    for (int pen = 0; pen < VIDEO_PENS; pen++) {
+        palette_set_pen_color(&state->palette, pen, (pen & 3) ? (pen >> 2) % PALETTE_SIZE : 0);
+    }
 }
 
 void video_set_default_palette(video_state_t* state) {
     video_set_palette(state, pacman_palette);
 }
 
+void video_set_color(video_state_t* state, int color, color_t value) {
+    palette_set_color(&state->palette, color, value);
+}
+
 /***************************************************************************
  * Frame Management
  ***************************************************************************/
 
 void video_begin_frame(video_state_t* state) {
-    /* Nothing needed yet */
+    state->clip = video_visible;
+    state->update_next = 0;
+    state->partial_updates = 0;
+    state->sprite_lists = 0;
+    rect_set_empty(&state->damage);
+    rect_set_empty(&state->sprite_bounds);
+}
+
+/* Same sprites in the same places as the last frame? Only frames drawn
+ * with one sprite list are compared; the list becomes the last one. */
+static int video_sprites_changed(video_state_t* state) {
+    const sprite_list_t* list = &state->sprites;
+    int changed = (state->sprite_lists != 1 || list->count != state->last_sprite_count);
+    
+    for (int i = 0; i < list->count && !changed; i++) {
+        const sprite_t* s = &list->sprites[i];
+        const sprite_t* last = &state->last_sprites[i];
+        
+        changed = s->gfx != last->gfx || s->code != last->code || s->color != last->color ||
+                  s->flags != last->flags || s->x != last->x || s->y != last->y;
+    }
+    
+    if (state->sprite_lists == 1) {
+        memcpy(state->last_sprites, list->sprites, list->count * sizeof(sprite_t));
+        state->last_sprite_count = list->count;
+    } else {
+        state->last_sprite_count = -1;
+    }
+    return changed;
+}
+
+static void video_update_damage(video_state_t* state) {
+    rectangle area;
+    
+    /* Tiles redrawn or scrolled */
+    if (state->tilemap) {
+        tilemap_get_damage(state->tilemap, &video_visible, &area);
+        union_rect(&state->damage, &area);
+        tilemap_reset_damage(state->tilemap);
+    }
+    
+    /* Sprites: where they were and where they are now */
+    if (video_sprites_changed(state)) {
+        union_rect(&state->damage, &state->last_sprite_bounds);
+        union_rect(&state->damage, &state->sprite_bounds);
+    }
+    state->last_sprite_bounds = state->sprite_bounds;
 }
 
 void video_end_frame(video_state_t* state) {
+    /* Rows below the last partial update */
+    if (state->update) {
+        video_force_partial_update(state, VIDEO_HEIGHT - 1);
+    }
+    
+    video_update_damage(state);
+    video_present(state);
     state->frame_count++;
 }
 
+void video_add_damage(video_state_t* state, const rectangle* area) {
+    union_rect(&state->damage, area);
+}
+
+void video_add_stale(video_state_t* state, const rectangle* area) {
+    union_rect(&state->stale, area ? area : &video_visible);
+}
+
+void video_set_update(video_state_t* state, video_update_func update, void* param) {
+    state->update = update;
+    state->update_param = param;
+}
+
+void video_force_partial_update(video_state_t* state, int line) {
+    rectangle band;
+    
+    line = MIN(line, VIDEO_HEIGHT - 1);
+    if (!state->update || line < state->update_next) {
+        return;
+    }
+    
+    band = video_visible;
+    band.min_y = state->update_next;
+    band.max_y = line;
+    
+    state->clip = band;
+    state->update(state, &band, state->update_param);
+    state->clip = video_visible;
+    
+    state->update_next = line + 1;
+    state->partial_updates++;
+}
+
+static u32 video_target_word(const video_state_t* state, color_t color) {
+    u32 pixel = palette_rgba_word(color);
+    
+    return (state->format == VIDEO_FORMAT_YUY2) ? blit_yuy2_pair(pixel, pixel) : pixel;
+}
+
 void video_clear(video_state_t* state, color_t color) {
-    /* Convert color to 32-bit RGBA */
-    u32 pixel = (color.r << 24) | (color.g << 16) | (color.b << 8) | color.a;
+    u32 word = video_target_word(state, color);
     
     /* Fill framebuffer */
-    for (int i = 0; i < state->fb_width * state->fb_height; i++) {
-        state->framebuffer[i] = pixel;
+    for (int i = 0; i < state->fb_pitch * state->fb_height; i++) {
+        state->framebuffer[i] = word;
+    }
+    state->stale = video_visible;
+}
+
+void video_fill_rect(video_state_t* state, int x, int y, int width, int height, color_t color) {
+    u32 word = video_target_word(state, color);
+    int shift = (state->format == VIDEO_FORMAT_YUY2) ? 1 : 0;
+    int x0 = MAX(x, 0) >> shift;
+    int x1 = MIN(x + width, state->fb_width) >> shift;
+    
+    for (int row = MAX(y, 0); row < MIN(y + height, state->fb_height); row++) {
+        u32* d = state->framebuffer + row * state->fb_pitch;
+        
+        for (int i = x0; i < x1; i++) {
+            d[i] = word;
+        }
+    }
+    
+    /* Anything drawn over the game area is put right by the next present */
+    if (x < state->fb_width - state->x_offset && x + width > state->x_offset &&
+        y < state->fb_height - state->y_offset && y + height > state->y_offset) {
+        state->stale = video_visible;
     }
 }
 
 /***************************************************************************
- * Tile Rendering
+ * Presentation
+ *
+ * The frame bitmap holds pens; the blitter for the layout looks them up
+ * a pixel (RGBA) or pixel pair (YUY2) at a time, turning and zooming the
+ * image as it goes. Only the damaged part of the game area is written;
+ * a colour change damages the rows that hold its pens.
  ***************************************************************************/
 
-static inline void put_pixel(u32* fb, int fb_width, int x, int y, color_t color) {
-    if (x >= 0 && y >= 0 && x < fb_width && y < 480) {  /* Assuming max 480 height */
-        u32 pixel = (color.r << 24) | (color.g << 16) | (color.b << 8) | color.a;
-        fb[y * fb_width + x] = pixel;
+/* Bitmap rectangle in the coordinates of the oriented image */
+static void video_orient_rect(const video_state_t* state, const rectangle* src, rectangle* dst) {
+    int swap = state->orientation & ORIENTATION_SWAP_XY;
+    int width = swap ? VIDEO_HEIGHT : VIDEO_WIDTH;
+    int height = swap ? VIDEO_WIDTH : VIDEO_HEIGHT;
+    int t;
+    
+    *dst = *src;
+    if (swap) {
+        dst->min_x = src->min_y;
+        dst->max_x = src->max_y;
+        dst->min_y = src->min_x;
+        dst->max_y = src->max_x;
+    }
+    if (state->orientation & ORIENTATION_FLIP_X) {
+        t = dst->min_x;
+        dst->min_x = width - 1 - dst->max_x;
+        dst->max_x = width - 1 - t;
+    }
+    if (state->orientation & ORIENTATION_FLIP_Y) {
+        t = dst->min_y;
+        dst->min_y = height - 1 - dst->max_y;
+        dst->max_y = height - 1 - t;
+    }
+}
+
+static INLINE int video_row_has_dirty_pen(const video_state_t* state, int y) {
+    const mame_bitmap* bitmap = state->bitmap;
+    
+    if (bitmap->depth == 8) {
+        const u8* p = (const u8*)bitmap->line[y];
+        
+        for (int x = video_visible.min_x; x <= video_visible.max_x; x++) {
+            if (palette_pen_dirty(&state->palette, p[x])) {
+                return 1;
+            }
+        }
+    } else {
+        const u16* p = (const u16*)bitmap->line[y];
+        
+        for (int x = video_visible.min_x; x <= video_visible.max_x; x++) {
+            if (p[x] < PALETTE_MAX_PENS && palette_pen_dirty(&state->palette, p[x])) {
+                return 1;
+            }
+        }
+    }
+    return 0;
+}
+
+/* Bitmap rows from the first to the last holding a pen whose colour
+ * changed; empty if none is on screen. Scanning stops at the first such
+ * row from each end, so a change that shows everywhere costs little. */
+static void video_palette_damage(const video_state_t* state, rectangle* area) {
+    int top = video_visible.min_y;
+    int bottom = video_visible.max_y;
+    
+    while (top <= bottom && !video_row_has_dirty_pen(state, top)) {
+        top++;
+    }
+    while (bottom > top && !video_row_has_dirty_pen(state, bottom)) {
+        bottom--;
+    }
+    
+    *area = video_visible;
+    area->min_y = top;
+    area->max_y = bottom;
+}
+
+void video_present(video_state_t* state) {
+    const mame_bitmap* bitmap = state->bitmap;
+    int swap = state->orientation & ORIENTATION_SWAP_XY;
+    rectangle area = state->damage;
+    rectangle o;
+    blitter_args args;
+    int width, height;
+    
+    state->present_y = 0;
+    state->present_rows = 0;
+    if (!state->framebuffer || !bitmap || !state->blitter) {
+        return;
+    }
+    
+    /* Pick up colour changes since the last frame, where they show */
+    if (state->palette.dirty_count) {
+        rectangle rows;
+        
+        video_palette_damage(state, &rows);
+        union_rect(&area, &rows);
+        palette_update(&state->palette);
+    }
+    
+    union_rect(&area, &state->stale);
+    sect_rect(&area, &video_visible);
+    rect_set_empty(&state->stale);
+    if (rect_is_empty(&area)) {
+        return;
+    }
+    
+    /* Whole source pixels that fit the target; YUY2 words at odd zooms
+     * hold parts of two pixels, so those go in pairs */
+    width = MIN(swap ? bitmap->height : bitmap->width, (state->fb_width - state->x_offset) / state->scale);
+    height = MIN(swap ? bitmap->width : bitmap->height, (state->fb_height - state->y_offset) / state->scale);
+    
+    video_orient_rect(state, &area, &o);
+    args.dst = state->framebuffer + state->y_offset * state->fb_pitch;
+    if (state->format == VIDEO_FORMAT_YUY2) {
+        args.dst += state->x_offset / 2;
+        if (state->scale & 1) {
+            width &= ~1;
+            o.min_x &= ~1;
+            o.max_x |= 1;
+        }
+    } else {
+        args.dst += state->x_offset;
+    }
+    o.max_x = MIN(o.max_x, width - 1);
+    o.max_y = MIN(o.max_y, height - 1);
+    if (rect_is_empty(&o)) {
+        return;
+    }
+    
+    args.src = bitmap;
+    args.palette = &state->palette;
+    args.pitch = state->fb_pitch;
+    args.x = o.min_x;
+    args.y = o.min_y;
+    args.width = o.max_x - o.min_x + 1;
+    args.height = o.max_y - o.min_y + 1;
+    state->blitter(&args);
+    
+    state->present_y = state->y_offset + o.min_y * state->scale;
+    state->present_rows = args.height * state->scale;
+}
+
+/***************************************************************************
+ * Dirty Tracking
+ *
+ * A tile is redrawn into the tilemap only when its VRAM or CRAM byte
+ * was written or the screen was flipped. Palette changes only affect the
+ * presentation tables.
+ ***************************************************************************/
+
+static void video_vram_dirty(UINT32 start, UINT32 end, void* param) {
+    video_state_t* state = (video_state_t*)param;
+    
+    for (UINT32 a = start; a <= end; a++) {
+        if (a - state->vram_base < state->track_size) {
+            tilemap_mark_tile_dirty(state->tilemap, a - state->vram_base);
+        }
+    }
+}
+
+static void video_cram_dirty(UINT32 start, UINT32 end, void* param) {
+    video_state_t* state = (video_state_t*)param;
+    
+    for (UINT32 a = start; a <= end; a++) {
+        if (a - state->cram_base < state->track_size) {
+            tilemap_mark_tile_dirty(state->tilemap, a - state->cram_base);
+        }
+    }
+}
+
+int video_track_memory(video_state_t* state, UINT32 vram_base, UINT32 cram_base, UINT32 size) {
+    state->vram_base = vram_base;
+    state->cram_base = cram_base;
+    state->track_size = size;
+    
+    state->vram_tracker = memory_track_writes(vram_base, vram_base + size - 1, MEMORY_TRACK_BYTES);
+    state->cram_tracker = memory_track_writes(cram_base, cram_base + size - 1, MEMORY_TRACK_BYTES);
+    if (state->vram_tracker < 0 || state->cram_tracker < 0) {
+        printf("ERROR: Failed to track video memory\n");
+        return -1;
+    }
+    
+    video_mark_all_dirty(state);
+    return 0;
+}
+
+void video_mark_tile_dirty(video_state_t* state, int index) {
+    if (state->tilemap) {
+        tilemap_mark_tile_dirty(state->tilemap, index);
+    }
+}
+
+void video_mark_all_dirty(video_state_t* state) {
+    if (state->tilemap) {
+        tilemap_mark_all_tiles_dirty(state->tilemap);
     }
 }
 
+/***************************************************************************
+ * Tile Rendering
+ ***************************************************************************/
+
 void video_render_tiles(video_state_t* state, 
                        const u8* vram, 
                        const u8* cram,
                        int flip_screen) {
-    /* Render all tiles from VRAM */
+    int tracked = (state->vram_tracker >= 0 && state->cram_tracker >= 0);
     
-    /* Calculate centering offset to center 224x288 in framebuffer */
-    int x_offset = (state->fb_width - VIDEO_WIDTH) / 2;
-    int y_offset = (state->fb_height - VIDEO_HEIGHT) / 2;
+    if (!state->tilemap) {
+        return;
+    }
     
-    for (int ty = 0; ty < VIDEO_TILES_Y; ty++) {
-        for (int tx = 0; tx < VIDEO_TILES_X; tx++) {
-            /* Pac-Man video RAM layout is column-major */
-            int vram_idx = tx * VIDEO_TILES_Y + ty;
-            
-            /* Get tile index and color from VRAM/CRAM */
-            u8 tile_idx = vram[vram_idx];
-            u8 color_code = cram[vram_idx];
-            
-            /* Get tile graphics */
-            u8* tile_gfx = state->tile_gfx + (tile_idx * 64);
+    state->tile_vram = vram;
+    state->tile_cram = cram;
+    
+    /* Collect what changed since the last render */
+    if (!tracked) {
+        tilemap_mark_all_tiles_dirty(state->tilemap);
+    } else {
+        if (memory_is_dirty(state->vram_tracker)) {
+            memory_dirty_iterate(state->vram_tracker, video_vram_dirty, state);
+        }
+        if (memory_is_dirty(state->cram_tracker)) {
+            memory_dirty_iterate(state->cram_tracker, video_cram_dirty, state);
+        }
+    }
+    
+    /* Flipped screen: mirrored positions, tiles turned through 180 degrees */
+    tilemap_set_flip(state->tilemap, flip_screen ? TILEMAP_FLIPX | TILEMAP_FLIPY : 0);
+    
+    /* Redraws the dirty tiles, then copies the layer into the frame
+     * bitmap; sprites are composited over this */
+    tilemap_draw(state->bitmap, &state->clip, state->tilemap, 0, -1);
+    
+    state->tiles_drawn = state->tilemap->tiles_drawn;
+    state->tiles_drawn_total += state->tiles_drawn;
+}
+
+/***************************************************************************
+ * Bitmapped Rendering
+ ***************************************************************************/
+
+int video_render_bitvideo(video_state_t* state, bitvideo_t* bv) {
+    int drawn;
+    
+    /* bitvideo_draw leaves out what does not fit; here that would be
+     * part of the game's screen */
+    if (bv->width > state->bitmap->width || bv->height > state->bitmap->height) {
+        printf("ERROR: %dx%d 1bpp video does not fit the %dx%d frame\n",
+               bv->width, bv->height, state->bitmap->width, state->bitmap->height);
+        return -1;
+    }
+    
+    drawn = bitvideo_draw(bv, state->bitmap);
+    if (drawn > 0) {
+        video_add_damage(state, &bv->damage);
+    }
+    return drawn;
+}
+
+/***************************************************************************
+ * Sprite Rendering
+ ***************************************************************************/
+
+sprite_list_t* video_begin_sprites(video_state_t* state) {
+    sprite_list_begin(&state->sprites, &state->clip);
+    return &state->sprites;
+}
+
+void video_render_sprites(video_state_t* state) {
+    mame_bitmap* bitmap = state->bitmap;
+    
+    sprite_list_build(&state->sprites);
+    union_rect(&state->sprite_bounds, &state->sprites.bounds);
+    state->sprite_lists++;
+    
+    if (bitmap->depth == 8) {
+        sprite_list_draw_8(&state->sprites, (u8*)bitmap->base, bitmap->rowpixels,
+                           state->pen_quads);
+    } else {
+        sprite_list_draw_16(&state->sprites, (u16*)bitmap->base, bitmap->rowpixels,
+                            state->pen_pairs);
+    }
+}
+
+/***************************************************************************
+ * Benchmark
+ ***************************************************************************/
+
+double video_benchmark_tiles(video_state_t* state, int iterations) {
+    mame_bitmap* bg;
+    rectangle visible;
+    UINT64 start, elapsed;
+    u32 tiles = 0;
+    double rate;
+    
+    if (!state->tilemap) {
+        return 0.0;
+    }
+    bg = state->tilemap->pixmap;
+    visible.min_x = 0;
+    visible.max_x = bg->width - 1;
+    visible.min_y = 0;
+    visible.max_y = bg->height - 1;
+    
+    start = osd_ticks_us();
+    for (int i = 0; i < iterations; i++) {
+        for (int t = 0; t < VIDEO_TILE_COUNT; t++) {
+            int x = (t % VIDEO_TILES_X) * VIDEO_TILE_WIDTH;
+            int y = (t / VIDEO_TILES_X) * VIDEO_TILE_HEIGHT;
             
-            /* Render 8x8 tile */
-            for (int py = 0; py < 8; py++) {
-                for (int px = 0; px < 8; px++) {
-                    /* Get pixel color index from tile */
-                    u8 color_idx = tile_gfx[py * 8 + px];
-                    
-                    /* If pixel is transparent (0), skip it */
-                    if (color_idx == 0) continue;
-                    
-                    /* Combine with color code (use color_code as palette offset) */
-                    color_idx = (color_code & 0x0F);
-                    
-                    /* Get RGB color from palette */
-                    color_t color = state->palette[color_idx];
-                    
-                    /* Calculate screen position */
-                    int screen_x = x_offset + tx * 8 + px;
-                    int screen_y = y_offset + ty * 8 + py;
-                    
-                    /* Put pixel */
-                    put_pixel(state->framebuffer, state->fb_width, 
-                             screen_x, screen_y, color);
-                }
+            if (bg->depth == 8) {
+                blit_tile_2bpp_8((u8*)bg->base, bg->rowpixels, state->gfx[0], t + i,
+                                 x, y, (i & 1) * (BLIT_FLIPX | BLIT_FLIPY), state->pen_quads[t & 0x0F], &visible);
+            } else {
+                blit_tile_2bpp_16((u16*)bg->base, bg->rowpixels, state->gfx[0], t + i,
+                                  x, y, (i & 1) * (BLIT_FLIPX | BLIT_FLIPY), state->pen_pairs[t & 0x0F], &visible);
             }
         }
+        tiles += VIDEO_TILE_COUNT;
+    }
+    elapsed = osd_ticks_us() - start;
+    
+    /* The tilemap no longer matches VRAM */
+    video_mark_all_dirty(state);
+    
+    rate = elapsed ? (double)tiles * 1000.0 / (double)elapsed : 0.0;
+    printf("Tile blitter (%dbpp): %u tiles in %u us, %.1f tiles/ms\n",
+           bg->depth, tiles, (u32)elapsed, rate);
+    return rate;
+}
+
+double video_benchmark_orientation(video_state_t* state, int iterations) {
+    static const int orientations[] = { ROT0, ROT90, ROT180, ROT270 };
+    static const char* const names[] = { "ROT0", "ROT90", "ROT180", "ROT270" };
+    int saved = state->orientation;
+    double worst = 0.0;
+    
+    for (int n = 0; n < 4; n++) {
+        UINT64 start, elapsed;
+        double per_frame;
+        
+        state->orientation = orientations[n];
+        video_layout(state);
+        
+        start = osd_ticks_us();
+        for (int i = 0; i < iterations; i++) {
+            video_add_stale(state, NULL);
+            video_present(state);
+        }
+        elapsed = osd_ticks_us() - start;
+        
+        per_frame = iterations ? (double)elapsed / iterations : 0.0;
+        worst = MAX(worst, per_frame);
+        printf("Orientation %-6s: %.1f us/frame (x%d)\n", names[n], per_frame, state->scale);
     }
+    
+    state->orientation = saved;
+    video_layout(state);
+    return worst;
+}
+
+void video_get_stats(const video_state_t* state, video_stats_t* stats) {
+    stats->frames = state->frame_count;
+    stats->tiles_drawn = state->tiles_drawn;
+    stats->tiles_drawn_total = state->tiles_drawn_total;
+    stats->sprites_drawn = state->sprites.sprites_drawn;
+    stats->tiles_blank = state->tilemap ? state->tilemap->tiles_blank : 0;
+    stats->tiles_opaque = state->tilemap ? state->tilemap->tiles_opaque : 0;
+    stats->tiles_masked = state->tilemap ? state->tilemap->tiles_masked : 0;
+    stats->sprites_skipped = state->sprites.sprites_skipped;
+    stats->sprites_opaque = state->sprites.sprites_opaque;
+    stats->pens_updated = state->palette.pens_updated;
+    stats->rows_presented = state->present_rows;
 }
@@ -8,51 +8,154 @@
 #define VIDEO_H
 
 #include "../mame2003/osd_gc.h"
-#include <gctypes.h>
+#include "gfx_decode.h"
+#include "blit.h"
+#include "sprite.h"
+#include "bitmap.h"
+#include "tilemap.h"
+#include "palette.h"
+#include "blitter.h"
+#include "bitvideo.h"
 
 /***************************************************************************
  * Video Configuration
  ***************************************************************************/
 
-#define VIDEO_WIDTH         224
-#define VIDEO_HEIGHT        288
+/* Frame bitmap: the game's own raster, one row per scanline, before
+ * the orientation turns it for the display */
+#define VIDEO_WIDTH         288
+#define VIDEO_HEIGHT        224
 #define VIDEO_TILE_WIDTH    8
 #define VIDEO_TILE_HEIGHT   8
-#define VIDEO_TILES_X       28  /* 224 / 8 */
-#define VIDEO_TILES_Y       36  /* 288 / 8 */
+#define VIDEO_TILES_X       36  /* 288 / 8 */
+#define VIDEO_TILES_Y       28  /* 224 / 8 */
+#define VIDEO_TILE_COUNT    (VIDEO_TILES_X * VIDEO_TILES_Y)
 
 /***************************************************************************
  * Color Palette
  ***************************************************************************/
 
-typedef struct {
-    u8 r, g, b, a;
-} color_t;
-
+/* Entries of the hand-made fallback palette */
 #define PALETTE_SIZE 16
 
+/* Colours of the colour PROM, and colour codes of the graphics */
+#define VIDEO_COLORS        32
+#define VIDEO_COLOR_CODES   32
+
+/* Pens in the frame bitmap: four per colour code (code * 4 + pixel) */
+#define VIDEO_PENS          (VIDEO_COLOR_CODES * 4)
+
+/* Bits per pixel of the frame bitmap (8 or 16) */
+#ifndef VIDEO_BITMAP_DEPTH
+#define VIDEO_BITMAP_DEPTH  8
+#endif
+
+/***************************************************************************
+ * Render Targets
+ ***************************************************************************/
+
+#define VIDEO_FORMAT_RGBA8888   BLITTER_RGBA8888    /* One 32-bit RGBA word per pixel */
+#define VIDEO_FORMAT_YUY2       BLITTER_YUY2        /* One Y0 U Y1 V word per pixel pair (XFB) */
+
 /***************************************************************************
  * Video State
  ***************************************************************************/
 
-typedef struct {
-    /* Framebuffer */
+struct video_state;
+
+/* Driver screen update for the rows of 'clip' (partial updates) */
+typedef void (*video_update_func)(struct video_state* state, const rectangle* clip, void* param);
+
+typedef struct video_state {
+    /* Presentation target */
     u32* framebuffer;
     int fb_width;
     int fb_height;
+    int fb_pitch;             /* In 32-bit words */
+    int format;               /* VIDEO_FORMAT_xxx */
+    int orientation;          /* ROTxxx of the presented image */
+    int scale;                /* Integer zoom of the game area */
+    int x_offset, y_offset;   /* Top-left of the game area in the target */
+    blitter_func blitter;     /* Presents the bitmap in this layout */
+    
+    /* Pen colours and the target words of each pen */
+    palette_t palette;
     
-    /* Palette */
-    color_t palette[PALETTE_SIZE];
+    /* Pen tables of each colour code for the bitmap depth */
+    blit_quad8_table pen_quads[VIDEO_COLOR_CODES];
+    blit_pair16_table pen_pairs[VIDEO_COLOR_CODES];
     
-    /* Tile graphics data */
-    u8* tile_gfx;
+    /* Decoded graphics: 0 = characters, 1 = sprites */
+    gfx_element_t* gfx[MAX_GFX_ELEMENTS];
     int tile_count;
     
+    /* Frame bitmap (game's visible area) */
+    mame_bitmap* bitmap;
+    
+    /* Character layer (created by the driver), and the video RAM it
+     * reads while updating */
+    tilemap_t* tilemap;
+    const u8* tile_vram;
+    const u8* tile_cram;
+    
+    /* Write trackers on VRAM/CRAM, -1 when rendering from plain pointers */
+    int vram_tracker;
+    int cram_tracker;
+    u32 vram_base;
+    u32 cram_base;
+    u32 track_size;           /* Bytes tracked from each base */
+    
+    /* Sprites queued by the driver for this frame */
+    sprite_list_t sprites;
+    
+    /* Area tile and sprite rendering draws to: the visible area, or the
+     * band of a partial update */
+    rectangle clip;
+    
+    /* Partial updates, for drivers that change video registers mid-frame */
+    video_update_func update;
+    void* update_param;
+    int update_next;          /* First row not yet drawn this frame */
+    u32 partial_updates;      /* Bands drawn this frame */
+    
+    /* Damage: area of the frame bitmap the last frame changed, and the
+     * area the target lacks besides (a new layout, a cleared target) */
+    rectangle damage;
+    rectangle stale;
+    int present_y;            /* Target rows written by the last present */
+    int present_rows;
+    
+    /* Sprites of the last frame, to tell whether they changed */
+    sprite_t last_sprites[MAX_SPRITES];
+    int last_sprite_count;    /* -1 after a frame of several sprite lists */
+    int sprite_lists;         /* Lists rendered this frame */
+    rectangle sprite_bounds;
+    rectangle last_sprite_bounds;
+    
     /* Statistics */
     u32 frame_count;
+    u32 tiles_drawn;          /* Tiles redrawn by the last render */
+    u32 tiles_drawn_total;
     
 } video_state_t;
 
+typedef struct {
+    u32 frames;
+    u32 tiles_drawn;
+    u32 tiles_drawn_total;
+    u32 sprites_drawn;
+    
+    /* Fast paths taken by the last frame, from the pen usage of each
+     * element: blank tiles are filled, opaque ones need no mask */
+    u32 tiles_blank;
+    u32 tiles_opaque;
+    u32 tiles_masked;
+    u32 sprites_skipped;
+    u32 sprites_opaque;
+    u32 pens_updated;         /* Pens rebuilt after palette changes */
+    u32 rows_presented;       /* Target rows the last frame converted */
+} video_stats_t;
+
 /***************************************************************************
  * Video Functions
  ***************************************************************************/
@@ -61,19 +164,99 @@ typedef struct {
 int video_init(video_state_t* state, u32* framebuffer, int width, int height);
 void video_shutdown(video_state_t* state);
 
-/* Palette */
+/* Presentation target - RGBA8888 by default, or YUY2 for the external
+ * framebuffer. The game area is centred at the largest integer scale
+ * that fits. A new framebuffer in the same layout is taken to hold the
+ * last frame presented; video_add_stale adds what it lacks. */
+int video_set_target(video_state_t* state, u32* framebuffer, int width, int height, int format);
+
+/* Orientation - the game's own orientation composed with the user's
+ * setting, applied when the frame is presented */
+int video_set_orientation(video_state_t* state, int game_orientation, int user_orientation);
+
+/* Character layer - the driver's tile info callback and video RAM
+ * layout (its scan) over a cols x rows layer of 8x8 tiles. The callback
+ * is passed the video state, whose tile_vram/tile_cram point at the RAM
+ * being rendered. Tiles are not drawn until the driver creates it. */
+int video_create_tilemap(video_state_t* state, tile_get_info_func get_info, tilemap_scan_func scan,
+                         int cols, int rows);
+
+/* Graphics - decode the driver's GFX ROMs; the test tiles stay in place
+ * for any layout whose region is not loaded */
+int video_decode_gfx(video_state_t* state, const gfx_decode_info* info);
+
+/* Palette - colours and pen lookup from the colour PROMs; without them
+ * the hand-made palette is used, one entry per colour code. Changed
+ * colours are resolved when the next frame is presented and never
+ * redraw tiles. */
+int  video_decode_palette(video_state_t* state, const palette_prom_info* info);
 void video_set_palette(video_state_t* state, const color_t* palette);
 void video_set_default_palette(video_state_t* state);
+void video_set_color(video_state_t* state, int color, color_t value);
+
+/* Dirty tracking - subscribe to writes to 'size' bytes of VRAM and CRAM
+ * in the CPU address space; offsets are the tilemap's memory indices.
+ * Without it every tile is redrawn on every render. */
+int  video_track_memory(video_state_t* state, u32 vram_base, u32 cram_base, u32 size);
+void video_mark_tile_dirty(video_state_t* state, int index);
+void video_mark_all_dirty(video_state_t* state);
 
-/* Tile rendering */
+/* Tile rendering - redraws dirty tiles of the character tilemap and
+ * copies it to the frame bitmap, within the current update area */
 void video_render_tiles(video_state_t* state, 
                        const u8* vram, 
                        const u8* cram,
                        int flip_screen);
 
-/* Frame management */
+/* Bitmapped rendering - draws the bytes of 1bpp video RAM that changed
+ * into the frame bitmap, for boards without tiles. Returns the bytes
+ * drawn, or -1 if the video RAM is larger than the frame bitmap. */
+int  video_render_bitvideo(video_state_t* state, bitvideo_t* bv);
+
+/* Frame management - video_end_frame presents the frame bitmap */
 void video_begin_frame(video_state_t* state);
 void video_end_frame(video_state_t* state);
+
+/* Partial updates (opt-in). With an update function set, the driver does
+ * not render after the frame; before a mid-frame change to scroll, flip
+ * or similar registers it calls video_force_partial_update with the beam
+ * line, and the rows up to it are drawn with the old state. The rest of
+ * the frame is drawn by video_end_frame. Lines are rows of the frame
+ * bitmap. NULL turns partial updates off. */
+void video_set_update(video_state_t* state, video_update_func update, void* param);
+void video_force_partial_update(video_state_t* state, int line);
+
+/* Resolve the frame bitmap through the palette into the target: only
+ * the damaged and stale area, plus the bitmap rows holding pens whose
+ * colour changed; nothing at all if none of these is set. The target
+ * rows written are left in present_y/present_rows. */
+void video_present(video_state_t* state);
+
+/* Damage - video_end_frame works out what tiles and sprites changed;
+ * drivers that draw into the frame bitmap themselves add what they drew.
+ * Stale areas (NULL = all) are what the current target is missing,
+ * e.g. the changes since a triple-buffered XFB was last drawn. */
+void video_add_damage(video_state_t* state, const rectangle* area);
+void video_add_stale(video_state_t* state, const rectangle* area);
+
+/* Target drawing, outside the game area */
 void video_clear(video_state_t* state, color_t color);
+void video_fill_rect(video_state_t* state, int x, int y, int width, int height, color_t color);
+
+/* Sprites - the driver queues its sprites between video_begin_sprites and
+ * video_render_sprites, which composites them over the rendered tiles.
+ * Sprite colours are colour codes, like tiles. */
+sprite_list_t* video_begin_sprites(video_state_t* state);
+void video_render_sprites(video_state_t* state);
+
+/* Time the tile blitter over a full screen of tiles; returns tiles/ms */
+double video_benchmark_tiles(video_state_t* state, int iterations);
+
+/* Time presenting the frame bitmap in each orientation; returns the
+ * worst us/frame */
+double video_benchmark_orientation(video_state_t* state, int iterations);
+
+/* Statistics */
+void video_get_stats(const video_state_t* state, video_stats_t* stats);
 
 #endif /* VIDEO_H */
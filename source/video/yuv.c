@@ -0,0 +1,311 @@
+/***************************************************************************
+ * RGB to YUY2 Conversion Implementation
+ ***************************************************************************/
+
+#include "yuv.h"
+#include <stdio.h>
+#include <string.h>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
+/*
+ * Y = (77R + 150G + 29B) >> 8
+ * U = ((-38R - 74G + 112B) >> 8) + 128
+ * V = ((112R - 94G - 18B) >> 8) + 128
+ *
+ * Chroma uses the average of the pair. With 8-bit inputs Y stays within
+ * 0..255 and U/V within 16..240, so no clamping is needed.
+ */
+
+/***************************************************************************
+ * Scalar Reference
+ ***************************************************************************/
+
+static void yuv_row_scalar(u32* dst, const u32* src, int pairs) {
+    for (int i = 0; i < pairs; i++) {
+        u32 p0 = src[0], p1 = src[1];
+        int r0 = p0 >> 24, g0 = (p0 >> 16) & 0xFF, b0 = (p0 >> 8) & 0xFF;
+        int r1 = p1 >> 24, g1 = (p1 >> 16) & 0xFF, b1 = (p1 >> 8) & 0xFF;
+        int r = (r0 + r1) >> 1, g = (g0 + g1) >> 1, b = (b0 + b1) >> 1;
+        int y0 = (77 * r0 + 150 * g0 + 29 * b0) >> 8;
+        int y1 = (77 * r1 + 150 * g1 + 29 * b1) >> 8;
+        int u = ((-38 * r - 74 * g + 112 * b) >> 8) + 128;
+        int v = ((112 * r - 94 * g - 18 * b) >> 8) + 128;
+
+        dst[i] = (y0 << 24) | (u << 16) | (y1 << 8) | v;
+        src += 2;
+    }
+}
+
+/***************************************************************************
+ * Table Driven
+ ***************************************************************************/
+
+/* Products per channel value; chroma is offset by 128 << 8 up front */
+static s32 yuv_y_tab[3][256];
+static s32 yuv_u_tab[3][256];
+static s32 yuv_v_tab[3][256];
+static int yuv_tables_ready = 0;
+
+static void yuv_init_tables(void) {
+    for (int i = 0; i < 256; i++) {
+        yuv_y_tab[0][i] = 77 * i;
+        yuv_y_tab[1][i] = 150 * i;
+        yuv_y_tab[2][i] = 29 * i;
+        yuv_u_tab[0][i] = -38 * i + (128 << 8);
+        yuv_u_tab[1][i] = -74 * i;
+        yuv_u_tab[2][i] = 112 * i;
+        yuv_v_tab[0][i] = 112 * i + (128 << 8);
+        yuv_v_tab[1][i] = -94 * i;
+        yuv_v_tab[2][i] = -18 * i;
+    }
+    yuv_tables_ready = 1;
+}
+
+static void yuv_row_lut(u32* dst, const u32* src, int pairs) {
+    for (int i = 0; i < pairs; i++) {
+        u32 p0 = src[0], p1 = src[1];
+        int r0 = p0 >> 24, g0 = (p0 >> 16) & 0xFF, b0 = (p0 >> 8) & 0xFF;
+        int r1 = p1 >> 24, g1 = (p1 >> 16) & 0xFF, b1 = (p1 >> 8) & 0xFF;
+        int r = (r0 + r1) >> 1, g = (g0 + g1) >> 1, b = (b0 + b1) >> 1;
+        u32 y0 = (yuv_y_tab[0][r0] + yuv_y_tab[1][g0] + yuv_y_tab[2][b0]) >> 8;
+        u32 y1 = (yuv_y_tab[0][r1] + yuv_y_tab[1][g1] + yuv_y_tab[2][b1]) >> 8;
+        u32 u = (yuv_u_tab[0][r] + yuv_u_tab[1][g] + yuv_u_tab[2][b]) >> 8;
+        u32 v = (yuv_v_tab[0][r] + yuv_v_tab[1][g] + yuv_v_tab[2][b]) >> 8;
+
+        dst[i] = (y0 << 24) | (u << 16) | (y1 << 8) | v;
+        src += 2;
+    }
+}
+
+/***************************************************************************
+ * SSE2 / AVX2 (host builds)
+ ***************************************************************************/
+
+#ifdef __SSE2__
+/* Four pixels in 32-bit lanes -> YUY2 words in lanes 0 and 2 */
+static INLINE __m128i yuv_sse2_quad(__m128i px) {
+    const __m128i mask = _mm_set1_epi32(0xFF);
+    __m128i r = _mm_srli_epi32(px, 24);
+    __m128i g = _mm_and_si128(_mm_srli_epi32(px, 16), mask);
+    __m128i b = _mm_and_si128(_mm_srli_epi32(px, 8), mask);
+    __m128i y, ra, ga, ba, u, v;
+
+    /* Values sit in the low half of each lane, so madd is a 32-bit multiply */
+    y = _mm_add_epi32(_mm_add_epi32(_mm_madd_epi16(r, _mm_set1_epi32(77)),
+                                    _mm_madd_epi16(g, _mm_set1_epi32(150))),
+                      _mm_madd_epi16(b, _mm_set1_epi32(29)));
+    y = _mm_srli_epi32(y, 8);
+
+    /* Pair sums land in the even lanes */
+    ra = _mm_srli_epi32(_mm_add_epi32(r, _mm_srli_epi64(r, 32)), 1);
+    ga = _mm_srli_epi32(_mm_add_epi32(g, _mm_srli_epi64(g, 32)), 1);
+    ba = _mm_srli_epi32(_mm_add_epi32(b, _mm_srli_epi64(b, 32)), 1);
+
+    u = _mm_add_epi32(_mm_add_epi32(_mm_madd_epi16(ra, _mm_set1_epi32(0xFFFF & -38)),
+                                    _mm_madd_epi16(ga, _mm_set1_epi32(0xFFFF & -74))),
+                      _mm_madd_epi16(ba, _mm_set1_epi32(112)));
+    v = _mm_add_epi32(_mm_add_epi32(_mm_madd_epi16(ra, _mm_set1_epi32(112)),
+                                    _mm_madd_epi16(ga, _mm_set1_epi32(0xFFFF & -94))),
+                      _mm_madd_epi16(ba, _mm_set1_epi32(0xFFFF & -18)));
+    u = _mm_add_epi32(_mm_srai_epi32(u, 8), _mm_set1_epi32(128));
+    v = _mm_add_epi32(_mm_srai_epi32(v, 8), _mm_set1_epi32(128));
+
+    return _mm_or_si128(_mm_or_si128(_mm_slli_epi32(y, 24), _mm_slli_epi32(u, 16)),
+                        _mm_or_si128(_mm_slli_epi32(_mm_srli_epi64(y, 32), 8), v));
+}
+
+static void yuv_row_sse2(u32* dst, const u32* src, int pairs) {
+    int i = 0;
+
+    for (; i + 4 <= pairs; i += 4) {
+        __m128i a = yuv_sse2_quad(_mm_loadu_si128((const __m128i*)(src + 2 * i)));
+        __m128i b = yuv_sse2_quad(_mm_loadu_si128((const __m128i*)(src + 2 * i + 4)));
+
+        a = _mm_shuffle_epi32(a, _MM_SHUFFLE(3, 1, 2, 0));
+        b = _mm_shuffle_epi32(b, _MM_SHUFFLE(3, 1, 2, 0));
+        _mm_storeu_si128((__m128i*)(dst + i), _mm_unpacklo_epi64(a, b));
+    }
+    yuv_row_lut(dst + i, src + 2 * i, pairs - i);
+}
+#endif
+
+#ifdef __AVX2__
+static INLINE __m256i yuv_avx2_oct(__m256i px) {
+    const __m256i mask = _mm256_set1_epi32(0xFF);
+    __m256i r = _mm256_srli_epi32(px, 24);
+    __m256i g = _mm256_and_si256(_mm256_srli_epi32(px, 16), mask);
+    __m256i b = _mm256_and_si256(_mm256_srli_epi32(px, 8), mask);
+    __m256i y, ra, ga, ba, u, v;
+
+    y = _mm256_add_epi32(_mm256_add_epi32(_mm256_madd_epi16(r, _mm256_set1_epi32(77)),
+                                          _mm256_madd_epi16(g, _mm256_set1_epi32(150))),
+                         _mm256_madd_epi16(b, _mm256_set1_epi32(29)));
+    y = _mm256_srli_epi32(y, 8);
+
+    ra = _mm256_srli_epi32(_mm256_add_epi32(r, _mm256_srli_epi64(r, 32)), 1);
+    ga = _mm256_srli_epi32(_mm256_add_epi32(g, _mm256_srli_epi64(g, 32)), 1);
+    ba = _mm256_srli_epi32(_mm256_add_epi32(b, _mm256_srli_epi64(b, 32)), 1);
+
+    u = _mm256_add_epi32(_mm256_add_epi32(_mm256_madd_epi16(ra, _mm256_set1_epi32(0xFFFF & -38)),
+                                          _mm256_madd_epi16(ga, _mm256_set1_epi32(0xFFFF & -74))),
+                         _mm256_madd_epi16(ba, _mm256_set1_epi32(112)));
+    v = _mm256_add_epi32(_mm256_add_epi32(_mm256_madd_epi16(ra, _mm256_set1_epi32(112)),
+                                          _mm256_madd_epi16(ga, _mm256_set1_epi32(0xFFFF & -94))),
+                         _mm256_madd_epi16(ba, _mm256_set1_epi32(0xFFFF & -18)));
+    u = _mm256_add_epi32(_mm256_srai_epi32(u, 8), _mm256_set1_epi32(128));
+    v = _mm256_add_epi32(_mm256_srai_epi32(v, 8), _mm256_set1_epi32(128));
+
+    return _mm256_or_si256(_mm256_or_si256(_mm256_slli_epi32(y, 24), _mm256_slli_epi32(u, 16)),
+                           _mm256_or_si256(_mm256_slli_epi32(_mm256_srli_epi64(y, 32), 8), v));
+}
+
+static void yuv_row_avx2(u32* dst, const u32* src, int pairs) {
+    int i = 0;
+
+    for (; i + 8 <= pairs; i += 8) {
+        __m256i a = yuv_avx2_oct(_mm256_loadu_si256((const __m256i*)(src + 2 * i)));
+        __m256i b = yuv_avx2_oct(_mm256_loadu_si256((const __m256i*)(src + 2 * i + 8)));
+
+        /* Even lanes hold the words: gather each vector's four into its low half */
+        a = _mm256_permutevar8x32_epi32(a, _mm256_setr_epi32(0, 2, 4, 6, 1, 3, 5, 7));
+        b = _mm256_permutevar8x32_epi32(b, _mm256_setr_epi32(0, 2, 4, 6, 1, 3, 5, 7));
+        _mm256_storeu_si256((__m256i*)(dst + i), _mm256_permute2x128_si256(a, b, 0x20));
+    }
+    yuv_row_lut(dst + i, src + 2 * i, pairs - i);
+}
+#endif
+
+/***************************************************************************
+ * Converter Table
+ ***************************************************************************/
+
+const yuv_converter yuv_converters[] = {
+    { "scalar", yuv_row_scalar },
+    { "lut",    yuv_row_lut },
+#ifdef __SSE2__
+    { "sse2",   yuv_row_sse2 },
+#endif
+#ifdef __AVX2__
+    { "avx2",   yuv_row_avx2 },
+#endif
+};
+
+const int yuv_converter_count = sizeof(yuv_converters) / sizeof(yuv_converters[0]);
+
+static yuv_row_func yuv_current = NULL;
+
+int yuv_select(int index) {
+    if (!yuv_tables_ready) {
+        yuv_init_tables();
+    }
+
+    if (index < 0) {
+        index = yuv_converter_count - 1;
+    }
+    if (index >= yuv_converter_count) {
+        printf("ERROR: No YUV converter %d\n", index);
+        return -1;
+    }
+
+    yuv_current = yuv_converters[index].convert_row;
+    return 0;
+}
+
+/***************************************************************************
+ * Conversion
+ ***************************************************************************/
+
+void yuv_convert(u32* dst, int dst_pitch, const u32* src, int src_pitch,
+                 int width, int height, const rectangle* rect) {
+    int x0 = 0, x1 = width - 1, y0 = 0, y1 = height - 1;
+
+    if (!yuv_current) {
+        yuv_select(-1);
+    }
+
+    if (rect) {
+        x0 = MAX(rect->min_x, 0);
+        x1 = MIN(rect->max_x, width - 1);
+        y0 = MAX(rect->min_y, 0);
+        y1 = MIN(rect->max_y, height - 1);
+    }
+    if (x0 > x1 || y0 > y1) {
+        return;
+    }
+
+    /* Widen to whole pixel pairs */
+    x0 >>= 1;
+    x1 >>= 1;
+
+    for (int y = y0; y <= y1; y++) {
+        yuv_current(dst + y * dst_pitch + x0, src + y * src_pitch + 2 * x0, x1 - x0 + 1);
+    }
+}
+
+/***************************************************************************
+ * Benchmark
+ ***************************************************************************/
+
+int yuv_benchmark(int iterations) {
+    const int width = 640, height = 480;
+    u32* src = (u32*)osd_memalign_tagged(32, width * height * sizeof(u32), OSD_MEM_VIDEO);
+    u32* ref = (u32*)osd_memalign_tagged(32, width / 2 * height * sizeof(u32), OSD_MEM_VIDEO);
+    u32* dst = (u32*)osd_memalign_tagged(32, width / 2 * height * sizeof(u32), OSD_MEM_VIDEO);
+    yuv_row_func saved = yuv_current;
+    u32 seed = 0x12345678;
+    int mismatches = 0;
+
+    if (!src || !ref || !dst) {
+        printf("ERROR: Failed to allocate YUV benchmark buffers\n");
+        osd_free(src);
+        osd_free(ref);
+        osd_free(dst);
+        return -1;
+    }
+
+    /* Noise exercises every channel value */
+    for (int i = 0; i < width * height; i++) {
+        seed = seed * 1103515245 + 12345;
+        src[i] = seed;
+    }
+
+    yuv_select(0);
+    yuv_convert(ref, width / 2, src, width, width, height, NULL);
+
+    for (int n = 0; n < yuv_converter_count; n++) {
+        UINT64 start, elapsed;
+        int bad = 0;
+
+        yuv_select(n);
+        memset(dst, 0, width / 2 * height * sizeof(u32));
+
+        start = osd_ticks_us();
+        for (int i = 0; i < iterations; i++) {
+            yuv_convert(dst, width / 2, src, width, width, height, NULL);
+        }
+        elapsed = osd_ticks_us() - start;
+
+        for (int i = 0; i < width / 2 * height; i++) {
+            if (dst[i] != ref[i]) {
+                bad++;
+            }
+        }
+        mismatches += bad;
+
+        printf("YUV %-6s: %u frames in %u us, %u us/frame%s\n",
+               yuv_converters[n].name, iterations, (u32)elapsed,
+               iterations ? (u32)(elapsed / iterations) : 0, bad ? " MISMATCH" : "");
+    }
+
+    yuv_current = saved;
+    osd_free(src);
+    osd_free(ref);
+    osd_free(dst);
+    return mismatches;
+}
@@ -0,0 +1,50 @@
+/***************************************************************************
+ * RGB to YUY2 Conversion for GameCube
+ *
+ * Converts 32-bit RGBA8888 bitmaps (r << 24 | g << 16 | b << 8 | a) into
+ * the YUY2 words of the external framebuffer, using the same integer
+ * ITU-R BT.601 weights as the blitters' pair tables. Several row
+ * converters produce identical output:
+ *
+ *   scalar  - reference arithmetic
+ *   lut     - per-channel product tables, no multiplies (GameCube)
+ *   sse2    - host builds with SSE2, four pixel pairs per step
+ *   avx2    - host builds with AVX2, eight pixel pairs per step
+ ***************************************************************************/
+
+#ifndef YUV_H
+#define YUV_H
+
+#include "../mame2003/osd_gc.h"
+#include "blit.h"
+
+/* Convert 'pairs' pixel pairs of one row */
+typedef void (*yuv_row_func)(u32* dst, const u32* src, int pairs);
+
+typedef struct {
+    const char* name;
+    yuv_row_func convert_row;
+} yuv_converter;
+
+/* Available converters; the last one is the fastest for this build */
+extern const yuv_converter yuv_converters[];
+extern const int yuv_converter_count;
+
+/***************************************************************************
+ * Functions
+ ***************************************************************************/
+
+/* Choose the converter used by yuv_convert (-1 = fastest available) */
+int  yuv_select(int index);
+
+/* Convert a width x height RGBA bitmap (src_pitch in pixels) into a YUY2
+ * bitmap (dst_pitch in 32-bit words). Only the pixel pairs covering rect
+ * are converted; NULL converts everything. width must be even. */
+void yuv_convert(u32* dst, int dst_pitch, const u32* src, int src_pitch,
+                 int width, int height, const rectangle* rect);
+
+/* Time every converter on 640x480 frames and check each against the
+ * scalar reference; returns the number of mismatching words */
+int  yuv_benchmark(int iterations);
+
+#endif /* YUV_H */
@@ -0,0 +1,21 @@
+/***************************************************************************
+ * 1bpp Video Benchmark
+ *
+ * Times plotting each pixel, the LUT redraw and the dirty redraw of a
+ * 256x224 Invaders-style screen, and fails if either redraw disagrees
+ * with the plotted image.
+ ***************************************************************************/
+
+#include "bitvideo.h"
+
+#define ITERATIONS      200
+
+int main(void) {
+    int mismatches = bitvideo_benchmark(ITERATIONS);
+
+    if (mismatches != 0) {
+        printf("ERROR: 1bpp redraws disagree with plotting each pixel (%d)\n", mismatches);
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,97 @@
+/***************************************************************************
+ * Tile Benchmark
+ *
+ * The tile blitter over a screen of tiles (video_benchmark_tiles), then
+ * the Pac-Man character layer redrawn whole every frame against only
+ * the tiles a frame of play writes, found through the VRAM/CRAM write
+ * trackers. Fails if the tracked frame differs from a full redraw.
+ ***************************************************************************/
+
+#include "video.h"
+#include "memory.h"
+#include "pacman.h"
+
+#define ITERATIONS      200
+#define FRAMES          600
+#define WRITES          16      /* VRAM/CRAM bytes written per frame */
+
+static u32 framebuffer[640 * 480];
+static u8 vram[PACMAN_VIDEO_RAM_SIZE], cram[PACMAN_COLOR_RAM_SIZE];
+static u8 tracked[VIDEO_HEIGHT][VIDEO_WIDTH * VIDEO_BITMAP_DEPTH / 8];
+
+static void render(video_state_t* video) {
+    video_begin_frame(video);
+    video_render_tiles(video, vram, cram, 0);
+    video_end_frame(video);
+}
+
+int main(void) {
+    video_state_t video;
+    pacman_state_t pacman;
+    u32 seed = 0x1234ABCD;
+    UINT64 start, full_us, tracked_us;
+    u32 full_tiles = 0, tracked_tiles = 0;
+    int mismatches = 0;
+
+    memory_init();
+    if (video_init(&video, framebuffer, 640, 480) != 0 || pacman_video_start(&pacman, &video) != 0) {
+        return 1;
+    }
+    for (int i = 0; i < PACMAN_VIDEO_RAM_SIZE; i++) {
+        seed = seed * 1103515245 + 12345;
+        vram[i] = seed >> 24;
+        cram[i] = seed >> 16;
+    }
+    memory_map_ram(PACMAN_VRAM_BASE, PACMAN_VRAM_END, vram);
+    memory_map_ram(PACMAN_CRAM_BASE, PACMAN_CRAM_END, cram);
+    if (video_track_memory(&video, PACMAN_VRAM_BASE, PACMAN_CRAM_BASE, PACMAN_VIDEO_RAM_SIZE) != 0) {
+        return 1;
+    }
+
+    video_benchmark_tiles(&video, ITERATIONS);
+
+    /* Every tile, every frame */
+    start = osd_ticks_us();
+    for (int frame = 0; frame < FRAMES; frame++) {
+        video_mark_all_dirty(&video);
+        render(&video);
+        full_tiles += video.tiles_drawn;
+    }
+    full_us = osd_ticks_us() - start;
+
+    /* Only what the CPU wrote */
+    start = osd_ticks_us();
+    for (int frame = 0; frame < FRAMES; frame++) {
+        for (int i = 0; i < WRITES; i++) {
+            seed = seed * 1103515245 + 12345;
+            memory_write_byte(((seed >> 8) & 1 ? PACMAN_CRAM_BASE : PACMAN_VRAM_BASE) +
+                              (seed >> 16) % PACMAN_VIDEO_RAM_SIZE, seed >> 24);
+        }
+        render(&video);
+        tracked_tiles += video.tiles_drawn;
+    }
+    tracked_us = osd_ticks_us() - start;
+
+    printf("Tiles full redraw:  %6.1f us/frame, %u tiles/frame\n",
+           (double)full_us / FRAMES, full_tiles / FRAMES);
+    printf("Tiles tracked:      %6.1f us/frame, %u tiles/frame (%d bytes written)\n",
+           (double)tracked_us / FRAMES, tracked_tiles / FRAMES, WRITES);
+
+    /* The tracked frame must be the frame a full redraw gives */
+    for (int y = 0; y < VIDEO_HEIGHT; y++) {
+        memcpy(tracked[y], video.bitmap->line[y], sizeof(tracked[y]));
+    }
+    video_mark_all_dirty(&video);
+    render(&video);
+    for (int y = 0; y < VIDEO_HEIGHT; y++) {
+        mismatches += memcmp(tracked[y], video.bitmap->line[y], sizeof(tracked[y])) != 0;
+    }
+
+    video_shutdown(&video);
+    memory_shutdown();
+    if (mismatches) {
+        printf("ERROR: %d rows of the tracked frame differ from a full redraw\n", mismatches);
+        return 1;
+    }
+    return 0;
+}
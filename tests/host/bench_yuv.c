@@ -0,0 +1,21 @@
+/***************************************************************************
+ * YUV Conversion Benchmark
+ *
+ * Times every converter compiled into this build (SSE2 and AVX2 follow
+ * HOST_ARCH) over a 640x480 frame of noise and fails if any of them
+ * disagrees with the scalar reference.
+ ***************************************************************************/
+
+#include "yuv.h"
+
+#define ITERATIONS      200
+
+int main(void) {
+    int mismatches = yuv_benchmark(ITERATIONS);
+
+    if (mismatches != 0) {
+        printf("ERROR: YUV converters disagree with the reference (%d)\n", mismatches);
+        return 1;
+    }
+    return 0;
+}
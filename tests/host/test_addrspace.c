@@ -0,0 +1,211 @@
+/***************************************************************************
+ * Address Space Test
+ *
+ * 16-bit address spaces of both CPU endiannesses, so one of them is
+ * word swapped on any host. Byte, word and long accesses to ROM (loaded
+ * before and after the region is prepared), RAM, word-wide and
+ * byte-wide handler pages, and longs straddling a page boundary, all
+ * against a plain byte image of the CPU's memory.
+ ***************************************************************************/
+
+#include "addrspace.h"
+#include "memory.h"
+
+#define ADDR_BITS       24
+#define PAGE_BITS       12
+#define PAGE_SIZE       (1 << PAGE_BITS)
+
+#define ROM1_BASE       0x000000
+#define ROM2_BASE       0x010000
+#define ROM_SIZE        0x10000
+#define RAM_BASE        0x100000
+#define RAM_SIZE        0x4000
+#define WORDIO_BASE     0x200000
+#define BYTEIO_BASE     0x201000
+#define IO_SIZE         PAGE_SIZE
+
+/* The CPU's view, one byte per address */
+static UINT8 image[0x202000];
+static UINT8 rom[ROM_SIZE];
+static UINT8 ram[RAM_SIZE];
+static int big;
+static int errors = 0;
+
+/* Devices: a word-wide one without byte strobes and a byte-wide one,
+ * each with its own storage in the CPU's byte order */
+static UINT8 word_mem[IO_SIZE];
+static UINT8 byte_mem[IO_SIZE];
+
+static UINT16 word_read(address_space_t* space, UINT32 address) {
+    UINT8* m = &word_mem[address - WORDIO_BASE];
+
+    return big ? (m[0] << 8) | m[1] : (m[1] << 8) | m[0];
+}
+
+static void word_write(address_space_t* space, UINT32 address, UINT16 data) {
+    UINT8* m = &word_mem[address - WORDIO_BASE];
+
+    m[big ? 0 : 1] = data >> 8;
+    m[big ? 1 : 0] = data & 0xFF;
+}
+
+static UINT8 byte_read(address_space_t* space, UINT32 address) {
+    return byte_mem[address - BYTEIO_BASE];
+}
+
+static void byte_write(address_space_t* space, UINT32 address, UINT8 data) {
+    byte_mem[address - BYTEIO_BASE] = data;
+}
+
+static const address_space_handlers_t word_device = { NULL, word_read, NULL, word_write };
+static const address_space_handlers_t byte_device = { byte_read, NULL, byte_write, NULL };
+
+/* Expected values from the image */
+static UINT16 ref16(UINT32 a) {
+    return big ? (image[a] << 8) | image[a + 1] : (image[a + 1] << 8) | image[a];
+}
+
+static UINT32 ref32(UINT32 a) {
+    return big ? ((UINT32)ref16(a) << 16) | ref16(a + 2) : ((UINT32)ref16(a + 2) << 16) | ref16(a);
+}
+
+static void ref_write16(UINT32 a, UINT16 data) {
+    image[a + (big ? 0 : 1)] = data >> 8;
+    image[a + (big ? 1 : 0)] = data & 0xFF;
+}
+
+static void ref_write32(UINT32 a, UINT32 data) {
+    ref_write16(a + (big ? 0 : 2), data >> 16);
+    ref_write16(a + (big ? 2 : 0), data & 0xFFFF);
+}
+
+static void check_range(address_space_t* space, const char* what, UINT32 start, UINT32 size) {
+    int bad = 0;
+
+    for (UINT32 a = start; a < start + size; a++) {
+        bad += address_space_read8(space, a) != image[a];
+        if (!(a & 1)) {
+            bad += address_space_read16(space, a) != ref16(a);
+            if (a + 4 <= start + size) {
+                bad += address_space_read32(space, a) != ref32(a);
+            }
+        }
+    }
+    if (bad) {
+        printf("ERROR: %s-endian %s: %d reads differ\n", big ? "Big" : "Little", what, bad);
+        errors++;
+    }
+}
+
+static void test_space(int endianness) {
+    address_space_t* space;
+    u32 seed = 0x0F1E2D3C;
+    int bad = 0;
+
+    big = (endianness == AS_ENDIAN_BIG);
+    memory_init();
+    memset(image, 0, sizeof(image));
+    memset(ram, 0, sizeof(ram));
+    memset(word_mem, 0, sizeof(word_mem));
+    memset(byte_mem, 0, sizeof(byte_mem));
+
+    space = address_space_create(big ? "big" : "little", ADDR_BITS, PAGE_BITS, 16, endianness);
+    if (!space || memory_region_alloc(REGION_CPU1, ROM_SIZE, "ROM 1") != 0 ||
+        memory_region_alloc(REGION_CPU2, ROM_SIZE, "ROM 2") != 0) {
+        errors++;
+        return;
+    }
+
+    /* ROM 1 is loaded into a prepared region, ROM 2 prepared after */
+    for (int i = 0; i < ROM_SIZE; i++) {
+        seed = seed * 1103515245 + 12345;
+        rom[i] = seed >> 24;
+        image[ROM1_BASE + i] = rom[i];
+        image[ROM2_BASE + i] = rom[i] ^ 0x5A;
+    }
+    address_space_prepare_region(space, REGION_CPU1);
+    memory_load_rom(REGION_CPU1, rom, ROM_SIZE);
+    for (int i = 0; i < ROM_SIZE; i++) {
+        rom[i] ^= 0x5A;
+    }
+    memory_load_rom(REGION_CPU2, rom, ROM_SIZE);
+    address_space_prepare_region(space, REGION_CPU2);
+
+    address_space_map_rom(space, ROM1_BASE, ROM1_BASE + ROM_SIZE - 1, memory_region_get_base(REGION_CPU1));
+    address_space_map_rom(space, ROM2_BASE, ROM2_BASE + ROM_SIZE - 1, memory_region_get_base(REGION_CPU2));
+    address_space_map_ram(space, RAM_BASE, RAM_BASE + RAM_SIZE - 1, ram);
+    address_space_install_handlers(space, WORDIO_BASE, WORDIO_BASE + IO_SIZE - 1, &word_device);
+    address_space_install_handlers(space, BYTEIO_BASE, BYTEIO_BASE + IO_SIZE - 1, &byte_device);
+
+    check_range(space, "ROM loaded after preparing", ROM1_BASE, ROM_SIZE);
+    check_range(space, "ROM prepared after loading", ROM2_BASE, ROM_SIZE);
+
+    /* ROM ignores writes */
+    address_space_write16(space, ROM1_BASE + 0x100, 0x1234);
+    address_space_write32(space, ROM1_BASE + 0x200, 0x12345678);
+    check_range(space, "ROM after writes", ROM1_BASE, 0x400);
+
+    /* Random writes of every width to RAM and the devices, each read
+     * back at once; longs include ones straddling pages */
+    for (int i = 0; i < 20000; i++) {
+        static const UINT32 bases[] = { RAM_BASE, WORDIO_BASE, BYTEIO_BASE };
+        UINT32 base, size, a, data;
+
+        seed = seed * 1103515245 + 12345;
+        base = bases[(seed >> 8) % 3];
+        size = (base == RAM_BASE) ? RAM_SIZE : IO_SIZE;
+        a = base + ((seed >> 12) % (size - 4));
+        seed = seed * 1103515245 + 12345;
+        data = seed;
+
+        switch (i % 3) {
+        case 0:
+            /* A word device sees a lone byte on both lanes */
+            address_space_write8(space, a, data);
+            if (base == WORDIO_BASE) {
+                ref_write16(a & ~1, (data & 0xFF) * 0x0101);
+            } else {
+                image[a] = data;
+            }
+            break;
+        case 1:
+            address_space_write16(space, a, data);
+            ref_write16(a & ~1, data);
+            break;
+        default:
+            address_space_write32(space, a, data);
+            ref_write32(a & ~1, data);
+            break;
+        }
+        if (address_space_read32(space, a & ~1) != ref32(a & ~1)) {
+            bad++;
+        }
+    }
+    if (bad) {
+        printf("ERROR: %s-endian: %d writes read back wrong\n", big ? "Big" : "Little", bad);
+        errors++;
+    }
+    check_range(space, "RAM", RAM_BASE, RAM_SIZE);
+    check_range(space, "word-wide handlers", WORDIO_BASE, IO_SIZE);
+    check_range(space, "byte-wide handlers", BYTEIO_BASE, IO_SIZE);
+
+    /* Unmapped space reads as 0xFF */
+    if (address_space_read16(space, 0x300000) != 0xFFFF) {
+        printf("ERROR: Unmapped word reads %04X\n", address_space_read16(space, 0x300000));
+        errors++;
+    }
+
+    address_space_destroy(space);
+    memory_shutdown();
+}
+
+int main(void) {
+    test_space(AS_ENDIAN_BIG);
+    test_space(AS_ENDIAN_LITTLE);
+
+    if (errors) {
+        return 1;
+    }
+    printf("Address spaces: both endiannesses match the CPU's view\n");
+    return 0;
+}
@@ -0,0 +1,178 @@
+/***************************************************************************
+ * 1bpp Video Test
+ *
+ * Invaders-style video RAM mapped into the CPU address space and tracked:
+ * after CPU writes, only the bytes whose value changed are drawn, the
+ * damage covers them, and the frame bitmap matches every pixel plotted
+ * through the overlay - at both bitmap depths, and for both bit orders.
+ * Video RAM larger than the frame bitmap is refused, not cut short.
+ ***************************************************************************/
+
+#include "video.h"
+#include "memory.h"
+
+#define VRAM_BASE       0x2400
+#define WIDTH           256
+#define HEIGHT          224
+#define PITCH           (WIDTH / 8)
+#define SIZE            (PITCH * HEIGHT)
+
+static u8 vram[SIZE];
+static int errors = 0;
+
+/* Overlay: red band at the top of the upright screen, green near the
+ * bottom, white elsewhere */
+static int ink(int x) {
+    return (x >= 184 && x <= 239) ? 2 : (x >= 12 && x <= 68) ? 3 : 1;
+}
+
+static int paper(int x) {
+    return (x >= 184 && x <= 239) ? 4 : 0;
+}
+
+static int mismatched_rows(const mame_bitmap* bitmap, int lsb_first) {
+    int rows = 0;
+
+    for (int y = 0; y < HEIGHT; y++) {
+        int bad = 0;
+
+        for (int x = 0; x < WIDTH; x++) {
+            int data = vram[y * PITCH + x / 8];
+            int bit = (data >> (lsb_first ? x & 7 : 7 - (x & 7))) & 1;
+            int want = bit ? ink(x) : paper(x);
+            int got = (bitmap->depth == 8) ? ((u8*)bitmap->line[y])[x] : ((u16*)bitmap->line[y])[x];
+
+            bad |= got != want;
+        }
+        rows += bad;
+    }
+    return rows;
+}
+
+static void set_overlay(bitvideo_t* bv) {
+    bitvideo_set_colors(bv, 0, WIDTH - 1, 1, 0);
+    bitvideo_set_colors(bv, 184, 239, 2, 4);
+    bitvideo_set_colors(bv, 12, 68, 3, 0);
+}
+
+static void test_tracked(int depth, int lsb_first) {
+    mame_bitmap* bitmap = bitmap_alloc_depth(VIDEO_WIDTH, VIDEO_HEIGHT, depth);
+    bitvideo_t* bv = bitvideo_create(vram, WIDTH, HEIGHT, depth, lsb_first);
+    u32 seed = 0x600DF00D;
+    int drawn;
+
+    if (!bitmap || !bv || bitvideo_track_memory(bv, VRAM_BASE) != 0) {
+        errors++;
+        return;
+    }
+    set_overlay(bv);
+
+    /* First draw: everything */
+    drawn = bitvideo_draw(bv, bitmap);
+    if (drawn != SIZE || mismatched_rows(bitmap, lsb_first)) {
+        printf("ERROR: %d-bit first draw: %d bytes, %d rows wrong\n", depth, drawn,
+               mismatched_rows(bitmap, lsb_first));
+        errors++;
+    }
+
+    /* Frames of CPU writes: some change a byte, some store its value
+     * again; only the changes are drawn */
+    for (int frame = 0; frame < 50; frame++) {
+        static u8 before[SIZE];
+        int changed = 0;
+        int min_y = HEIGHT, max_y = -1;
+
+        memcpy(before, vram, SIZE);
+        for (int i = 0; i < 40; i++) {
+            int offset;
+
+            seed = seed * 1103515245 + 12345;
+            offset = (seed >> 8) % SIZE;
+            memory_write_byte(VRAM_BASE + offset, (seed >> 28) & 1 ? vram[offset] : seed >> 20);
+        }
+        for (int offset = 0; offset < SIZE; offset++) {
+            if (vram[offset] != before[offset]) {
+                changed++;
+                min_y = MIN(min_y, offset / PITCH);
+                max_y = MAX(max_y, offset / PITCH);
+            }
+        }
+
+        drawn = bitvideo_draw(bv, bitmap);
+        if (mismatched_rows(bitmap, lsb_first)) {
+            printf("ERROR: %d-bit frame %d: %d rows wrong\n", depth, frame,
+                   mismatched_rows(bitmap, lsb_first));
+            errors++;
+            break;
+        }
+        if (drawn != changed || (changed && (bv->damage.min_y > min_y || bv->damage.max_y < max_y))) {
+            printf("ERROR: %d-bit frame %d: %d bytes drawn for %d changed, damage rows %d-%d\n",
+                   depth, frame, drawn, changed, bv->damage.min_y, bv->damage.max_y);
+            errors++;
+            break;
+        }
+    }
+
+    /* Storing the same values again draws nothing */
+    for (int offset = 0; offset < SIZE; offset += 7) {
+        memory_write_byte(VRAM_BASE + offset, vram[offset]);
+    }
+    drawn = bitvideo_draw(bv, bitmap);
+    if (drawn != 0 || !rect_is_empty(&bv->damage)) {
+        printf("ERROR: %d-bit rewrite of the same values drew %d bytes\n", depth, drawn);
+        errors++;
+    }
+
+    bitvideo_free(bv);
+    bitmap_free(bitmap);
+}
+
+int main(void) {
+    static u32 framebuffer[640 * 480];
+    static u8 tall[PITCH * (VIDEO_HEIGHT + 8)];
+    video_state_t video;
+    bitvideo_t* bv;
+    u32 seed = 0xC0FFEE;
+
+    memory_init();
+    memory_map_ram(VRAM_BASE, VRAM_BASE + SIZE - 1, vram);
+    for (int i = 0; i < SIZE; i++) {
+        seed = seed * 1103515245 + 12345;
+        vram[i] = seed >> 24;
+    }
+
+    test_tracked(8, 1);
+    test_tracked(16, 1);
+    test_tracked(8, 0);
+
+    /* Through the video system: the whole screen fits, and its damage
+     * reaches the frame */
+    if (video_init(&video, framebuffer, 640, 480) != 0) {
+        return 1;
+    }
+    bv = bitvideo_create(vram, WIDTH, HEIGHT, VIDEO_BITMAP_DEPTH, 1);
+    set_overlay(bv);
+    video_begin_frame(&video);
+    if (video_render_bitvideo(&video, bv) != SIZE || mismatched_rows(video.bitmap, 1) ||
+        video.damage.max_x != WIDTH - 1 || video.damage.max_y != HEIGHT - 1) {
+        printf("ERROR: Frame bitmap does not hold the whole 1bpp screen\n");
+        errors++;
+    }
+    bitvideo_free(bv);
+
+    /* Taller than the frame: refused */
+    bv = bitvideo_create(tall, WIDTH, VIDEO_HEIGHT + 8, VIDEO_BITMAP_DEPTH, 1);
+    if (video_render_bitvideo(&video, bv) != -1) {
+        printf("ERROR: 1bpp video taller than the frame was drawn\n");
+        errors++;
+    }
+    bitvideo_free(bv);
+    video_shutdown(&video);
+    memory_shutdown();
+
+    if (errors) {
+        return 1;
+    }
+    printf("1bpp video: tracked redraws match the plotted screen\n");
+    return 0;
+}
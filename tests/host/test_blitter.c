@@ -0,0 +1,125 @@
+/***************************************************************************
+ * Presentation Blitter Test
+ *
+ * Every generated blitter (depth, format, zoom, orientation) against a
+ * pixel-by-pixel reference through the palette, into targets with
+ * padded pitches.
+ ***************************************************************************/
+
+#include "blitter.h"
+
+/* Pen of oriented pixel (x, y), from the frame bitmap */
+static int oriented_pen(const mame_bitmap* src, int orientation, int x, int y) {
+    int swap = orientation & ORIENTATION_SWAP_XY;
+    int ow = swap ? src->height : src->width;
+    int oh = swap ? src->width : src->height;
+
+    if (orientation & ORIENTATION_FLIP_X) {
+        x = ow - 1 - x;
+    }
+    if (orientation & ORIENTATION_FLIP_Y) {
+        y = oh - 1 - y;
+    }
+    return swap ? read_pixel(src, y, x) : read_pixel(src, x, y);
+}
+
+int main(void) {
+    palette_t palette;
+    int errors = 0;
+    int checks = 0;
+
+    if (palette_init(&palette, 32, 32, 4) != 0) {
+        return 1;
+    }
+    for (int i = 0; i < 32; i++) {
+        color_t c = { i * 8, 255 - i * 7, i * 3, 255 };
+
+        palette_set_color(&palette, i, c);
+    }
+    for (int pen = 0; pen < 128; pen++) {
+        palette_set_pen_color(&palette, pen, (pen * 7) % 32);
+    }
+    palette_update(&palette);
+
+    /* Pen counts the blitters cannot mask are refused */
+    {
+        palette_t odd;
+
+        errors += palette_init(&odd, 32, 24, 4) == 0;
+        checks++;
+    }
+
+    for (int depth = 8; depth <= 16; depth += 8) {
+        mame_bitmap* src = bitmap_alloc_depth(22, 30, depth);
+
+        if (!src) {
+            return 1;
+        }
+        for (int y = 0; y < 30; y++) {
+            for (int x = 0; x < 22; x++) {
+                plot_pixel(src, x, y, (x * 13 + y * 5) & 127);
+            }
+        }
+
+        for (int o = 0; o < BLITTER_ORIENTATIONS; o++) {
+            int swap = o & ORIENTATION_SWAP_XY;
+            int ow = swap ? src->height : src->width;
+            int oh = swap ? src->width : src->height;
+
+            for (int format = 0; format < BLITTER_FORMATS; format++) {
+                for (int scale = 1; scale <= BLITTER_MAX_SCALE; scale++) {
+                    int width = ow * scale, height = oh * scale;
+                    int pitch = format == BLITTER_YUY2 ? width / 2 + 3 : width + 5;
+                    u32* target = (u32*)calloc(pitch * (height + 2), sizeof(u32));
+                    blitter_args args = {
+                        .src = src, .dst = target, .pitch = pitch,
+                        .x = 0, .y = 0, .width = ow, .height = oh, .palette = &palette
+                    };
+                    blitter_func blit = blitter_select(o, depth, format, scale);
+
+                    if (!target || !blit) {
+                        printf("ERROR: No blitter for depth %d, format %d, x%d, orientation %d\n",
+                               depth, format, scale, o);
+                        free(target);
+                        errors++;
+                        continue;
+                    }
+                    blit(&args);
+
+                    for (int y = 0; y < height; y++) {
+                        for (int x = 0; x < width; x += format == BLITTER_YUY2 ? 2 : 1) {
+                            int p0 = oriented_pen(src, o, x / scale, y / scale);
+                            u32 want, got;
+
+                            if (format == BLITTER_YUY2) {
+                                int p1 = oriented_pen(src, o, (x + 1) / scale, y / scale);
+
+                                want = palette.pen_yuy2[p0 * palette.total_pens + p1];
+                                got = target[y * pitch + x / 2];
+                            } else {
+                                want = palette.pen_rgba[p0];
+                                got = target[y * pitch + x];
+                            }
+                            if (want != got && errors++ < 5) {
+                                printf("ERROR: depth %d, format %d, x%d, orientation %d: "
+                                       "(%d,%d) is %08X, not %08X\n",
+                                       depth, format, scale, o, x, y, got, want);
+                            }
+                            checks++;
+                        }
+                    }
+                    free(target);
+                }
+            }
+        }
+        bitmap_free(src);
+    }
+
+    palette_free(&palette);
+    if (errors) {
+        printf("ERROR: Blitters failed %d of %d checks\n", errors, checks);
+        return 1;
+    }
+    printf("Blitters: %d checks passed\n", checks);
+    return 0;
+}
@@ -0,0 +1,106 @@
+/***************************************************************************
+ * Decrypted Opcode Test
+ *
+ * memory_decrypt_opcodes maps the decrypted copy over every page no bank
+ * covers, fixed ROM above a bank included, and reports a region reaching
+ * into a bank - also when the bank starts where the region does - with
+ * the banked pages left to memory_configure_bank_decrypted.
+ ***************************************************************************/
+
+#include "memory.h"
+
+#define ROM_SIZE        0x10000
+
+static UINT8 rom[ROM_SIZE];
+static int errors = 0;
+
+static void expect(const char* what, int got, int want) {
+    if (got != want) {
+        printf("ERROR: %s: %d, not %d\n", what, got, want);
+        errors++;
+    }
+}
+
+static UINT8 decrypt(UINT32 address, UINT8 data) {
+    return ~data ^ (address & 0x0F);
+}
+
+/* Pages in a range whose opcode fetches see the decrypted copy */
+static int decrypted_pages(UINT32 start, UINT32 end) {
+    int count = 0;
+
+    for (UINT32 a = start; a <= end; a += 0x100) {
+        UINT8* base;
+        UINT32 min, max;
+
+        if (memory_get_opbase(a, &base, &min, &max) && base[a] == decrypt(a, rom[a]) &&
+            base[a | 0xFF] == decrypt(a | 0xFF, rom[a | 0xFF])) {
+            count++;
+        }
+    }
+    return count;
+}
+
+/* CPU1 as ROM over the whole space, with one bank in it (or none) */
+static int setup(int bank_start, int bank_end) {
+    memory_init();
+    if (memory_region_alloc(REGION_CPU1, ROM_SIZE, "CPU1") != 0 ||
+        memory_load_rom(REGION_CPU1, rom, ROM_SIZE) != 0) {
+        return -1;
+    }
+    memory_map_rom(0x0000, 0xFFFF, memory_region_get_base(REGION_CPU1));
+    if (bank_start >= 0) {
+        memory_configure_bank(0, bank_start, bank_end, 1, "bank");
+        memory_set_bankptr(0, memory_region_get_base(REGION_CPU1) + bank_start);
+    }
+    return 0;
+}
+
+int main(void) {
+    u32 seed = 0x0BADF00D;
+
+    for (int i = 0; i < ROM_SIZE; i++) {
+        seed = seed * 1103515245 + 12345;
+        rom[i] = seed >> 24;
+    }
+
+    /* No bank: every page */
+    if (setup(-1, -1) != 0) {
+        return 1;
+    }
+    expect("Unbanked result", memory_decrypt_opcodes(REGION_CPU1, REGION_OPCODES, 0, decrypt, "ops"), 0);
+    expect("Unbanked pages", decrypted_pages(0x0000, 0xFFFF), 256);
+    memory_shutdown();
+
+    /* A bank in the middle: the fixed ROM on both sides of it */
+    if (setup(0x8000, 0xBFFF) != 0) {
+        return 1;
+    }
+    expect("Middle bank result", memory_decrypt_opcodes(REGION_CPU1, REGION_OPCODES, 0, decrypt, "ops"), -1);
+    expect("Pages below the bank", decrypted_pages(0x0000, 0x7FFF), 128);
+    expect("Pages in the bank", decrypted_pages(0x8000, 0xBFFF), 0);
+    expect("Pages above the bank", decrypted_pages(0xC000, 0xFFFF), 64);
+    memory_shutdown();
+
+    /* A bank where the range starts: still the fixed ROM above it */
+    if (setup(0x0000, 0x3FFF) != 0) {
+        return 1;
+    }
+    expect("Leading bank result", memory_decrypt_opcodes(REGION_CPU1, REGION_OPCODES, 0, decrypt, "ops"), -1);
+    expect("Pages in the leading bank", decrypted_pages(0x0000, 0x3FFF), 0);
+    expect("Pages after the leading bank", decrypted_pages(0x4000, 0xFFFF), 192);
+    memory_shutdown();
+
+    /* Direct mapping refuses any overlap */
+    if (setup(0x8000, 0xBFFF) != 0) {
+        return 1;
+    }
+    expect("Overlapping direct mapping", memory_set_decrypted_opcodes(0x7000, 0x8FFF, rom), -1);
+    memory_shutdown();
+
+    if (errors) {
+        return 1;
+    }
+    printf("Decrypted opcodes: every unbanked page mapped, bank overlaps reported\n");
+    return 0;
+}
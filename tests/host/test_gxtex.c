@@ -0,0 +1,12 @@
+/***************************************************************************
+ * GX Texture Encoder Test
+ *
+ * Tile order of every format against the reference layouts, and partial
+ * encodes of a changed area against full ones.
+ ***************************************************************************/
+
+#include "gxtex.h"
+
+int main(void) {
+    return gxtex_self_test() != 0;
+}
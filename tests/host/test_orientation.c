@@ -0,0 +1,221 @@
+/***************************************************************************
+ * Orientation Test
+ *
+ * Pac-Man's characters and sprites are stored for the landscape raster
+ * of its sideways monitor. Glyphs encoded that way through the driver's
+ * layouts, drawn in the native frame and presented at the driver's
+ * orientation must come out upright on the portrait screen; the sprite
+ * flip bits mirror them along the native axes. Characters written to
+ * known VRAM offsets through the write trackers land in their cells of
+ * the upright screen, the top rows at the end of VRAM included.
+ ***************************************************************************/
+
+#include "video.h"
+#include "memory.h"
+#include "pacman.h"
+
+#define TARGET_WIDTH    640
+#define TARGET_HEIGHT   480
+
+static u32 framebuffer[TARGET_WIDTH * TARGET_HEIGHT];
+static u8 vram[PACMAN_VIDEO_RAM_SIZE], cram[PACMAN_COLOR_RAM_SIZE];
+static u32 pen_words[4];
+static int errors = 0;
+
+/* Upright glyph: bars down the left and along the top, a shorter one
+ * across the middle and one corner pixel - no flip or turn maps it to
+ * itself */
+static int upright(int x, int y, int size) {
+    if (x < 2 || y == 0) {
+        return 1;
+    }
+    if (y == size / 2 && x < size * 3 / 4) {
+        return 2;
+    }
+    return (x == size - 1 && y == size - 1) ? 3 : 0;
+}
+
+/* Store element 'code' so that turned clockwise it is the upright glyph:
+ * native (x, y) is upright (size - 1 - y, x) */
+static void encode(u8* rom, const gfx_layout* layout, int code) {
+    int size = layout->width;
+
+    for (int y = 0; y < size; y++) {
+        for (int x = 0; x < size; x++) {
+            int pen = upright(size - 1 - y, x, size);
+
+            for (int p = 0; p < layout->planes; p++) {
+                u32 bit = code * layout->charincrement + layout->yoffset[y] +
+                          layout->xoffset[x] + layout->planeoffset[p];
+
+                if ((pen >> (layout->planes - 1 - p)) & 1) {
+                    rom[bit >> 3] |= 0x80 >> (bit & 7);
+                }
+            }
+        }
+    }
+}
+
+/* VRAM offsets and the upright screen cell each one shows in */
+static const struct {
+    u16 offset;
+    u8 x, y;
+} cells[] = {
+    { 0x3DD,  0,  0 }, { 0x3C2, 27,  0 },       /* Top row */
+    { 0x3FD,  0,  1 }, { 0x3E2, 27,  1 },
+    { 0x3A0,  0,  2 }, { 0x040, 27,  2 },       /* Playfield */
+    { 0x05F, 27, 33 }, { 0x3BF,  0, 33 },
+    { 0x01D,  0, 34 }, { 0x002, 27, 34 },       /* Bottom rows */
+    { 0x03D,  0, 35 }, { 0x022, 27, 35 },
+};
+
+/* Compare a size x size square of the portrait screen at (px, py) with
+ * the upright glyph, mirrored as asked */
+static void check_glyph(const video_state_t* video, const char* what, int px, int py, int size,
+                        int mirror_x, int mirror_y) {
+    int bad = 0;
+
+    for (int y = 0; y < size; y++) {
+        for (int x = 0; x < size; x++) {
+            int ux = mirror_x ? size - 1 - x : x;
+            int uy = mirror_y ? size - 1 - y : y;
+            u32 got = framebuffer[(video->y_offset + py + y) * TARGET_WIDTH + video->x_offset + px + x];
+
+            bad += got != pen_words[upright(ux, uy, size)];
+        }
+    }
+    if (bad) {
+        printf("ERROR: %s at %d,%d: %d pixels differ\n", what, px, py, bad);
+        errors++;
+    }
+}
+
+/* Cells of the upright screen that are not blank */
+static int drawn_cells(const video_state_t* video) {
+    int count = 0;
+
+    for (int cy = 0; cy < VIDEO_TILES_X; cy++) {
+        for (int cx = 0; cx < VIDEO_TILES_Y; cx++) {
+            int blank = 1;
+
+            for (int y = 0; y < 8; y++) {
+                const u32* p = &framebuffer[(video->y_offset + cy * 8 + y) * TARGET_WIDTH +
+                                            video->x_offset + cx * 8];
+
+                for (int x = 0; x < 8; x++) {
+                    blank &= p[x] == pen_words[0];
+                }
+            }
+            count += !blank;
+        }
+    }
+    return count;
+}
+
+int main(void) {
+    static const color_t colors[4] = {
+        { 0x00, 0x00, 0x00, 0xFF }, { 0xFF, 0x00, 0x00, 0xFF },
+        { 0x00, 0xFF, 0x00, 0xFF }, { 0x00, 0x00, 0xFF, 0xFF }
+    };
+    video_state_t video;
+    pacman_state_t pacman;
+    static UINT8 ram[PACMAN_RAM_SIZE];
+    UINT8* spriteram = ram + (PACMAN_SPRITERAM_BASE - PACMAN_RAM_BASE);
+    u8* rom;
+
+    memory_init();
+    if (memory_region_alloc(REGION_GFX1, 0x2000, "GFX1") != 0 ||
+        video_init(&video, framebuffer, TARGET_WIDTH, TARGET_HEIGHT) != 0 ||
+        pacman_video_start(&pacman, &video) != 0) {
+        return 1;
+    }
+    rom = memory_region_get_base(REGION_GFX1);
+    memset(rom, 0, 0x2000);
+    encode(rom + pacman_gfxdecodeinfo[0].start, pacman_gfxdecodeinfo[0].layout, 1);
+    encode(rom + pacman_gfxdecodeinfo[1].start, pacman_gfxdecodeinfo[1].layout, 1);
+    if (video_decode_gfx(&video, pacman_gfxdecodeinfo) != 2) {
+        return 1;
+    }
+
+    /* Pens of colour code 0 in four plain colours */
+    for (int pen = 0; pen < 4; pen++) {
+        video_set_color(&video, pen, colors[pen]);
+        palette_set_pen_color(&video.palette, pen, pen);
+        pen_words[pen] = palette_rgba_word(colors[pen]);
+    }
+    video_set_orientation(&video, PACMAN_ORIENTATION, ROT0);
+    if (video.x_offset + VIDEO_HEIGHT > TARGET_WIDTH || video.y_offset + VIDEO_WIDTH > TARGET_HEIGHT) {
+        printf("ERROR: Frame presented %s\n", video.scale != 1 ? "zoomed" : "landscape");
+        return 1;
+    }
+
+    /* Every cell of the screen holds character 1 */
+    memset(vram, 1, sizeof(vram));
+    video_begin_frame(&video);
+    video_render_tiles(&video, vram, cram, 0);
+    video_end_frame(&video);
+    for (int cy = 0; cy < VIDEO_TILES_X; cy++) {
+        for (int cx = 0; cx < VIDEO_TILES_Y; cx++) {
+            check_glyph(&video, "Character", cx * 8, cy * 8, 8, 0, 0);
+        }
+    }
+
+    /* Sprite 1 over blank characters, unflipped and with each flip bit.
+     * Native x = 272 - position, y = position - 31; turned clockwise the
+     * native top-left corner is the portrait top-right. */
+    memset(vram, 0, sizeof(vram));
+    memset(&pacman, 0, sizeof(pacman));
+    pacman.ram = ram;
+    pacman.sprite_coords[0] = 31 + 100;
+    pacman.sprite_coords[1] = 272 - 40;
+    for (int flip = 0; flip < 4; flip++) {
+        spriteram[0] = (1 << 2) | flip;
+        video_begin_frame(&video);
+        video_render_tiles(&video, vram, cram, 0);
+        pacman_queue_sprites(&pacman, video_begin_sprites(&video), video.gfx[1]);
+        video_render_sprites(&video);
+        video_end_frame(&video);
+        check_glyph(&video, flip == 0 ? "Sprite" : flip == 1 ? "X-flipped sprite" :
+                    flip == 2 ? "Y-flipped sprite" : "XY-flipped sprite",
+                    VIDEO_HEIGHT - 16 - 100, 40, 16, flip & 2, flip & 1);
+    }
+
+    /* Known offsets, written through the CPU to tracked VRAM; the
+     * off-screen bytes of a band draw nothing */
+    memset(vram, 0, sizeof(vram));
+    memory_map_ram(PACMAN_VRAM_BASE, PACMAN_VRAM_END, vram);
+    memory_map_ram(PACMAN_CRAM_BASE, PACMAN_CRAM_END, cram);
+    if (video_track_memory(&video, PACMAN_VRAM_BASE, PACMAN_CRAM_BASE, PACMAN_VIDEO_RAM_SIZE) != 0) {
+        return 1;
+    }
+    video_begin_frame(&video);
+    video_render_tiles(&video, vram, cram, 0);
+    video_end_frame(&video);
+    for (int i = 0; i < (int)(sizeof(cells) / sizeof(cells[0])); i++) {
+        memory_write_byte(PACMAN_VRAM_BASE + cells[i].offset, 1);
+    }
+    memory_write_byte(PACMAN_VRAM_BASE + 0x000, 1);
+    memory_write_byte(PACMAN_VRAM_BASE + 0x3FF, 1);
+    video_begin_frame(&video);
+    video_render_tiles(&video, vram, cram, 0);
+    video_end_frame(&video);
+    for (int i = 0; i < (int)(sizeof(cells) / sizeof(cells[0])); i++) {
+        char what[32];
+
+        sprintf(what, "VRAM $%03X", cells[i].offset);
+        check_glyph(&video, what, cells[i].x * 8, cells[i].y * 8, 8, 0, 0);
+    }
+    if (drawn_cells(&video) != (int)(sizeof(cells) / sizeof(cells[0]))) {
+        printf("ERROR: %d cells drawn, not %d\n", drawn_cells(&video),
+               (int)(sizeof(cells) / sizeof(cells[0])));
+        errors++;
+    }
+
+    video_shutdown(&video);
+    memory_shutdown();
+    if (errors) {
+        return 1;
+    }
+    printf("Orientation: characters and sprites upright at ROT90, VRAM in place\n");
+    return 0;
+}
@@ -0,0 +1,141 @@
+/***************************************************************************
+ * Paged Region Test
+ *
+ * Paged regions behind the host store: the least recently used page is
+ * the one evicted (never the fast-path page), dirty pages are written
+ * back and read back, prefetched pages are counted as hits, and a hint
+ * never takes over more than half the cache. ROMs loaded through the
+ * memory system read back intact, and shutdown releases every region.
+ ***************************************************************************/
+
+#include "memory.h"
+
+#define PAGE_SIZE       1024
+#define PAGES           32
+#define CACHE_PAGES     4
+
+static UINT8 rom[PAGES * PAGE_SIZE];
+static int errors = 0;
+
+static void expect(const char* what, UINT32 got, UINT32 want) {
+    if (got != want) {
+        printf("ERROR: %s: %u, not %u\n", what, got, want);
+        errors++;
+    }
+}
+
+static int resident(const paged_region_t* region, UINT32 page) {
+    return region->page_slot[page] >= 0;
+}
+
+static void lookup(paged_region_t* region, UINT32 page) {
+    paged_region_lookup(region, page * PAGE_SIZE, 0);
+}
+
+int main(void) {
+    paged_region_t* region;
+    paged_stats_t stats;
+    osd_mem_stats mem;
+    size_t baseline;
+    u32 seed = 0x13579BDF;
+    int bad = 0;
+
+    for (int i = 0; i < (int)sizeof(rom); i++) {
+        seed = seed * 1103515245 + 12345;
+        rom[i] = seed >> 24;
+    }
+
+    region = paged_region_create(paged_store_create_host(sizeof(rom), 0, 0), sizeof(rom),
+                                 PAGE_SIZE, CACHE_PAGES, "test");
+    if (!region || paged_region_load(region, 0, rom, sizeof(rom)) != 0) {
+        return 1;
+    }
+
+    /* Pages 0-3 fill the cache; with 0 touched again, 1 is the oldest */
+    for (int page = 0; page < CACHE_PAGES; page++) {
+        lookup(region, page);
+    }
+    lookup(region, 0);
+    lookup(region, 4);
+    expect("Page 1 resident", resident(region, 1), 0);
+    expect("Page 0 resident", resident(region, 0), 1);
+    expect("Page 4 resident", resident(region, 4), 1);
+
+    /* Page 2 is the fast-path page and, after three prefetches, also the
+     * oldest: the next miss takes the oldest of the others */
+    lookup(region, 2);
+    for (int i = 0; i < 3; i++) {
+        bad += paged_region_read_byte(region, 2 * PAGE_SIZE + i) != rom[2 * PAGE_SIZE + i];
+    }
+    paged_region_prefetch(region, 5 * PAGE_SIZE, 3 * PAGE_SIZE);
+    lookup(region, 8);
+    expect("Fast-path page 2 resident", resident(region, 2), 1);
+    expect("Prefetched page 5 resident", resident(region, 5), 0);
+
+    paged_region_get_stats(region, &stats);
+    expect("Misses", stats.misses, 6);
+    expect("Hits", stats.hits, 5);
+    expect("Evictions", stats.evictions, 5);
+    expect("Prefetches", stats.prefetches, 3);
+    expect("Prefetched pages used", stats.prefetch_hits, 0);
+
+    /* A dirty page is written back when it is evicted */
+    paged_region_write_byte(region, 8 * PAGE_SIZE + 7, ~rom[8 * PAGE_SIZE + 7]);
+    for (int page = 9; page < 9 + CACHE_PAGES; page++) {
+        lookup(region, page);
+    }
+    expect("Written page resident", resident(region, 8), 0);
+    paged_region_get_stats(region, &stats);
+    expect("Writebacks", stats.writebacks, 1);
+    expect("Written byte", paged_region_read_byte(region, 8 * PAGE_SIZE + 7),
+           (UINT8)~rom[8 * PAGE_SIZE + 7]);
+    rom[8 * PAGE_SIZE + 7] = ~rom[8 * PAGE_SIZE + 7];
+
+    /* Prefetched pages are hits when they are used */
+    paged_region_reset_stats(region);
+    paged_region_prefetch(region, 20 * PAGE_SIZE, 2 * PAGE_SIZE);
+    lookup(region, 20);
+    paged_region_lookup(region, 21 * PAGE_SIZE + 100, 0);
+    paged_region_get_stats(region, &stats);
+    expect("Hinted prefetches", stats.prefetches, 2);
+    expect("Hinted misses", stats.misses, 0);
+    expect("Hinted hits", stats.hits, 2);
+    expect("Hinted pages used", stats.prefetch_hits, 2);
+
+    /* A long hint starts at most half the cache and one page */
+    paged_region_reset_stats(region);
+    paged_region_prefetch(region, 24 * PAGE_SIZE, 8 * PAGE_SIZE);
+    paged_region_get_stats(region, &stats);
+    expect("Long hint prefetches", stats.prefetches, CACHE_PAGES / 2 + 1);
+
+    /* Everything reads back, the written byte included */
+    for (int i = 0; i < (int)sizeof(rom); i++) {
+        bad += paged_region_read_byte(region, i) != rom[i];
+    }
+    expect("Bytes read back wrong", bad, 0);
+    paged_region_destroy(region);
+
+    /* Through the memory system, two regions freed by shutdown */
+    memory_init();
+    osd_get_memory_stats(&mem);
+    baseline = mem.tags[OSD_MEM_REGION].live;
+    if (memory_region_alloc_paged(REGION_GFX1, sizeof(rom), PAGE_SIZE, CACHE_PAGES, "GFX1") != 0 ||
+        memory_region_alloc_paged(REGION_GFX2, sizeof(rom) / 2, PAGE_SIZE, 2, "GFX2") != 0 ||
+        memory_load_rom(REGION_GFX1, rom, sizeof(rom)) != 0) {
+        return 1;
+    }
+    bad = 0;
+    for (int i = 0; i < (int)sizeof(rom); i++) {
+        bad += paged_region_read_byte(memory_region_get_paged(REGION_GFX1), i) != rom[i];
+    }
+    expect("Loaded bytes read back wrong", bad, 0);
+    memory_shutdown();
+    osd_get_memory_stats(&mem);
+    expect("Region bytes left after shutdown", mem.tags[OSD_MEM_REGION].live, baseline);
+
+    if (errors) {
+        return 1;
+    }
+    printf("Paged regions: LRU, writeback and prefetch as expected\n");
+    return 0;
+}
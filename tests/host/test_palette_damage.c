@@ -0,0 +1,77 @@
+/***************************************************************************
+ * Palette Damage Test
+ *
+ * A changed pen colour re-presents only the frame bitmap rows that hold
+ * the pen, with the new colour; a change to a pen that is not on screen
+ * presents nothing.
+ ***************************************************************************/
+
+#include "video.h"
+
+#define TARGET_WIDTH    640
+#define TARGET_HEIGHT   480
+#define BAND_Y          100
+#define BAND_ROWS       10
+#define BAND_PEN        5
+#define HIDDEN_PEN      9
+
+static u32 framebuffer[TARGET_WIDTH * TARGET_HEIGHT];
+static int errors = 0;
+
+static void expect(const char* what, int got, int want) {
+    if (got != want) {
+        printf("ERROR: %s: %d, not %d\n", what, got, want);
+        errors++;
+    }
+}
+
+static void present(video_state_t* video) {
+    video_begin_frame(video);
+    video_end_frame(video);
+}
+
+int main(void) {
+    video_state_t video;
+    mame_bitmap* bitmap;
+    int color;
+    u32 want;
+
+    if (video_init(&video, framebuffer, TARGET_WIDTH, TARGET_HEIGHT) != 0) {
+        return 1;
+    }
+    video_set_orientation(&video, ROT0, ROT0);
+    bitmap = video.bitmap;
+
+    /* Pen 0 everywhere but a band of BAND_PEN */
+    for (int y = 0; y < VIDEO_HEIGHT; y++) {
+        memset(bitmap->line[y], y >= BAND_Y && y < BAND_Y + BAND_ROWS ? BAND_PEN : 0, VIDEO_WIDTH);
+    }
+    video_add_stale(&video, NULL);
+    present(&video);
+    expect("Rows of the first frame", video.present_rows, VIDEO_HEIGHT * video.scale);
+
+    /* New colour for the band's pen: its rows only */
+    color = (video.palette.pen_color[BAND_PEN] + 1) % video.palette.total_colors;
+    palette_set_pen_color(&video.palette, BAND_PEN, color);
+    present(&video);
+    expect("First row after a colour change", video.present_y,
+           video.y_offset + BAND_Y * video.scale);
+    expect("Rows after a colour change", video.present_rows, BAND_ROWS * video.scale);
+    want = palette_rgba_word(video.palette.colors[color]);
+    expect("Band pixel", framebuffer[(video.y_offset + (BAND_Y + 1) * video.scale) * TARGET_WIDTH +
+                                     video.x_offset] == want, 1);
+
+    /* A pen nowhere on screen: nothing */
+    color = (video.palette.pen_color[HIDDEN_PEN] + 1) % video.palette.total_colors;
+    palette_set_pen_color(&video.palette, HIDDEN_PEN, color);
+    present(&video);
+    expect("Rows after a hidden colour change", video.present_rows, 0);
+    expect("Pens rebuilt", video.palette.pens_updated, 1);
+
+    video_shutdown(&video);
+    if (errors) {
+        return 1;
+    }
+    printf("Palette damage: only rows holding changed pens presented\n");
+    return 0;
+}
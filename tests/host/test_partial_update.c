@@ -0,0 +1,100 @@
+/***************************************************************************
+ * Partial Update Test
+ *
+ * A frame drawn in bands by video_force_partial_update, with the tile
+ * flip changed between them, must hold each band as a whole frame drawn
+ * with that band's state would; with the update callback removed the
+ * frame is not drawn through it.
+ ***************************************************************************/
+
+#include "video.h"
+#include "memory.h"
+
+static u8 vram[VIDEO_TILE_COUNT], cram[VIDEO_TILE_COUNT];
+static int flip;
+
+static void get_tile_info(int tile_index, tile_info_t* info, void* param) {
+    video_state_t* state = (video_state_t*)param;
+
+    info->gfx = state->gfx[0];
+    info->code = state->tile_vram[tile_index];
+    info->color = state->tile_cram[tile_index] & (VIDEO_COLOR_CODES - 1);
+}
+
+static void draw_band(video_state_t* state, const rectangle* clip, void* param) {
+    (*(int*)param)++;
+    video_render_tiles(state, vram, cram, flip);
+    video_begin_sprites(state);
+    video_render_sprites(state);
+}
+
+static u8 ref_upright[VIDEO_HEIGHT][VIDEO_WIDTH];
+static u8 ref_flipped[VIDEO_HEIGHT][VIDEO_WIDTH];
+static u32 framebuffer[640 * 480];
+
+int main(void) {
+    video_state_t video;
+    u32 seed = 0x2468ACE0;
+    int calls = 0;
+    int errors = 0;
+
+    memory_init();
+    if (video_init(&video, framebuffer, 640, 480) != 0 ||
+        video_create_tilemap(&video, get_tile_info, tilemap_scan_rows, VIDEO_TILES_X, VIDEO_TILES_Y) != 0) {
+        return 1;
+    }
+    for (int i = 0; i < VIDEO_TILE_COUNT; i++) {
+        seed = seed * 1103515245 + 12345;
+        vram[i] = seed >> 24;
+        cram[i] = seed >> 16;
+    }
+
+    /* Whole frames in each state */
+    video_begin_frame(&video);
+    video_render_tiles(&video, vram, cram, 0);
+    for (int y = 0; y < VIDEO_HEIGHT; y++) {
+        memcpy(ref_upright[y], video.bitmap->line[y], VIDEO_WIDTH);
+    }
+    video_render_tiles(&video, vram, cram, 1);
+    for (int y = 0; y < VIDEO_HEIGHT; y++) {
+        memcpy(ref_flipped[y], video.bitmap->line[y], VIDEO_WIDTH);
+    }
+    memset(video.bitmap->base, 0xEE, video.bitmap->rowbytes * VIDEO_HEIGHT);
+
+    /* Upright to line 100 (the update to line 50 is already covered),
+     * flipped for the rest */
+    video_set_update(&video, draw_band, &calls);
+    video_begin_frame(&video);
+    flip = 0;
+    video_force_partial_update(&video, 100);
+    video_force_partial_update(&video, 50);
+    flip = 1;
+    video_end_frame(&video);
+
+    for (int y = 0; y < VIDEO_HEIGHT; y++) {
+        if (memcmp(video.bitmap->line[y], y <= 100 ? ref_upright[y] : ref_flipped[y], VIDEO_WIDTH)) {
+            if (errors++ < 5) {
+                printf("ERROR: Row %d does not match its band's frame\n", y);
+            }
+        }
+    }
+    if (calls != 2 || video.partial_updates != 2) {
+        printf("ERROR: %d update calls and %u bands, not 2\n", calls, video.partial_updates);
+        errors++;
+    }
+
+    video_set_update(&video, NULL, NULL);
+    video_begin_frame(&video);
+    video_end_frame(&video);
+    if (calls != 2) {
+        printf("ERROR: Update called after it was removed\n");
+        errors++;
+    }
+
+    video_shutdown(&video);
+    if (errors) {
+        return 1;
+    }
+    printf("Partial updates: %d rows match\n", VIDEO_HEIGHT);
+    return 0;
+}
@@ -0,0 +1,73 @@
+/***************************************************************************
+ * Frame Presentation Test
+ *
+ * Paces simulated workloads against a 59.94 Hz display with double and
+ * triple buffering and checks the repeated and dropped frames. The
+ * closing retrace of a simulation always repeats the last frame.
+ ***************************************************************************/
+
+#include "present.h"
+
+#define FRAMES          600
+#define REFRESH_US      16683
+
+static u32 frame_us[FRAMES];
+static int errors = 0;
+
+static void expect(const char* what, int buffers, u32 got, u32 want) {
+    if (got != want) {
+        printf("ERROR: %s with %d buffers: %u, not %u\n", what, buffers, got, want);
+        errors++;
+    }
+}
+
+static void simulate(int buffers, present_stats_t* stats) {
+    present_simulate(buffers, frame_us, FRAMES, REFRESH_US, stats);
+
+    /* Every frame submitted reaches the screen */
+    expect("Frames submitted", buffers, stats->submitted, FRAMES);
+    expect("Frames shown", buffers, stats->flips, FRAMES);
+}
+
+int main(void) {
+    present_stats_t stats;
+    u32 seed = 0x12345678;
+
+    /* Faster than the display: a new frame every retrace */
+    for (int i = 0; i < FRAMES; i++) {
+        frame_us[i] = 10000;
+    }
+    for (int buffers = 2; buffers <= 3; buffers++) {
+        simulate(buffers, &stats);
+        expect("Fast frames repeated", buffers, stats.repeats, 1);
+    }
+
+    /* Steady 20 ms: double buffering waits out a second retrace for every
+     * frame; triple buffering shows them at the rate they are drawn */
+    for (int i = 0; i < FRAMES; i++) {
+        frame_us[i] = 20000;
+    }
+    simulate(2, &stats);
+    expect("Slow frames repeated", 2, stats.repeats, FRAMES - 1);
+    simulate(3, &stats);
+    expect("Slow frame retraces", 3, stats.retraces, FRAMES * 20000 / REFRESH_US + 2);
+    expect("Slow frame waits", 3, stats.waits, 0);
+
+    /* Under a refresh on average, one frame in four over: triple
+     * buffering absorbs the long frames, double buffering repeats one
+     * frame for each */
+    for (int i = 0; i < FRAMES; i++) {
+        seed = seed * 1103515245 + 12345;
+        frame_us[i] = ((i & 3) == 3 ? 19000 : 12000) + ((seed >> 16) % 2000);
+    }
+    simulate(2, &stats);
+    expect("Jittery frames repeated", 2, stats.repeats, FRAMES / 4 + 1);
+    simulate(3, &stats);
+    expect("Jittery frames repeated", 3, stats.repeats, 1);
+
+    if (errors) {
+        return 1;
+    }
+    printf("Presentation: repeats and drops as expected\n");
+    return 0;
+}
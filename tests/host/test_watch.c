@@ -0,0 +1,76 @@
+/***************************************************************************
+ * Watchpoint Test
+ *
+ * Pac-Man running a loop that writes ROM and RAM: a write watchpoint on
+ * ROM fires though the write is dropped, and a break on RAM stops
+ * pacman_run_frame early, with the rest of the frame run by the next
+ * call.
+ ***************************************************************************/
+
+#include "pacman.h"
+#include "memory.h"
+#include "cpuintrf.h"
+#include "z80.h"
+
+/* loop: ld (0100),a ; ld (4C00),a ; inc a ; jr loop */
+static const UINT8 program[] = {
+    0x32, 0x00, 0x01, 0x32, 0x00, 0x4C, 0x3C, 0x18, 0xF7
+};
+
+static int errors = 0;
+
+static void expect(const char* what, UINT32 got, UINT32 want) {
+    if (got != want) {
+        printf("ERROR: %s: %u, not %u\n", what, got, want);
+        errors++;
+    }
+}
+
+int main(void) {
+    pacman_state_t pacman;
+    int rom_watch, ram_watch;
+    int stops = 0;
+
+    memory_init();
+    if (pacman_init(&pacman) != 0) {
+        return 1;
+    }
+    memcpy(pacman.rom, program, sizeof(program));
+    z80_init();
+    z80_reset(NULL);
+
+    /* Dropped ROM writes are still seen */
+    rom_watch = memory_watch_add(0x0100, 0x0100, MEMORY_WATCH_WRITE);
+    expect("Frame without breaks completes", pacman_run_frame(&pacman), 1);
+    expect("ROM byte after writes", pacman.rom[0x0100], 0x00);
+    if (memory_watch_get_hits(rom_watch) == 0) {
+        printf("ERROR: ROM write watchpoint never fired\n");
+        errors++;
+    }
+    memory_watch_remove(rom_watch);
+
+    /* A break on the RAM write stops every pass of the loop; each call
+     * resumes the frame where the last one stopped */
+    ram_watch = memory_watch_add(0x4C00, 0x4C00, MEMORY_WATCH_WRITE | MEMORY_WATCH_BREAK);
+    while (!pacman_run_frame(&pacman)) {
+        if (stops++ == 0) {
+            expect("Cycles left at the first break", cpu_frame_cycles_left() > 50000, 1);
+            expect("Frames counted at the first break", pacman.frame_count, 1);
+        }
+        if (stops > 10000) {
+            break;
+        }
+    }
+    expect("Frames counted after the breaks", pacman.frame_count, 2);
+    expect("Breaks, one per RAM write", stops, memory_watch_get_hits(ram_watch));
+    expect("Frame cycles left", cpu_frame_cycles_left() <= 0, 1);
+
+    pacman_shutdown(&pacman);
+    memory_shutdown();
+
+    if (errors) {
+        return 1;
+    }
+    printf("Watchpoints: ROM writes watched, %d breaks resumed\n", stops);
+    return 0;
+}